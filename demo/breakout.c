@@ -225,7 +225,7 @@ void emscripten_main(state_t *state) {
     state->rainbow_step = (state->rainbow_step + 3) % (NUM_BRICK_COLUMNS * 6);
     state->time = 0;
   }
-  sdl_render_scene(state->scene);
+  sdl_render_scene(state->scene, 1);
   compute_positions(state);
 }
 
@@ -86,7 +86,7 @@ state_t *emscripten_init() {
 }
 
 void emscripten_main(state_t *state) {
-  sdl_render_scene(state->scene);
+  sdl_render_scene(state->scene, 1);
   scene_tick(state->scene, time_since_last_tick());
 }
 
@@ -0,0 +1,202 @@
+#include "forces.h"
+#include "scene.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/**
+ * Times each kind of force on a scene of bodies, as the force creators apply
+ * it and as they did before they scaled vectors directly, by turning a vector
+ * into its angle and back. The force creators register the library's own
+ * kernels; the old ones are copies of them as they were before. The two are
+ * run side by side in separate scenes, and the bodies' velocities are checked
+ * to stay the same in both.
+ *
+ * Each time is a whole tick per force, moving the bodies included. A scene
+ * of the same bodies without forces is timed too, to show how much of that
+ * is the tick itself.
+ *
+ * Usage: bin/force_bench [steps]
+ */
+
+typedef enum {
+  BENCH_GRAVITY,
+  BENCH_SPRING,
+  BENCH_DRAG,
+  BENCH_FRICTION,
+  BENCH_NONE
+} kind_t;
+
+const char *KIND_NAMES[] = {"gravity", "spring", "drag", "friction"};
+const size_t BENCH_BODIES = 1000;
+const size_t DEFAULT_STEPS = 1000;
+const double BENCH_DT = 1.0 / 60;
+const double BENCH_SIDE = 1000;
+// Small enough that no body comes to a stop within the steps
+const double BENCH_CONSTANT = 1e-3;
+const double MIN_SPEED = 100;
+const double MAX_SPEED = 200;
+// Matches the distance gravity stops growing at in forces.c
+const double BENCH_MIN_DISTANCE = 5;
+
+double seconds_since(struct timespec start) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) * 1e-9;
+}
+
+double random_uniform(double min, double max) {
+  return min + (max - min) * rand() / RAND_MAX;
+}
+
+void angle_gravity_kernel(const force_term_t *terms, size_t count,
+                          double dt) {
+  for (size_t i = 0; i < count; i++) {
+    body_t *body1 = terms[i].body1;
+    body_t *body2 = terms[i].body2;
+    vector_t difference =
+        vec_subtract(body_get_centroid(body2), body_get_centroid(body1));
+    double distance = fmax(vec_magnitude(difference), BENCH_MIN_DISTANCE);
+    double magnitude = terms[i].constant * body_get_mass(body1) *
+                       body_get_mass(body2) / (distance * distance);
+    vector_t force = vec_init(magnitude, vec_direction(difference));
+    body_add_force(body1, force);
+    body_add_force(body2, vec_negate(force));
+  }
+}
+
+void angle_spring_kernel(const force_term_t *terms, size_t count, double dt) {
+  for (size_t i = 0; i < count; i++) {
+    body_t *body1 = terms[i].body1;
+    body_t *body2 = terms[i].body2;
+    vector_t difference =
+        vec_subtract(body_get_centroid(body2), body_get_centroid(body1));
+    double magnitude = terms[i].constant * vec_magnitude(difference);
+    vector_t force = vec_init(magnitude, vec_direction(difference));
+    body_add_force(body1, force);
+    body_add_force(body2, vec_negate(force));
+  }
+}
+
+void angle_drag_kernel(const force_term_t *terms, size_t count, double dt) {
+  for (size_t i = 0; i < count; i++) {
+    vector_t v = body_get_velocity(terms[i].body1);
+    double magnitude = terms[i].constant * vec_magnitude(v) * vec_magnitude(v);
+    body_add_force(terms[i].body1, vec_init(-magnitude, vec_direction(v)));
+  }
+}
+
+void angle_friction_kernel(const force_term_t *terms, size_t count,
+                           double dt) {
+  for (size_t i = 0; i < count; i++) {
+    body_t *body = terms[i].body1;
+    double mu_x_g = terms[i].constant;
+    vector_t v = body_get_velocity(body);
+    double speed = vec_magnitude(v);
+    if (speed < REST_SPEED || speed <= mu_x_g * dt) {
+      body_set_velocity(body, VEC_ZERO);
+    } else {
+      double magnitude = mu_x_g * body_get_mass(body);
+      body_add_force(body, vec_init(-magnitude, vec_direction(v)));
+    }
+  }
+}
+
+const force_kernel_t ANGLE_KERNELS[] = {
+    angle_gravity_kernel, angle_spring_kernel, angle_drag_kernel,
+    angle_friction_kernel};
+
+// Makes a scene of moving bodies with a force of one kind on each body, or
+// between each body and the next, the same for the same kind
+scene_t *make_scene(kind_t kind, bool angle) {
+  srand(1);
+  scene_t *scene = scene_init();
+  for (size_t i = 0; i < BENCH_BODIES; i++) {
+    vector_t center = {random_uniform(0, BENCH_SIDE),
+                       random_uniform(0, BENCH_SIDE)};
+    body_t *body = body_init_circle(center, 1, random_uniform(1, 10),
+                                    (rgb_color_t){0, 0, 0});
+    double speed = random_uniform(MIN_SPEED, MAX_SPEED);
+    body_set_velocity(body, vec_init(speed, random_uniform(-M_PI, M_PI)));
+    scene_add_body(scene, body);
+  }
+  for (size_t i = 0; i < BENCH_BODIES && kind != BENCH_NONE; i++) {
+    body_t *body = scene_get_body(scene, i);
+    body_t *next = scene_get_body(scene, (i + 1) % BENCH_BODIES);
+    bool pair = kind == BENCH_GRAVITY || kind == BENCH_SPRING;
+    if (angle) {
+      scene_add_force_term(scene, ANGLE_KERNELS[kind], BENCH_CONSTANT, body,
+                           pair ? next : NULL);
+    } else if (kind == BENCH_GRAVITY) {
+      create_newtonian_gravity(scene, BENCH_CONSTANT, body, next);
+    } else if (kind == BENCH_SPRING) {
+      create_spring(scene, BENCH_CONSTANT, body, next);
+    } else if (kind == BENCH_DRAG) {
+      create_drag(scene, BENCH_CONSTANT, body);
+    } else {
+      create_gravity_friction(scene, BENCH_CONSTANT, body);
+    }
+  }
+  return scene;
+}
+
+// The largest difference between the bodies' velocities in two scenes,
+// relative to the speed of the body
+double velocity_error(scene_t *scene1, scene_t *scene2) {
+  double error = 0;
+  for (size_t i = 0; i < scene_bodies(scene1); i++) {
+    vector_t v = body_get_velocity(scene_get_body(scene1, i));
+    vector_t difference =
+        vec_subtract(body_get_velocity(scene_get_body(scene2, i)), v);
+    error = fmax(error, vec_magnitude(difference) / vec_magnitude(v));
+  }
+  return error;
+}
+
+// Ticks a scene, returning the seconds each tick took on average
+double time_ticks(scene_t *scene, size_t steps) {
+  struct timespec start;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (size_t step = 0; step < steps; step++) {
+    scene_tick(scene, BENCH_DT);
+  }
+  return seconds_since(start) / steps;
+}
+
+void run_bench(kind_t kind, size_t steps) {
+  scene_t *angle = make_scene(kind, true);
+  scene_t *direct = make_scene(kind, false);
+  double angle_time = 0, direct_time = 0;
+  for (size_t step = 0; step < steps; step++) {
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    scene_tick(angle, BENCH_DT);
+    angle_time += seconds_since(start);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    scene_tick(direct, BENCH_DT);
+    direct_time += seconds_since(start);
+  }
+  double angle_ns = 1e9 * angle_time / steps / BENCH_BODIES;
+  double direct_ns = 1e9 * direct_time / steps / BENCH_BODIES;
+  printf("%-8s: %6.1f -> %6.1f ns/force (velocities differ by %.1e)\n",
+         KIND_NAMES[kind], angle_ns, direct_ns, velocity_error(angle, direct));
+  scene_free(angle);
+  scene_free(direct);
+}
+
+int main(int argc, char *argv[]) {
+  size_t steps = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_STEPS;
+  if (steps == 0) {
+    fprintf(stderr, "usage: %s [steps]\n", argv[0]);
+    return 1;
+  }
+  scene_t *none = make_scene(BENCH_NONE, false);
+  printf("no force: %6.1f ns/body\n",
+         1e9 * time_ticks(none, steps) / BENCH_BODIES);
+  scene_free(none);
+  for (kind_t kind = BENCH_GRAVITY; kind <= BENCH_FRICTION; kind++) {
+    run_bench(kind, steps);
+  }
+  return 0;
+}
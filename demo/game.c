@@ -18,18 +18,18 @@
  */
 
 bool ball_within(scene_t *scene, vector_t centroid, body_t *ball) {
-  for (size_t i = 0; i < scene_bodies(scene); i++) {
-    body_t *curr = scene_get_body(scene, i);
-    if (*(int *)body_get_info(curr) > BLACK_INFO) {
-      continue;
-    }
-    double distance =
-        vec_magnitude(vec_subtract(centroid, body_get_centroid(curr)));
-    if (curr != ball && distance <= 2 * ball_radius()) {
-      return true;
+  // A ball centered here would touch any ball overlapping its circle
+  list_t *balls = list_init(2, NULL);
+  scene_query_shape(scene, circle_view(centroid, ball_radius()), BALL_TYPES,
+                    balls);
+  bool within = false;
+  for (size_t i = 0; i < list_size(balls); i++) {
+    if (list_get(balls, i) != ball) {
+      within = true;
     }
   }
-  return false;
+  list_free(balls);
+  return within;
 }
 
 void respawn_ball(scene_t *scene, body_t *ball, info_t info) {
@@ -359,17 +359,22 @@ state_t *emscripten_init(void) {
 }
 
 void emscripten_main(state_t *state) {
-  double dt = time_since_last_tick();
-  scene_tick(state->scene, dt);
-  sdl_render_scene(state->scene);
+  scene_advance(state->scene, time_since_last_tick(), PHYSICS_DT);
+  sdl_render_scene(state->scene, scene_get_alpha(state->scene));
   compute_positions(state);
   if (state->goto_next_state == true) {
     scene_free(state->scene);
     game_init(state);
+    // Images the old scene showed and the new one doesn't can go now
+    sdl_release_unused_images();
   }
 }
 
 void emscripten_free(state_t *state) {
+  if (state->trajectory != NULL) {
+    trajectory_free(state->trajectory);
+  }
   scene_free(state->scene);
+  sdl_release_unused_images();
   free(state);
 }
@@ -0,0 +1,105 @@
+#include "forces.h"
+#include "scene.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/**
+ * Times create_gravity_field() on scenes of bodies scattered over a square,
+ * computing every pair directly and with a Barnes-Hut quadtree, and reports
+ * how far the quadtree's forces are from the exact ones.
+ *
+ * The square grows with the number of bodies, so they are spread as thinly
+ * however many there are.
+ *
+ * Usage: bin/gravity_bench [steps] [theta]
+ */
+
+const size_t BODY_COUNTS[] = {100, 1000, 10000};
+const size_t DEFAULT_STEPS = 10;
+const double DEFAULT_THETA = 0.5;
+const double BENCH_G = 30;
+// The area of the square per body
+const double AREA_PER_BODY = 400;
+const double MIN_MASS = 100;
+const double MAX_MASS = 1000;
+const double BENCH_DT = 1.0 / 60;
+
+double seconds_since(struct timespec start) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) * 1e-9;
+}
+
+double random_uniform(double min, double max) {
+  return min + (max - min) * rand() / RAND_MAX;
+}
+
+// Makes a scene of still bodies at the same places for the same seed
+scene_t *make_scene(size_t count, double theta) {
+  srand(count);
+  scene_t *scene = scene_init();
+  double side = sqrt(count * AREA_PER_BODY);
+  for (size_t i = 0; i < count; i++) {
+    vector_t center = {random_uniform(0, side), random_uniform(0, side)};
+    scene_add_body(scene, body_init_circle(center, 1,
+                                           random_uniform(MIN_MASS, MAX_MASS),
+                                           (rgb_color_t){0, 0, 0}));
+  }
+  create_gravity_field(scene, BENCH_G, theta);
+  return scene;
+}
+
+// Ticks a scene, returning the seconds each tick took on average
+double time_ticks(scene_t *scene, size_t steps) {
+  struct timespec start;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (size_t step = 0; step < steps; step++) {
+    scene_tick(scene, BENCH_DT);
+  }
+  return seconds_since(start) / steps;
+}
+
+// The root mean square difference between the bodies' velocities in two
+// scenes, relative to the root mean square velocity in the first
+double velocity_error(scene_t *exact, scene_t *approximate) {
+  double error = 0, total = 0;
+  for (size_t i = 0; i < scene_bodies(exact); i++) {
+    vector_t v = body_get_velocity(scene_get_body(exact, i));
+    vector_t difference = vec_subtract(
+        body_get_velocity(scene_get_body(approximate, i)), v);
+    error += vec_dot(difference, difference);
+    total += vec_dot(v, v);
+  }
+  return sqrt(error / total);
+}
+
+void run_bench(size_t count, size_t steps, double theta) {
+  scene_t *direct = make_scene(count, 0);
+  scene_t *tree = make_scene(count, theta);
+  // The first tick, from rest, shows the error in the forces alone
+  scene_tick(direct, BENCH_DT);
+  scene_tick(tree, BENCH_DT);
+  double error = velocity_error(direct, tree);
+  double direct_time = time_ticks(direct, steps);
+  double tree_time = time_ticks(tree, steps);
+  printf("%6zu bodies: %10.1f us/tick direct, %10.1f us/tick Barnes-Hut "
+         "(%.2f%% error)\n",
+         count, 1e6 * direct_time, 1e6 * tree_time, 100 * error);
+  scene_free(direct);
+  scene_free(tree);
+}
+
+int main(int argc, char *argv[]) {
+  size_t steps = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_STEPS;
+  double theta = argc > 2 ? strtod(argv[2], NULL) : DEFAULT_THETA;
+  if (steps == 0 || theta <= 0) {
+    fprintf(stderr, "usage: %s [steps] [theta]\n", argv[0]);
+    return 1;
+  }
+  for (size_t i = 0; i < sizeof(BODY_COUNTS) / sizeof(BODY_COUNTS[0]); i++) {
+    run_bench(BODY_COUNTS[i], steps, theta);
+  }
+  return 0;
+}
@@ -16,6 +16,8 @@ const vector_t MIN_POS = {0, 0};
 const vector_t MAX_POS = {2000, 1000};
 
 const double G = 30;
+// The Barnes-Hut opening angle for the gravity between the bodies
+const double THETA = 0.5;
 const double MAX_RADIUS = 60;
 const double MIN_RADIUS = 20;
 const int POLYGON_COUNT = 60;
@@ -48,17 +50,6 @@ void generate_new_shape(state_t *state) {
   scene_add_body(state->scene, body);
 }
 
-void apply_forces(state_t *state) {
-  size_t body_count = scene_bodies(state->scene);
-  for (size_t i = 0; i < body_count; i++) {
-    for (size_t j = i + 1; j < body_count; j++) {
-      body_t *body1 = scene_get_body(state->scene, i);
-      body_t *body2 = scene_get_body(state->scene, j);
-      create_newtonian_gravity(state->scene, G, body1, body2);
-    }
-  }
-}
-
 state_t *emscripten_init() {
   state_t *state = malloc(sizeof(state_t));
   assert(state != NULL);
@@ -69,12 +60,12 @@ state_t *emscripten_init() {
   for (int i = 0; i < POLYGON_COUNT; i++) {
     generate_new_shape(state);
   }
-  apply_forces(state);
+  create_gravity_field(state->scene, G, THETA);
   return state;
 }
 
 void emscripten_main(state_t *state) {
-  sdl_render_scene(state->scene);
+  sdl_render_scene(state->scene, 1);
   scene_tick(state->scene, time_since_last_tick());
 }
 
@@ -146,7 +146,7 @@ void emscripten_main(state_t *state) {
   scene_tick(state->scene, dt);
   compute_new_positions(state, dt);
   eat_pellet(state);
-  sdl_render_scene(state->scene);
+  sdl_render_scene(state->scene, 1);
 }
 
 void emscripten_free(state_t *state) {
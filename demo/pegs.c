@@ -250,7 +250,7 @@ void emscripten_main(state_t *state) {
     state->time_since_drop = 0.0;
   }
   scene_tick(state->scene, dt);
-  sdl_render_scene(state->scene);
+  sdl_render_scene(state->scene, 1);
 }
 
 void emscripten_free(state_t *state) {
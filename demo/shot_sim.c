@@ -0,0 +1,157 @@
+#include "shot_search.h"
+#include "simulator.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * Plays a file of shots on the headless table and reports how they went and
+ * how quickly they were simulated.
+ *
+ * Each line of the file is one shot: the cue ball's x and y position, then
+ * the x and y components of the impulse to hit it with, and optionally the
+ * ball on (1 for a red if omitted). Blank lines and lines starting with '#'
+ * are skipped. If no file is given, shots are read from
+ * standard input.
+ *
+ * Usage: bin/shot_sim [shots file] [dt]
+ * A dt of 0 jumps from event to event instead of ticking.
+ *
+ * Alternatively, searches for the best shots around an aimed one on every
+ * core, and prints the best few.
+ *
+ * Usage: bin/shot_sim --search <angle> <speed> [samples] [threads] [dt]
+ */
+
+const size_t SHOTS_SHOWN = 5;
+
+const size_t INITIAL_SHOTS = 1024;
+const size_t MAX_LINE_LENGTH = 256;
+
+shot_t *read_shots(FILE *file, size_t *count) {
+  size_t capacity = INITIAL_SHOTS;
+  shot_t *shots = malloc(capacity * sizeof(shot_t));
+  char line[MAX_LINE_LENGTH];
+  size_t line_number = 0;
+  *count = 0;
+  while (fgets(line, sizeof(line), file) != NULL) {
+    line_number++;
+    shot_t shot;
+    char first;
+    if (sscanf(line, " %c", &first) != 1 || first == '#') {
+      continue;
+    }
+    shot.ball_on = RED_INFO;
+    if (sscanf(line, "%lf %lf %lf %lf %d", &shot.cue_ball.x, &shot.cue_ball.y,
+               &shot.impulse.x, &shot.impulse.y, &shot.ball_on) < 4) {
+      fprintf(stderr, "Skipping malformed shot on line %zu\n", line_number);
+      continue;
+    }
+    if (*count == capacity) {
+      capacity *= 2;
+      shots = realloc(shots, capacity * sizeof(shot_t));
+    }
+    shots[(*count)++] = shot;
+  }
+  return shots;
+}
+
+double seconds_since(struct timespec start) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) * 1e-9;
+}
+
+int run_search(int argc, char *argv[]) {
+  if (argc < 4) {
+    fprintf(stderr,
+            "usage: %s --search <angle> <speed> [samples] [threads] [dt]\n",
+            argv[0]);
+    return 1;
+  }
+  search_params_t params = search_params_init(atof(argv[2]), atof(argv[3]));
+  if (argc > 4) {
+    params.samples = strtoul(argv[4], NULL, 10);
+  }
+  if (argc > 5) {
+    params.threads = strtoul(argv[5], NULL, 10);
+  }
+  if (argc > 6) {
+    params.dt = atof(argv[6]);
+  }
+  if (params.samples == 0) {
+    fprintf(stderr, "samples must be positive\n");
+    return 1;
+  }
+  if (params.dt < 0) {
+    fprintf(stderr, "dt must not be negative\n");
+    return 1;
+  }
+
+  struct timespec start;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  candidate_t *candidates = shot_search(params);
+  double elapsed = seconds_since(start);
+
+  for (size_t i = 0; i < SHOTS_SHOWN && i < params.samples; i++) {
+    candidate_t *candidate = &candidates[i];
+    printf("angle %.4f, speed %.1f: score %g (%zu pots, %d points, foul %d)\n",
+           candidate->angle, candidate->speed, candidate->score,
+           candidate->result.pots, candidate->result.points,
+           candidate->result.foul);
+  }
+  printf("time: %.3f s, %.1f shots/s\n", elapsed, params.samples / elapsed);
+  free(candidates);
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc > 1 && strcmp(argv[1], "--search") == 0) {
+    return run_search(argc, argv);
+  }
+  FILE *file = stdin;
+  if (argc > 1 && (file = fopen(argv[1], "r")) == NULL) {
+    perror(argv[1]);
+    return 1;
+  }
+  double dt = argc > 2 ? atof(argv[2]) : SIM_DT;
+  if (dt < 0) {
+    fprintf(stderr, "dt must not be negative\n");
+    return 1;
+  }
+  size_t count;
+  shot_t *shots = read_shots(file, &count);
+  if (file != stdin) {
+    fclose(file);
+  }
+
+  size_t pots = 0, fouls = 0, unsettled = 0, ticks = 0;
+  int points = 0;
+  struct timespec start;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (size_t i = 0; i < count; i++) {
+    shot_result_t result;
+    if (dt > 0) {
+      simulate_shot(shots[i], dt, &result);
+    } else {
+      simulate_shot_events(shots[i], &result);
+    }
+    pots += result.pots;
+    points += result.points;
+    fouls += result.foul != 0;
+    unsettled += !result.settled;
+    ticks += result.ticks;
+  }
+  double elapsed = seconds_since(start);
+
+  printf("shots: %zu\n", count);
+  printf("pots: %zu, points: %d, fouls: %zu, unsettled: %zu\n", pots, points,
+         fouls, unsettled);
+  printf("%s: %zu (%.1f per shot)\n", dt > 0 ? "ticks" : "events", ticks,
+         count ? (double)ticks / count : 0.0);
+  printf("time: %.3f s, %.1f shots/s\n", elapsed,
+         elapsed > 0 ? count / elapsed : 0.0);
+  free(shots);
+  return 0;
+}
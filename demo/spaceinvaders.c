@@ -219,7 +219,7 @@ void emscripten_main(state_t *state) {
   }
   compute_positions(state);
   scene_tick(state->scene, time_since_last_tick());
-  sdl_render_scene(state->scene);
+  sdl_render_scene(state->scene, 1);
 }
 
 void emscripten_free(state_t *state) {
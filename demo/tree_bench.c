@@ -0,0 +1,175 @@
+#include "aabb_tree.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/**
+ * Times finding the pairs of overlapping boxes among bodies moving around a
+ * square, both by checking every pair and with the dynamic AABB tree the
+ * scene's broad phase uses, and checks that both find the same pairs.
+ *
+ * The square grows with the number of bodies, so each body has about as many
+ * neighbours however many there are.
+ *
+ * Usage: bin/tree_bench [steps]
+ */
+
+const size_t BODY_COUNTS[] = {20, 200, 2000};
+const size_t DEFAULT_STEPS = 200;
+const double BODY_SIZE = 10;
+// The area of the square per body
+const double AREA_PER_BODY = 2500;
+const double MAX_SPEED = 200;
+const double BENCH_DT = 1.0 / 60;
+// Matches the scene's fattening of moving bodies' boxes
+const double BENCH_MARGIN = 0.25;
+const double BENCH_LOOKAHEAD = 4;
+
+typedef struct {
+  aabb_t *boxes;
+  vector_t *velocities;
+  size_t *leaves;
+  size_t count;
+  double side;
+} bench_t;
+
+typedef struct {
+  bench_t *bench;
+  aabb_tree_t *tree;
+  size_t index;
+  size_t pairs;
+} bench_query_t;
+
+double seconds_since(struct timespec start) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) * 1e-9;
+}
+
+double random_uniform(double min, double max) {
+  return min + (max - min) * rand() / RAND_MAX;
+}
+
+bench_t bench_init(size_t count) {
+  bench_t bench = {malloc(count * sizeof(aabb_t)),
+                   malloc(count * sizeof(vector_t)),
+                   malloc(count * sizeof(size_t)), count,
+                   sqrt(count * AREA_PER_BODY)};
+  for (size_t i = 0; i < count; i++) {
+    vector_t min = {random_uniform(0, bench.side - BODY_SIZE),
+                    random_uniform(0, bench.side - BODY_SIZE)};
+    bench.boxes[i] = (aabb_t){min, vec_add(min, (vector_t){BODY_SIZE,
+                                                           BODY_SIZE})};
+    bench.velocities[i] = (vector_t){random_uniform(-MAX_SPEED, MAX_SPEED),
+                                     random_uniform(-MAX_SPEED, MAX_SPEED)};
+  }
+  return bench;
+}
+
+void bench_free(bench_t bench) {
+  free(bench.boxes);
+  free(bench.velocities);
+  free(bench.leaves);
+}
+
+// Moves each body along its velocity, bouncing off the sides of the square
+void bench_step(bench_t *bench) {
+  for (size_t i = 0; i < bench->count; i++) {
+    aabb_t *box = &bench->boxes[i];
+    vector_t *velocity = &bench->velocities[i];
+    vector_t displacement = vec_multiply(BENCH_DT, *velocity);
+    box->min = vec_add(box->min, displacement);
+    box->max = vec_add(box->max, displacement);
+    if (box->min.x < 0 || box->max.x > bench->side) {
+      velocity->x = -velocity->x;
+    }
+    if (box->min.y < 0 || box->max.y > bench->side) {
+      velocity->y = -velocity->y;
+    }
+  }
+}
+
+size_t brute_force_pairs(bench_t *bench) {
+  size_t pairs = 0;
+  for (size_t i = 0; i < bench->count; i++) {
+    for (size_t j = i + 1; j < bench->count; j++) {
+      pairs += aabb_overlap(bench->boxes[i], bench->boxes[j]);
+    }
+  }
+  return pairs;
+}
+
+// Counts the bodies after query->index whose boxes overlap its box. Leaves'
+// boxes are fattened, so the bodies' own boxes are checked.
+bool count_pair(size_t leaf, void *aux) {
+  bench_query_t *query = aux;
+  aabb_t *boxes = query->bench->boxes;
+  size_t other = (aabb_t *)aabb_tree_get_data(query->tree, leaf) - boxes;
+  query->pairs += other > query->index &&
+                  aabb_overlap(boxes[query->index], boxes[other]);
+  return true;
+}
+
+// Moves each body's leaf, counting the leaves put back in the tree, then
+// counts the pairs by looking around each body
+size_t tree_pairs(bench_t *bench, aabb_tree_t *tree, size_t *reinserted) {
+  for (size_t i = 0; i < bench->count; i++) {
+    vector_t displacement =
+        vec_multiply(BENCH_LOOKAHEAD * BENCH_DT, bench->velocities[i]);
+    *reinserted +=
+        aabb_tree_move(tree, bench->leaves[i], bench->boxes[i], displacement);
+  }
+  bench_query_t query = {bench, tree, 0, 0};
+  for (query.index = 0; query.index < bench->count; query.index++) {
+    aabb_tree_query(tree, bench->boxes[query.index], count_pair, &query);
+  }
+  return query.pairs;
+}
+
+void run_bench(size_t count, size_t steps) {
+  srand(count);
+  bench_t bench = bench_init(count);
+  aabb_tree_t *tree = aabb_tree_init(BENCH_MARGIN);
+  for (size_t i = 0; i < count; i++) {
+    bench.leaves[i] = aabb_tree_insert(tree, bench.boxes[i], &bench.boxes[i]);
+  }
+
+  double brute_force_time = 0, tree_time = 0;
+  size_t pairs = 0, reinserted = 0;
+  for (size_t step = 0; step < steps; step++) {
+    bench_step(&bench);
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    size_t expected = brute_force_pairs(&bench);
+    brute_force_time += seconds_since(start);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    size_t found = tree_pairs(&bench, tree, &reinserted);
+    tree_time += seconds_since(start);
+    if (found != expected) {
+      fprintf(stderr, "%zu bodies, step %zu: tree found %zu pairs, not %zu\n",
+              count, step, found, expected);
+      exit(1);
+    }
+    pairs += found;
+  }
+  printf("%5zu bodies: %8.1f us/step brute force, %8.1f us/step tree "
+         "(%.1f pairs, %.1f%% of leaves reinserted per step, height %d)\n",
+         count, 1e6 * brute_force_time / steps, 1e6 * tree_time / steps,
+         (double)pairs / steps, 100.0 * reinserted / (steps * count),
+         aabb_tree_height(tree));
+  aabb_tree_free(tree);
+  bench_free(bench);
+}
+
+int main(int argc, char *argv[]) {
+  size_t steps = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_STEPS;
+  if (steps == 0) {
+    fprintf(stderr, "usage: %s [steps]\n", argv[0]);
+    return 1;
+  }
+  for (size_t i = 0; i < sizeof(BODY_COUNTS) / sizeof(BODY_COUNTS[0]); i++) {
+    run_bench(BODY_COUNTS[i], steps);
+  }
+  return 0;
+}
@@ -0,0 +1,152 @@
+#include "vector.h"
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/**
+ * Times the batch vector operations against the loops they replaced, for
+ * polygons of different numbers of vertices, and checks that both give the
+ * same results.
+ *
+ * Usage: bin/vector_bench [vertices per size]
+ */
+
+const size_t VERTEX_COUNTS[] = {4, 8, 16, 64, 256, 1024};
+// How many vertices are processed in total for each size and operation
+const size_t DEFAULT_TOTAL = 50000000;
+const double BENCH_ANGLE = 1e-3;
+
+double seconds_since(struct timespec start) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) * 1e-9;
+}
+
+// find_projection()'s loop before it used vec_project_all()
+vector_t project_loop(const double *x, const double *y, size_t n,
+                      vector_t axis) {
+  double min = DBL_MAX;
+  double max = -DBL_MAX;
+  for (size_t i = 0; i < n; i++) {
+    double d = axis.x * x[i] + axis.y * y[i];
+    if (d < min) {
+      min = d;
+    }
+    if (d > max) {
+      max = d;
+    }
+  }
+  return (vector_t){min, max};
+}
+
+// vertices_rotate()'s loop before it used vec_rotate_all()
+void rotate_loop(double *x, double *y, size_t n, double c, double s,
+                 vector_t point) {
+  for (size_t i = 0; i < n; i++) {
+    double dx = x[i] - point.x;
+    double dy = y[i] - point.y;
+    x[i] = dx * c - dy * s + point.x;
+    y[i] = dx * s + dy * c + point.y;
+  }
+}
+
+// polygon_rotate()'s loop before it found the cosine and sine once
+void rotate_each(vector_t *points, size_t n, double angle, vector_t point) {
+  for (size_t i = 0; i < n; i++) {
+    points[i] =
+        vec_add(vec_rotate(vec_subtract(points[i], point), angle), point);
+  }
+}
+
+// Fills a regular polygon's vertices
+void make_polygon(double *x, double *y, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    x[i] = cos(2 * M_PI * i / n);
+    y[i] = sin(2 * M_PI * i / n);
+  }
+}
+
+void run_bench(size_t n, size_t total) {
+  size_t reps = total / n;
+  double *x = malloc(n * sizeof(double)), *y = malloc(n * sizeof(double));
+  double *x2 = malloc(n * sizeof(double)), *y2 = malloc(n * sizeof(double));
+  vector_t *points = malloc(n * sizeof(vector_t));
+  make_polygon(x, y, n);
+  make_polygon(x2, y2, n);
+  for (size_t i = 0; i < n; i++) {
+    points[i] = (vector_t){x[i], y[i]};
+  }
+  vector_t axis = {0.6, 0.8};
+  double c = cos(BENCH_ANGLE), s = sin(BENCH_ANGLE);
+
+  // Each rep projects onto a slightly different axis so it can't be hoisted
+  struct timespec start;
+  volatile double sum = 0;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (size_t rep = 0; rep < reps; rep++) {
+    axis.x += 1e-12;
+    sum += project_loop(x, y, n, axis).y;
+  }
+  double project_before = seconds_since(start);
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (size_t rep = 0; rep < reps; rep++) {
+    axis.x -= 1e-12;
+    sum -= vec_project_all(x, y, n, axis).y;
+  }
+  double project_after = seconds_since(start);
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (size_t rep = 0; rep < reps; rep++) {
+    rotate_each(points, n, BENCH_ANGLE, VEC_ZERO);
+  }
+  double rotate_each_time = seconds_since(start);
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (size_t rep = 0; rep < reps; rep++) {
+    rotate_loop(x2, y2, n, c, s, VEC_ZERO);
+  }
+  double rotate_before = seconds_since(start);
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (size_t rep = 0; rep < reps; rep++) {
+    vec_rotate_all(x, y, n, c, s, VEC_ZERO);
+  }
+  double rotate_after = seconds_since(start);
+
+  for (size_t i = 0; i < n; i++) {
+    if (x[i] != x2[i] || y[i] != y2[i]) {
+      fprintf(stderr, "%zu vertices: vertex %zu rotated differently\n", n, i);
+      exit(1);
+    }
+  }
+  vector_t before = project_loop(x, y, n, axis);
+  vector_t after = vec_project_all(x, y, n, axis);
+  if (!vec_is_equal(before, after)) {
+    fprintf(stderr, "%zu vertices: projected differently\n", n);
+    exit(1);
+  }
+  printf("%5zu vertices: project %5.2f -> %5.2f ns/vertex, "
+         "rotate %5.2f (cos/sin each) -> %5.2f -> %5.2f ns/vertex\n",
+         n, 1e9 * project_before / (reps * n),
+         1e9 * project_after / (reps * n),
+         1e9 * rotate_each_time / (reps * n), 1e9 * rotate_before / (reps * n),
+         1e9 * rotate_after / (reps * n));
+  free(x);
+  free(y);
+  free(x2);
+  free(y2);
+  free(points);
+}
+
+int main(int argc, char *argv[]) {
+  size_t total = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_TOTAL;
+  if (total == 0) {
+    fprintf(stderr, "usage: %s [vertices per size]\n", argv[0]);
+    return 1;
+  }
+  for (size_t i = 0; i < sizeof(VERTEX_COUNTS) / sizeof(VERTEX_COUNTS[0]);
+       i++) {
+    run_bench(VERTEX_COUNTS[i], total);
+  }
+  return 0;
+}
@@ -0,0 +1,171 @@
+#ifndef __AABB_TREE_H__
+#define __AABB_TREE_H__
+
+#include "collision.h"
+#include "vector.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A dynamic bounding volume hierarchy: a binary tree whose leaves are boxes,
+ * each holding a pointer to whatever it bounds, and whose other nodes hold the
+ * smallest box around their children. Queries only visit the subtrees whose
+ * boxes they touch, so they take about log(n) time rather than n.
+ *
+ * Leaves can be added, removed and moved one at a time. A new leaf goes next
+ * to the existing node which grows the tree's boxes the least, and the tree
+ * is rotated where one side of a node becomes much deeper than the other, so
+ * it stays balanced however the leaves arrive.
+ *
+ * Each leaf's box is fattened by a margin, and stretched along the way it is
+ * moving, so a leaf which moves a little stays inside its box and is left
+ * where it is. Only leaves which move out of their boxes are taken out and
+ * put back in. Queries may therefore find leaves whose own boxes are a little
+ * way off, which whoever owns the leaves can check exactly.
+ *
+ * Leaves are named by indices, which stay the same until they are removed.
+ */
+typedef struct aabb_tree aabb_tree_t;
+
+/** The index of no leaf */
+static const size_t AABB_TREE_NONE = SIZE_MAX;
+
+/**
+ * A function called by aabb_tree_query() for each leaf whose box overlaps
+ * the query box.
+ *
+ * @param leaf the index of the leaf
+ * @param aux the auxiliary value passed to aabb_tree_query()
+ * @return whether to keep looking for more leaves
+ */
+typedef bool (*tree_query_handler_t)(size_t leaf, void *aux);
+
+/**
+ * A function called by aabb_tree_raycast() for each leaf whose box the ray
+ * passes through before max_distance.
+ *
+ * @param leaf the index of the leaf
+ * @param max_distance how far along the ray the search still looks
+ * @param aux the auxiliary value passed to aabb_tree_raycast()
+ * @return how far along the ray it hits whatever the leaf bounds, or INFINITY
+ *   if it misses it. The search stops looking past the nearest hit so far.
+ */
+typedef double (*tree_ray_handler_t)(size_t leaf, double max_distance,
+                                     void *aux);
+
+/**
+ * Allocates an empty tree.
+ *
+ * @param margin how much to fatten each leaf's box by on every side, as a
+ *   fraction of its longest side, or 0 to keep leaves' boxes exact
+ * @return a pointer to the new tree
+ */
+aabb_tree_t *aabb_tree_init(double margin);
+
+/**
+ * Releases the memory allocated for a tree. Does not free its leaves' data.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ */
+void aabb_tree_free(aabb_tree_t *tree);
+
+/**
+ * Adds a leaf to a tree.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param box the box around whatever the leaf bounds, which is fattened
+ * @param data whatever the box bounds
+ * @return the index of the new leaf
+ */
+size_t aabb_tree_insert(aabb_tree_t *tree, aabb_t box, void *data);
+
+/**
+ * Removes a leaf from a tree. Its index may be reused by a later leaf.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param leaf the index returned when the leaf was inserted
+ */
+void aabb_tree_remove(aabb_tree_t *tree, size_t leaf);
+
+/**
+ * Updates the box of a leaf, keeping its index. If the box has left the
+ * leaf's fattened box, the leaf is put back in the tree with a new fattened
+ * box, which is also stretched by the displacement expected before the next
+ * move. Otherwise, nothing changes.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param leaf the index returned when the leaf was inserted
+ * @param box the new box around whatever the leaf bounds
+ * @param displacement how far whatever the leaf bounds is likely to move
+ *   before it is next moved, or VEC_ZERO if it is not known
+ * @return whether the leaf was put back in the tree
+ */
+bool aabb_tree_move(aabb_tree_t *tree, size_t leaf, aabb_t box,
+                    vector_t displacement);
+
+/**
+ * Gets the box of a leaf.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param leaf the index returned when the leaf was inserted
+ * @return the leaf's fattened box, which contains the box it was last given
+ */
+aabb_t aabb_tree_get_box(aabb_tree_t *tree, size_t leaf);
+
+/**
+ * Gets the data of a leaf.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param leaf the index returned when the leaf was inserted
+ * @return the data the leaf was inserted with
+ */
+void *aabb_tree_get_data(aabb_tree_t *tree, size_t leaf);
+
+/**
+ * Gets the number of leaves in a tree.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @return the number of leaves inserted and not yet removed
+ */
+size_t aabb_tree_size(aabb_tree_t *tree);
+
+/**
+ * Gets the height of a tree, i.e. the number of nodes on its longest path
+ * from the root to a leaf, less one. An empty tree has height -1.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @return the height of the tree
+ */
+int aabb_tree_height(aabb_tree_t *tree);
+
+/**
+ * Calls a handler for each leaf whose box overlaps a box.
+ * Boxes which only touch along an edge are considered overlapping.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param box the box to look in
+ * @param handler a function to call with each leaf found
+ * @param aux an auxiliary value to pass to handler
+ */
+void aabb_tree_query(aabb_tree_t *tree, aabb_t box,
+                     tree_query_handler_t handler, void *aux);
+
+/**
+ * Casts a circle through a tree, calling a handler for each leaf whose box
+ * the circle passes through within max_distance of the origin. Once the
+ * handler reports a hit, boxes further along than it are skipped.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param origin where the center of the circle starts
+ * @param direction the unit vector the circle moves along
+ * @param radius the radius of the circle, or 0 to cast a ray
+ * @param max_distance how far to cast the circle
+ * @param handler a function to call with each leaf found
+ * @param aux an auxiliary value to pass to handler
+ */
+void aabb_tree_raycast(aabb_tree_t *tree, vector_t origin, vector_t direction,
+                       double radius, double max_distance,
+                       tree_ray_handler_t handler, void *aux);
+
+#endif // #ifndef __AABB_TREE_H__
@@ -0,0 +1,107 @@
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include "list.h"
+#include <stddef.h>
+
+/**
+ * A region of memory which many small objects are allocated from, and which
+ * is freed all at once. It gets memory from malloc() in large chunks and
+ * hands out blocks from them, so a scene's worth of bodies, forces and lists
+ * takes a few calls to malloc() rather than thousands.
+ *
+ * Blocks come in sizes which are powers of two. A block given back with
+ * arena_release() goes into a pool of free blocks of its size, and is handed
+ * out again before any new memory is used. Blocks too big for any pool get a
+ * chunk of their own, which is kept until the arena is freed.
+ *
+ * An arena isn't safe to use from more than one thread at once.
+ */
+typedef struct arena arena_t;
+
+/**
+ * Counts of what an arena has done since it was made.
+ */
+typedef struct {
+  /** How many times the arena called malloc() */
+  size_t chunks;
+  /** How many bytes it got from malloc() */
+  size_t bytes;
+  /** How many blocks it has handed out */
+  size_t allocations;
+  /** How many of those were blocks given back and handed out again */
+  size_t reuses;
+  /** How many blocks have been given back */
+  size_t releases;
+} arena_stats_t;
+
+/** The smallest chunk an arena can be made with */
+static const size_t ARENA_MIN_CHUNK = 16384;
+
+/**
+ * Allocates an empty arena.
+ * Asserts that the required memory was allocated.
+ *
+ * @param chunk_size how many bytes to get from malloc() at a time, at least
+ *   ARENA_MIN_CHUNK
+ * @return a pointer to the newly allocated arena
+ */
+arena_t *arena_init(size_t chunk_size);
+
+/**
+ * Allocates a block from an arena, aligned for any type.
+ * Asserts that the required memory was allocated.
+ *
+ * @param arena a pointer to an arena returned from arena_init()
+ * @param size the number of bytes the block needs
+ * @return a pointer to the block
+ */
+void *arena_alloc(arena_t *arena, size_t size);
+
+/**
+ * Moves a block into a new one of a different size, copying what it held and
+ * giving it back, like realloc().
+ *
+ * @param arena a pointer to an arena returned from arena_init()
+ * @param block a block returned from arena_alloc(), or NULL for a new block
+ * @param old_size how many bytes of the block to keep
+ * @param size the number of bytes the new block needs
+ * @return a pointer to the new block
+ */
+void *arena_realloc(arena_t *arena, void *block, size_t old_size,
+                    size_t size);
+
+/**
+ * Gives a block back to the arena it came from, to be handed out again.
+ * Since it takes just the block, it can be used as a free_func_t.
+ *
+ * @param block a block returned from arena_alloc(), or NULL to do nothing
+ */
+void arena_release(void *block);
+
+/**
+ * Gets an allocator which allocates from an arena, e.g. to keep a list in it
+ * (see list_init_with_allocator()).
+ *
+ * @param arena a pointer to an arena returned from arena_init()
+ * @return the allocator
+ */
+allocator_t arena_allocator(arena_t *arena);
+
+/**
+ * Gets the counts of what an arena has done since it was made.
+ *
+ * @param arena a pointer to an arena returned from arena_init()
+ * @return the counts
+ */
+arena_stats_t arena_get_stats(arena_t *arena);
+
+/**
+ * Releases all the memory in an arena, and the arena itself. Every block
+ * allocated from it becomes invalid, whether or not it was given back.
+ *
+ * @param arena a pointer to an arena returned from arena_init()
+ */
+void arena_free(arena_t *arena);
+
+#endif // #ifndef __ARENA_H__
@@ -1,9 +1,11 @@
 #ifndef __BODY_H__
 #define __BODY_H__
 
+#include "collision.h"
 #include "color.h"
 #include "list.h"
 #include "vector.h"
+#include "vertices.h"
 #include <SDL2/SDL.h>
 #include <SDL2/SDL2_gfxPrimitives.h>
 #include <SDL2/SDL_image.h>
@@ -17,6 +19,18 @@
  */
 typedef struct body body_t;
 
+/**
+ * An image to draw bodies with, from sdl_load_image().
+ * It may be a part of a texture holding other images too.
+ */
+typedef struct sprite sprite_t;
+
+/**
+ * The speed below which a body is at rest. Friction stops bodies slower than
+ * this outright, and a body this slow with nothing pushing it falls asleep.
+ */
+static const double REST_SPEED = 1;
+
 /**
  * Initializes a body without any info.
  * Acts like body_init_with_info() where info and info_freer are NULL.
@@ -36,6 +50,8 @@ body_t *body_init_with_info(list_t *shape, double mass, rgb_color_t color,
  * The body is initially at rest.
  * Asserts that the mass is positive and that the required memory is allocated.
  *
+ * The body copies the vertices and frees shape, which must not be used again.
+ *
  * @param shape a list of vectors describing the initial shape of the body
  * @param mass the mass of the body (if INFINITY, stops the body from moving)
  * @param color the color of the body, used to draw it on the screen
@@ -47,11 +63,100 @@ body_t *body_init_with_info(list_t *shape, double mass, rgb_color_t color,
  */
 body_t *body_init_with_info_and_sprite(list_t *shape, double mass,
                                        rgb_color_t color, void *info,
-                                       SDL_Texture *image_path,
+                                       sprite_t *image_path,
                                        free_func_t info_freer);
 
+/**
+ * Allocates memory for a body whose shape is already a packed polygon.
+ * Acts like body_init_with_info_and_sprite(), but takes ownership of shape
+ * instead of copying it, so it must not be used or freed by the caller.
+ *
+ * @param shape a packed polygon describing the initial shape of the body
+ * @param mass the mass of the body (if INFINITY, stops the body from moving)
+ * @param color the color of the body, used to draw it on the screen
+ * @param info additional information to associate with the body
+ * @param image the sprite attached to the body, or NULL
+ * @param info_freer if non-NULL, a function call on the info to free it
+ * @return a pointer to the newly allocated body
+ */
+body_t *body_init_with_vertices(vertices_t *shape, double mass,
+                                rgb_color_t color, void *info,
+                                sprite_t *image, free_func_t info_freer);
+
+/**
+ * Initializes a circular body without any info.
+ * Acts like body_init_circle_with_info_and_sprite() where info, image, and
+ * info_freer are NULL.
+ */
+body_t *body_init_circle(vector_t center, double radius, double mass,
+                         rgb_color_t color);
+
+/**
+ * Allocates memory for a circular body with the given parameters.
+ * The circle is stored exactly as a center and a radius rather than as
+ * a polygon, so collisions with it are cheaper and more accurate.
+ * The body is initially at rest.
+ * Asserts that the mass is nonzero and the radius is positive.
+ *
+ * @param center the initial center of the circle, which is its centroid
+ * @param radius the radius of the circle
+ * @param mass the mass of the body (if INFINITY, stops the body from moving)
+ * @param color the color of the body, used to draw it on the screen
+ * @param info additional information to associate with the body
+ * @param image the sprite attached to the body, or NULL
+ * @param info_freer if non-NULL, a function call on the info to free it
+ * @return a pointer to the newly allocated body
+ */
+body_t *body_init_circle_with_info_and_sprite(vector_t center, double radius,
+                                              double mass, rgb_color_t color,
+                                              void *info, sprite_t *image,
+                                              free_func_t info_freer);
+
+/**
+ * Allocates a body like body_init_with_info_and_sprite(), but takes the
+ * memory for the body and its vertices from an allocator, e.g. a scene's
+ * arena (see scene_get_arena()), rather than malloc(). The shape list is
+ * freed as usual. A body allocated from an arena must be freed before the
+ * arena is.
+ *
+ * @param shape a list of vectors describing the initial shape of the body
+ * @param mass the mass of the body (if INFINITY, stops the body from moving)
+ * @param color the color of the body, used to draw it on the screen
+ * @param info additional information to associate with the body
+ * @param image the sprite attached to the body, or NULL
+ * @param info_freer if non-NULL, a function call on the info to free it
+ * @param allocator where to get the body's memory from
+ * @return a pointer to the newly allocated body
+ */
+body_t *body_init_with_allocator(list_t *shape, double mass,
+                                 rgb_color_t color, void *info,
+                                 sprite_t *image, free_func_t info_freer,
+                                 allocator_t allocator);
+
+/**
+ * Allocates a circular body like body_init_circle_with_info_and_sprite(), but
+ * takes its memory from an allocator, as body_init_with_allocator() does.
+ *
+ * @param center the initial center of the circle, which is its centroid
+ * @param radius the radius of the circle
+ * @param mass the mass of the body (if INFINITY, stops the body from moving)
+ * @param color the color of the body, used to draw it on the screen
+ * @param info additional information to associate with the body
+ * @param image the sprite attached to the body, or NULL
+ * @param info_freer if non-NULL, a function call on the info to free it
+ * @param allocator where to get the body's memory from
+ * @return a pointer to the newly allocated body
+ */
+body_t *body_init_circle_with_allocator(vector_t center, double radius,
+                                        double mass, rgb_color_t color,
+                                        void *info, sprite_t *image,
+                                        free_func_t info_freer,
+                                        allocator_t allocator);
+
 /**
  * Releases the memory allocated for a body.
+ * Drops the body's references to its image and shadow (see
+ * sdl_release_image()).
  *
  * @param body a pointer to a body returned from body_init()
  */
@@ -60,12 +165,23 @@ void body_free(body_t *body);
 /**
  * Gets the current shape of a body.
  * Returns a newly allocated vector list, which must be list_free()d.
+ * A circular body is approximated by a polygon, as in draw_circle().
  *
  * @param body a pointer to a body returned from body_init()
  * @return the polygon describing the body's current position
  */
 list_t *body_get_shape(body_t *body);
 
+/**
+ * Gets a read-only view of the current shape of a body without copying it.
+ * The view borrows the body's own vertices, so it must not be modified or
+ * freed, and it is only valid until the body is moved, rotated, or freed.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return a view of the polygon describing the body's current position
+ */
+shape_view_t body_get_shape_view(body_t *body);
+
 /**
  * Gets the current angle of body
  *
@@ -101,6 +217,28 @@ vector_t body_get_center(body_t *body);
  */
 vector_t body_get_velocity(body_t *body);
 
+/**
+ * Records where a body's center of mass is as where it was before its tick,
+ * for body_get_interpolated_centroid(). scene_tick() does this for its bodies
+ * once per tick, however many steps it splits the tick into.
+ *
+ * @param body a pointer to a body returned from body_init()
+ */
+void body_save_centroid(body_t *body);
+
+/**
+ * Gets a point between where a body's center of mass was before its last
+ * tick (see body_save_centroid()) and where it is now. body_set_centroid()
+ * moves both points, so a body which is placed rather than moved is drawn at
+ * its new position.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param alpha how far to go from the previous centroid to the current one,
+ *   from 0 (the previous centroid) to 1 (the current centroid)
+ * @return the interpolated center of mass
+ */
+vector_t body_get_interpolated_centroid(body_t *body, double alpha);
+
 /**
  * Gets the mass of a body.
  *
@@ -131,7 +269,7 @@ void *body_get_info(body_t *body);
  * @param body a pointer to a body returned from body_init()
  * @return the image if it exists, NULL if it does not
  */
-SDL_Texture *body_get_image(body_t *body);
+sprite_t *body_get_image(body_t *body);
 
 /**
  * Gets the image path associated with a body.
@@ -139,7 +277,7 @@ SDL_Texture *body_get_image(body_t *body);
  * @param body a pointer to a body returned from body_init()
  * @return the shadow if it exists, NULL if it does not
  */
-SDL_Texture *body_get_shadow(body_t *body);
+sprite_t *body_get_shadow(body_t *body);
 
 /**
  * Gets the dimensions associated with a body.
@@ -149,6 +287,33 @@ SDL_Texture *body_get_shadow(body_t *body);
  */
 vector_t body_get_dimensions(body_t *body);
 
+/**
+ * Gets the smallest axis-aligned box containing a body's current shape.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the bounding box of the body
+ */
+aabb_t body_get_bounds(body_t *body);
+
+/**
+ * Gets the collision type of a body.
+ * Bodies start with type -1, which matches no collision handlers.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the type passed to body_set_type()
+ */
+int body_get_type(body_t *body);
+
+/**
+ * Sets the collision type of a body. The scene uses this type to decide which
+ * collision handlers apply to the body (see scene_add_collision_handler()).
+ * Asserts that the type is between -1 and 31.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param type the body's new type, or -1 to opt out of collision handlers
+ */
+void body_set_type(body_t *body, int type);
+
 /**
  * Translates a body to a new position.
  * The position is specified by the position of the body's center of mass.
@@ -160,6 +325,7 @@ void body_set_centroid(body_t *body, vector_t v);
 
 /**
  * Changes a body's velocity (the time-derivative of its position).
+ * A velocity other than zero wakes the body.
  *
  * @param body a pointer to a body returned from body_init()
  * @param v the body's new velocity
@@ -205,19 +371,22 @@ void body_set_dimensions(body_t *body, vector_t dimensions);
 
 /**
  * Sets the image of a sprite in the scene.
+ * The body takes over the caller's reference to image, e.g. from
+ * sdl_load_image(), and drops its reference to the image it had.
  *
  * @param body a pointer to a body returned from body_init()
  * @param image the body's new sprite.
  */
-void body_set_image(body_t *body, SDL_Texture *image);
+void body_set_image(body_t *body, sprite_t *image);
 
 /**
  * Sets the shadow of a sprite in the scene.
+ * Like body_set_image(), the body takes over the reference to shadow.
  *
  * @param body a pointer to a body returned from body_init()
  * @param shadow the body's new shadow sprite.
  */
-void body_set_shadow(body_t *body, SDL_Texture *shadow);
+void body_set_shadow(body_t *body, sprite_t *shadow);
 
 /**
  * @brief Rotates a body about a point
@@ -240,6 +409,7 @@ void body_translate(body_t *body, vector_t displacement);
  * Applies a force to a body over the current tick.
  * If multiple forces are applied in the same tick, they should be added.
  * Should not change the body's position or velocity; see body_tick().
+ * A force other than zero wakes the body.
  *
  * @param body a pointer to a body returned from body_init()
  * @param force the force vector to apply
@@ -252,6 +422,7 @@ void body_add_force(body_t *body, vector_t force);
  * which is useful for modeling collisions.
  * If multiple impulses are applied in the same tick, they should be added.
  * Should not change the body's position or velocity; see body_tick().
+ * An impulse other than zero wakes the body.
  *
  * @param body a pointer to a body returned from body_init()
  * @param impulse the impulse vector to apply
@@ -271,6 +442,39 @@ void body_add_impulse(body_t *body, vector_t impulse);
  */
 void body_tick(body_t *body, double dt);
 
+/**
+ * Returns whether a body is at rest: slower than REST_SPEED, with no force or
+ * impulse applied to it since its last tick.
+ *
+ * @param body the body to check
+ * @return whether the body would barely move in its next tick
+ */
+bool body_is_resting(body_t *body);
+
+/**
+ * Puts a body to sleep, stopping it where it is. scene_tick() skips sleeping
+ * bodies until something wakes them: a velocity, force or impulse, moving or
+ * rotating them, or another body colliding with them.
+ *
+ * @param body the body to put to sleep
+ */
+void body_sleep(body_t *body);
+
+/**
+ * Wakes a body put to sleep by body_sleep(). Does nothing if it is awake.
+ *
+ * @param body the body to wake
+ */
+void body_wake(body_t *body);
+
+/**
+ * Returns whether a body is asleep. Bodies start awake.
+ *
+ * @param body the body to check
+ * @return whether body_sleep() has been called on the body since it last woke
+ */
+bool body_is_asleep(body_t *body);
+
 /**
  * Marks a body for removal--future calls to body_is_removed() will return
  * true. Does not free the body. If the body is already marked for removal,
@@ -291,8 +495,36 @@ void body_remove(body_t *body);
 bool body_is_removed(body_t *body);
 
 /**
- * Dilates the internal list of vectors for a body in the x
- * direction by a given amount
+ * Gets the slot the scene holding a body keeps it in (see body_handle_t),
+ * so the scene can find its own record of the body without searching.
+ * Only the scene should set this.
+ *
+ * @param body the body
+ * @return the slot last set with body_set_slot(), or SIZE_MAX
+ */
+size_t body_get_slot(body_t *body);
+
+/**
+ * Sets the slot the scene holding a body keeps it in.
+ *
+ * @param body the body
+ * @param slot the slot
+ */
+void body_set_slot(body_t *body, size_t slot);
+
+/**
+ * Sets the count of moving bodies kept by the scene holding a body. Giving
+ * the body a velocity, force or impulse adds to it, so the scene knows the
+ * body is moving before its next tick. Only the scene should set this.
+ *
+ * @param body the body
+ * @param awake_count the count, or NULL if the body is in no scene
+ */
+void body_set_awake_count(body_t *body, size_t *awake_count);
+
+/**
+ * Dilates the internal vertices of a body in the x
+ * direction by a given amount. Asserts that the body is not a circle.
  *
  * @param body body to dilate
  * @param factor amount to stretch each vector by
@@ -347,6 +579,44 @@ void body_hide(body_t *body, bool hidden);
  */
 bool body_hidden(body_t *body);
 
+/**
+ * Marks a body to be drawn into the background, which is drawn once and then
+ * shown behind the other bodies each frame. A background body shouldn't
+ * move. The background is only drawn again when the window's size changes or
+ * sdl_invalidate_background() is called, so whoever changes a background
+ * body's image, size or visibility, or the scene being drawn, should call it.
+ *
+ * @param body body to put in or take out of the background
+ * @param background whether it is in the background
+ */
+void body_set_background(body_t *body, bool background);
+
+/**
+ * Returns whether a body is drawn into the background
+ *
+ * @param body body in question
+ * @return whether it is in the background
+ */
+bool body_is_background(body_t *body);
+
+/**
+ * Sets the layer a body is drawn in. Bodies in lower layers are drawn first,
+ * and bodies in the same layer are drawn in the order they were added to
+ * their scene. Bodies start in layer 0.
+ *
+ * @param body body to move to another layer
+ * @param layer the layer
+ */
+void body_set_layer(body_t *body, int layer);
+
+/**
+ * Returns the layer a body is drawn in
+ *
+ * @param body body in question
+ * @return its layer
+ */
+int body_get_layer(body_t *body);
+
 /**
  * Marks a body for whether it should respawn on the next turn.
  * Note that this does not indicate where it should respawn (that
@@ -3,6 +3,7 @@
 
 #include "list.h"
 #include "vector.h"
+#include "vertices.h"
 #include <stdbool.h>
 
 /**
@@ -19,8 +20,50 @@ typedef struct {
    * If collided is false, this value is undefined.
    */
   vector_t axis;
+  /**
+   * If the shapes are colliding, how far they overlap along the axis.
+   * If collided is false, this value is 0.
+   */
+  double depth;
 } collision_info_t;
 
+/**
+ * An axis-aligned bounding box, given by its bottom left and top right corners.
+ */
+typedef struct {
+  vector_t min;
+  vector_t max;
+} aabb_t;
+
+/**
+ * The kinds of shapes that collisions can be computed between.
+ */
+typedef enum { SHAPE_POLYGON, SHAPE_CIRCLE } shape_kind_t;
+
+/**
+ * A read-only view of a shape, borrowed from whoever owns it.
+ * A polygon's x and y coordinates are packed into separate arrays
+ * (see vertices.h), listed in counterclockwise order.
+ * A circle is given exactly by its center and radius, without any vertices.
+ * A view is only valid until its owner moves, reshapes, or frees the shape.
+ */
+typedef struct {
+  shape_kind_t kind;
+  /** The vertices of a polygon. Unused for circles. */
+  const double *x;
+  const double *y;
+  size_t size;
+  /**
+   * Optionally, the unit normal of each of a polygon's edges, as computed by
+   * vertices_normals(). If NULL, the normals are computed when needed.
+   */
+  const double *nx;
+  const double *ny;
+  /** The center and radius of a circle. Unused for polygons. */
+  vector_t center;
+  double radius;
+} shape_view_t;
+
 /**
  * Computes the status of the collision between two convex polygons.
  * The shapes are given as lists of vertices in counterclockwise order.
@@ -34,4 +77,136 @@ typedef struct {
  */
 collision_info_t find_collision(list_t *shape1, list_t *shape2);
 
+/**
+ * Computes the status of the collision between two convex shapes,
+ * like find_collision(), but reads the shapes through borrowed views.
+ * Does not allocate any memory, so it is cheap enough to call for every
+ * pair of bodies on every tick.
+ *
+ * Pairs of circles are compared by the distance between their centers,
+ * and a circle and a polygon are tested against the polygon's edge normals
+ * and the axis from the polygon's nearest vertex to the circle's center.
+ * If either shape is a circle, the axis is the exact contact normal.
+ *
+ * @param shape1 the first shape
+ * @param shape2 the second shape
+ * @return whether the shapes are colliding, and if so, the collision axis.
+ * The axis should be a unit vector pointing from shape1 towards shape2.
+ */
+collision_info_t find_collision_view(shape_view_t shape1, shape_view_t shape2);
+
+/**
+ * Finds when two shapes moving at constant velocities first collide.
+ * Neither shape rotates. At least one shape must be a circle: two circles are
+ * swept against each other exactly, and a circle against a polygon by casting
+ * its motion relative to the polygon against the polygon grown by its radius.
+ * Fast shapes can pass through each other between two ticks without ever
+ * overlapping, so this is used to stop a tick at the moment they would touch.
+ *
+ * @param shape1 the first shape, where it is at time 0
+ * @param velocity1 the velocity of the first shape
+ * @param shape2 the second shape, where it is at time 0
+ * @param velocity2 the velocity of the second shape
+ * @param slop how far the shapes should overlap at the time returned, so that
+ *   find_collision_view() reports them as colliding then.
+ *   Must be smaller than the radius of each circle.
+ * @param max_time the longest time to look ahead
+ * @return the first time in [0, max_time] at which the shapes overlap by slop,
+ *   which is 0 if they already do, or INFINITY if they don't within max_time
+ *   or are both polygons
+ */
+double find_time_of_impact(shape_view_t shape1, vector_t velocity1,
+                           shape_view_t shape2, vector_t velocity2,
+                           double slop, double max_time);
+
+/**
+ * Finds when a point moving from start at a constant velocity first comes
+ * within radius of a center.
+ *
+ * @param start where the point is at time 0
+ * @param velocity the velocity of the point
+ * @param center the center of the circle
+ * @param radius the radius of the circle
+ * @return the first time at which the point is on the circle, which is 0 if
+ *   it starts inside it heading inwards, or INFINITY if it never reaches it
+ */
+double ray_circle_impact(vector_t start, vector_t velocity, vector_t center,
+                         double radius);
+
+/**
+ * Finds when a point moving from start at a constant velocity first comes
+ * within radius of the segment from a to b, i.e. hits the capsule around it.
+ *
+ * @param start where the point is at time 0, further than radius from the
+ *   segment
+ * @param velocity the velocity of the point
+ * @param a one end of the segment
+ * @param b the other end of the segment
+ * @param radius the radius of the capsule
+ * @return the first time at which the point is on the capsule,
+ *   or INFINITY if it never reaches it
+ */
+double ray_capsule_impact(vector_t start, vector_t velocity, vector_t a,
+                          vector_t b, double radius);
+
+/**
+ * Returns whether a point is inside a convex shape or on its boundary.
+ *
+ * @param shape the shape
+ * @param point the point
+ * @return whether the shape contains the point
+ */
+bool shape_contains_point(shape_view_t shape, vector_t point);
+
+/**
+ * Casts a circle from start along a direction, and finds how far it goes
+ * before it touches a convex shape. With a radius of 0, this casts a ray.
+ *
+ * @param shape the shape to cast against
+ * @param start where the center of the circle starts
+ * @param direction the unit vector the circle moves along
+ * @param radius the radius of the circle
+ * @param normal set to the unit normal of the shape's surface where the
+ *   circle touches it, facing the circle, if it touches it
+ * @return how far the circle goes before it touches the shape, which is 0 if
+ *   it already overlaps it, or INFINITY if it never touches it
+ */
+double find_circle_cast(shape_view_t shape, vector_t start, vector_t direction,
+                        double radius, vector_t *normal);
+
+/**
+ * Computes the smallest axis-aligned box containing a polygon.
+ *
+ * @param shape a view of the vertices of the polygon
+ * @return the bounding box of the polygon
+ */
+aabb_t find_bounds(shape_view_t shape);
+
+/**
+ * Gets a read-only view of a packed polygon's vertices.
+ *
+ * @param vertices a pointer to a polygon returned from vertices_init()
+ * @return a view which is valid until the polygon is changed or freed
+ */
+shape_view_t vertices_view(vertices_t *vertices);
+
+/**
+ * Gets a view of a circle.
+ *
+ * @param center the center of the circle
+ * @param radius the radius of the circle
+ * @return a view of the circle
+ */
+shape_view_t circle_view(vector_t center, double radius);
+
+/**
+ * Returns whether two axis-aligned boxes overlap.
+ * Boxes which only touch along an edge are considered overlapping.
+ *
+ * @param box1 the first box
+ * @param box2 the second box
+ * @return whether the boxes overlap
+ */
+bool aabb_overlap(aabb_t box1, aabb_t box2);
+
 #endif // #ifndef __COLLISION_H__
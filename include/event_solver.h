@@ -0,0 +1,70 @@
+#ifndef __EVENT_SOLVER_H__
+#define __EVENT_SOLVER_H__
+
+#include "scene.h"
+#include <stddef.h>
+
+/**
+ * Steps a scene from one event to the next instead of by small ticks.
+ *
+ * Between contacts, a ball sliding under friction slows down at a constant
+ * rate along a straight line, so where it will be at any time is known in
+ * closed form. The solver uses this to predict when each ball will stop and
+ * when each pair of bodies with a collision handler will next collide,
+ * keeping the predictions in a priority queue. Each step moves every ball
+ * straight to the earliest event and resolves it with a scene_tick() of
+ * length 0, which calls the scene's collision handlers. Only the events of
+ * bodies whose motion was changed by the handlers are predicted again.
+ *
+ * The solver assumes that every moving body is a circle, slowed by the same
+ * constant deceleration (see create_gravity_friction()), and that no other
+ * forces act. Bodies which are not circles are treated as still.
+ */
+typedef struct event_solver event_solver_t;
+
+/**
+ * Allocates a solver for a scene and predicts its first events.
+ * The scene's bodies and collision handlers must not be changed while the
+ * solver is in use, except by the collision handlers themselves.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param deceleration how quickly moving balls slow down, e.g. MU * G
+ * @return a pointer to the new solver
+ */
+event_solver_t *event_solver_init(scene_t *scene, double deceleration);
+
+/**
+ * Releases the memory allocated for a solver. Does not free its scene.
+ *
+ * @param solver a pointer to a solver returned from event_solver_init()
+ */
+void event_solver_free(event_solver_t *solver);
+
+/**
+ * Moves the scene to its next event and resolves it, or moves it by
+ * max_time if that comes first. If nothing is moving, there are no more
+ * events, and the scene is left as it is.
+ *
+ * @param solver a pointer to a solver returned from event_solver_init()
+ * @param max_time the longest time to move the scene by
+ * @return the time the scene was moved by
+ */
+double event_solver_step(event_solver_t *solver, double max_time);
+
+/**
+ * Gets the time the solver has moved its scene by in total.
+ *
+ * @param solver a pointer to a solver returned from event_solver_init()
+ * @return the sum of every time returned by event_solver_step()
+ */
+double event_solver_get_time(event_solver_t *solver);
+
+/**
+ * Gets how many events the solver has resolved.
+ *
+ * @param solver a pointer to a solver returned from event_solver_init()
+ * @return the number of events resolved so far
+ */
+size_t event_solver_events(event_solver_t *solver);
+
+#endif // #ifndef __EVENT_SOLVER_H__
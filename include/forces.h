@@ -5,33 +5,14 @@
 #include "sound_set.h"
 
 /**
- * A function called when a collision occurs.
- * @param body1 the first body passed to create_collision()
- * @param body2 the second body passed to create_collision()
- * @param axis a unit vector pointing from body1 towards body2
- *   that defines the direction the two bodies are colliding in
- * @param aux the auxiliary value passed to create_collision()
- */
-typedef void (*collision_handler_t)(body_t *body1, body_t *body2, vector_t axis,
-                                    void *aux);
-
-/**
- * A function called to create sound when a collision occurs
- * @param sound_set set of sounds to determine sound played on collision
- * @param body1 the first body passed to create_collision()
- * @param body2 the second body passed to create_collision()
- */
-typedef void (*collision_sound_handler_t)(sound_set_t *sound_set, body_t *body1,
-                                          body_t *body2);
-
-/**
- * Adds a force creator to a scene that applies gravity between two bodies.
- * The force creator will be called each tick
+ * Adds a typed force to a scene that applies gravity between two bodies.
+ * The force will be applied each tick (see scene_add_force_term())
  * to compute the Newtonian gravitational force between the bodies.
  * See
  * https://en.wikipedia.org/wiki/Newton%27s_law_of_universal_gravitation#Vector_form.
  * The force should not be applied when the bodies are very close,
  * because its magnitude blows up as the distance between the bodies goes to 0.
+ * Bodies at exactly the same place don't pull on each other at all.
  *
  * @param scene the scene containing the bodies
  * @param G the gravitational proportionality constant
@@ -42,8 +23,27 @@ void create_newtonian_gravity(scene_t *scene, double G, body_t *body1,
                               body_t *body2);
 
 /**
- * Adds a force creator to a scene that acts like a spring between two bodies.
- * The force creator will be called each tick
+ * Adds a force creator to a scene that applies Newtonian gravity between
+ * every pair of bodies in the scene, including bodies added later, as
+ * create_newtonian_gravity() would, but much faster for many bodies.
+ * Bodies of infinite mass and bodies which don't apply forces are left out.
+ *
+ * With theta above 0, the bodies are sorted into a Barnes-Hut quadtree each
+ * tick, and a square of bodies whose side is less than theta times its
+ * distance pulls like one body at its center of mass. This takes
+ * O(n log n) time, and 0.5 is a typical theta; smaller is more exact.
+ * With theta 0, every pair is computed exactly, which takes O(n^2) time but
+ * is faster for a few hundred bodies or fewer.
+ *
+ * @param scene the scene containing the bodies
+ * @param G the gravitational proportionality constant
+ * @param theta the Barnes-Hut opening angle, or 0 to compute every pair
+ */
+void create_gravity_field(scene_t *scene, double G, double theta);
+
+/**
+ * Adds a typed force to a scene that acts like a spring between two bodies.
+ * The force will be applied each tick (see scene_add_force_term())
  * to compute the Hooke's-Law spring force between the bodies.
  * See https://en.wikipedia.org/wiki/Hooke%27s_law.
  *
@@ -55,8 +55,8 @@ void create_newtonian_gravity(scene_t *scene, double G, body_t *body1,
 void create_spring(scene_t *scene, double k, body_t *body1, body_t *body2);
 
 /**
- * Adds a force creator to a scene that applies a drag force on a body.
- * The force creator will be called each tick
+ * Adds a typed force to a scene that applies a drag force on a body.
+ * The force will be applied each tick (see scene_add_force_term())
  * to compute the drag force on the body proportional to its velocity.
  * The force points opposite the body's velocity.
  *
@@ -68,8 +68,8 @@ void create_spring(scene_t *scene, double k, body_t *body1, body_t *body2);
 void create_drag(scene_t *scene, double gamma, body_t *body);
 
 /**
- * Adds a force creator to a scene that applies a friction on a body.
- * The force creator will be called each itck
+ * Adds a typed force to a scene that applies a friction on a body.
+ * The force will be applied each tick (see scene_add_force_term())
  * to compute the friction force on the body opposite its velocity.
  *
  * @param scene the scene containing the bodies
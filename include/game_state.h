@@ -14,6 +14,7 @@
 #include "sdl_wrapper.h"
 #include "shape.h"
 #include "state.h"
+#include "trajectory.h"
 
 typedef enum {
   SET_CUE_BALL = 1,
@@ -37,6 +38,9 @@ typedef enum {
   CUE_INFO = 10
 } info_t;
 
+// Collision types matched by ball handlers: the cue ball and every colored ball
+static const unsigned int BALL_TYPES = (1 << (BLACK_INFO + 1)) - 1;
+
 typedef struct state {
   scene_t *scene;
   scene_t *game_scene, *main_menu, *in_game_menu; // to be implemented
@@ -45,7 +49,8 @@ typedef struct state {
                      // or an alternative, related state
   body_t *cue, *cue_ball, *slider, *reset_button, *mute_button, *start_button,
       *rules_button;
-  list_t *semicircle, *table, *dotted_lines;
+  list_t *semicircle;
+  trajectory_t *trajectory; // the cue ball's path, built on the first aim
   game_flags_t flags;
   int player; // 0 and 1 for player 1 and 2
   int scores[2], foul, points,
@@ -59,6 +64,17 @@ static const char TITLE[] = "CS 3: SNOOKER!";
 static const vector_t MIN_POS = {0, 0};
 static const vector_t MAX_POS = {4000, 2000};
 
+// The fixed timestep the game's physics is ticked with, whatever the frame
+// rate. Matches SIM_DT, so the game plays shots as the simulator predicts.
+static const double PHYSICS_DT = 1.0 / 120;
+
+// The layers the game is drawn in, from the bottom up (see body_set_layer())
+static const int TABLE_LAYER = 0;
+static const int BALL_LAYER = 1;
+static const int UI_LAYER = 2;
+static const int CUE_LAYER = 3;
+static const int GUIDE_LAYER = 4;
+
 static const double G = 980;
 static const double MU = 0.35;
 static const double CUE_ELASTICITY = 0.98;
@@ -93,7 +109,9 @@ static const double CUE_MAX_SPEED = 1500;
 
 static const double LINE_WIDTH = 10;
 static const double LINE_LENGTH = 30;
-static const double MAX_COLLISIONS = 3;
+static const double LINE_SEPARATION = 140;
+static const double LINE_OFFSET = 80;
+static const size_t MAX_COLLISIONS = 3;
 static const double BALK_OFFSET = 29;
 static const double SEMICIRCLE_RADIUS = 11.5;
 static const double BLUE_OFFSET = 72;
@@ -153,10 +171,31 @@ void pocket_collision_handler(body_t *pocket, body_t *ball, vector_t axis,
                               void *aux);
 void ball_collision_handler(body_t *body1, body_t *body2, vector_t axis,
                             void *aux);
+void wall_collision_handler(body_t *wall, body_t *ball, vector_t axis,
+                            void *aux);
 void sound_handler(sound_set_t *sound_set, body_t *body1, body_t *body2);
 void apply_forces(state_t *state);
 
 void game_state_toggle_mute(state_t *state);
 
+/**
+ * Resets the turn, scores and flags of a game to those of a new frame.
+ * Does not change any of the bodies in the scene.
+ *
+ * @param state the game to reset
+ */
+void game_state_reset(state_t *state);
+
 void game_state_init(state_t *state);
+
+/**
+ * Builds the physics of a new frame: the cushions, pockets and balls with
+ * their friction and collision handlers. Nothing is drawn, no images are
+ * loaded and no audio is played, so the table can be simulated without a
+ * window. The bodies which only exist for the UI (the cue, buttons, etc.)
+ * are not created and are left NULL.
+ *
+ * @param state the game to initialize; free its scene with scene_free()
+ */
+void game_state_init_headless(state_t *state);
 #endif
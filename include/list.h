@@ -1,6 +1,7 @@
 #ifndef __LIST_H__
 #define __LIST_H__
 
+#include <stdbool.h>
 #include <stddef.h>
 
 /**
@@ -16,6 +17,27 @@ typedef struct list list_t;
  */
 typedef void (*free_func_t)(void *);
 
+/**
+ * Where memory comes from and goes back to, so a list (or anything else which
+ * takes one) can be kept somewhere other than the heap, e.g. in an arena (see
+ * arena.h) which is freed all at once.
+ */
+typedef struct {
+  /** Returns a block of at least size bytes, or NULL if there isn't one */
+  void *(*alloc)(void *context, size_t size);
+  /** Gives back a block returned by alloc, or does nothing given NULL */
+  void (*release)(void *context, void *block);
+  /** Passed to alloc and release */
+  void *context;
+} allocator_t;
+
+/**
+ * Gets the allocator which uses malloc() and free().
+ *
+ * @return the allocator
+ */
+allocator_t malloc_allocator(void);
+
 /**
  * Allocates memory for a new list with space for the given number of elements.
  * The list is initially empty.
@@ -28,6 +50,20 @@ typedef void (*free_func_t)(void *);
  */
 list_t *list_init(size_t initial_size, free_func_t freer);
 
+/**
+ * Allocates a new list like list_init(), but takes the memory for the list
+ * and its array from an allocator rather than malloc(). The elements are
+ * still the caller's, and freed by freer.
+ *
+ * @param initial_size the number of elements to allocate space for
+ * @param freer if non-NULL, a function to call on elements in the list
+ *   in list_free() when they are no longer in use
+ * @param allocator where to get the list's memory from
+ * @return a pointer to the newly allocated list
+ */
+list_t *list_init_with_allocator(size_t initial_size, free_func_t freer,
+                                 allocator_t allocator);
+
 /**
  * Releases the memory allocated for a list.
  *
@@ -64,6 +100,31 @@ void *list_get(list_t *list, int index);
  */
 void *list_remove(list_t *list, size_t index);
 
+/**
+ * Removes the element at a given index in a list and returns it, moving the
+ * last element into its place. Takes constant time, but changes the order of
+ * the list.
+ * Asserts that the index is valid, given the list's current size.
+ *
+ * @param list a pointer to a list returned from list_init()
+ * @param index an index in the list (the first element is at 0)
+ * @return the element at the given index in the list
+ */
+void *list_swap_remove(list_t *list, size_t index);
+
+/**
+ * Removes every element of a list for which keep returns false, in one pass,
+ * keeping the rest in order. Removed elements are not freed.
+ * keep is called once for each element, in order.
+ *
+ * @param list a pointer to a list returned from list_init()
+ * @param keep a function which returns whether to keep an element
+ * @param aux an auxiliary value to pass to keep
+ * @return the number of elements removed
+ */
+size_t list_filter(list_t *list, bool (*keep)(void *value, void *aux),
+                   void *aux);
+
 /**
  * Appends an element to the end of a list.
  * If the list is filled to capacity, resizes the list to fit more elements
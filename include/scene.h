@@ -1,6 +1,7 @@
 #ifndef __SCENE_H__
 #define __SCENE_H__
 
+#include "arena.h"
 #include "body.h"
 #include "list.h"
 #include "sound_set.h"
@@ -14,6 +15,54 @@
  */
 typedef struct scene scene_t;
 
+/**
+ * A reference to a body in a scene which, unlike a pointer, is safe to keep
+ * after the body is removed: once the body is freed, the handle finds
+ * nothing, even if another body has been added in its place.
+ */
+typedef struct {
+  size_t slot;
+  size_t generation;
+} body_handle_t;
+
+/**
+ * What a ray or circle cast through a scene hit first.
+ */
+typedef struct {
+  /** The body hit, or NULL if nothing was hit */
+  body_t *body;
+  /** Where the ray, or the center of the circle, was when it hit the body */
+  vector_t position;
+  /** The unit normal of the body's surface where it was hit, facing back */
+  vector_t normal;
+  /** How far the cast went before it hit the body, or INFINITY */
+  double distance;
+} raycast_hit_t;
+
+/**
+ * The shapes an overlay can be.
+ */
+typedef enum { OVERLAY_RECTANGLE, OVERLAY_CIRCLE } overlay_kind_t;
+
+/**
+ * A shape drawn over a scene which takes no part in its physics, e.g. a
+ * guide for aiming. Ticking the scene ignores its overlays.
+ */
+typedef struct {
+  overlay_kind_t kind;
+  vector_t center;
+  /**
+   * A rectangle's length along its angle and width across it, or in x, a
+   * circle's radius
+   */
+  vector_t size;
+  /** How far a rectangle is turned counterclockwise, in radians */
+  double angle;
+  rgb_color_t color;
+  /** The layer it is drawn in, after the bodies in it */
+  int layer;
+} overlay_t;
+
 /**
  * A function which adds some forces or impulses to bodies,
  * e.g. from collisions, gravity, or spring forces.
@@ -21,6 +70,50 @@ typedef struct scene scene_t;
  */
 typedef void (*force_creator_t)(void *aux);
 
+/**
+ * One instance of a typed force, e.g. the drag on one body or the spring
+ * between two, stored with every other instance of the same force.
+ */
+typedef struct {
+  body_t *body1;
+  /** The other body for a force between two bodies, otherwise NULL */
+  body_t *body2;
+  /** The force's constant, e.g. the spring constant */
+  double constant;
+} force_term_t;
+
+/**
+ * A function which applies one kind of force for each of an array of terms.
+ * The scene calls it once per tick, with every term whose bodies apply
+ * forces and aren't all asleep, so a force on many bodies takes one pass.
+ *
+ * @param terms the terms to apply the force for
+ * @param count the number of terms
+ * @param dt the length of the tick
+ */
+typedef void (*force_kernel_t)(const force_term_t *terms, size_t count,
+                               double dt);
+
+/**
+ * A function called when a collision occurs.
+ * @param body1 the first body passed to create_collision()
+ * @param body2 the second body passed to create_collision()
+ * @param axis a unit vector pointing from body1 towards body2
+ *   that defines the direction the two bodies are colliding in
+ * @param aux the auxiliary value passed to create_collision()
+ */
+typedef void (*collision_handler_t)(body_t *body1, body_t *body2, vector_t axis,
+                                    void *aux);
+
+/**
+ * A function called to create sound when a collision occurs
+ * @param sound_set set of sounds to determine sound played on collision
+ * @param body1 the first body passed to create_collision()
+ * @param body2 the second body passed to create_collision()
+ */
+typedef void (*collision_sound_handler_t)(sound_set_t *sound_set, body_t *body1,
+                                          body_t *body2);
+
 /**
  * Allocates memory for an empty scene with background audio.
  * Makes a reasonable guess of the number of bodies to allocate space for.
@@ -35,6 +128,7 @@ scene_t *scene_init_with_audio(const char *music_path);
  * Allocates memory for an empty scene.
  * Makes a reasonable guess of the number of bodies to allocate space for.
  * Asserts that the required memory is successfully allocated.
+ * The scene does not open the audio device, so it can be used headlessly.
  *
  * @return the new scene
  */
@@ -61,6 +155,17 @@ void scene_add_sound_set(scene_t *scene, const char *bb_path,
  */
 void scene_free(scene_t *scene);
 
+/**
+ * Gets the arena the scene is allocated from. Anything which lives as long
+ * as the scene, e.g. its bodies (see body_init_with_allocator()) and the
+ * auxiliary values of its forces, can be allocated from it too, and is freed
+ * with the scene in one go rather than one object at a time.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the scene's arena
+ */
+arena_t *scene_get_arena(scene_t *scene);
+
 /**
  * Gets the number of bodies in a given scene.
  *
@@ -87,6 +192,60 @@ body_t *scene_get_body(scene_t *scene, size_t index);
  */
 void scene_add_body(scene_t *scene, body_t *body);
 
+/**
+ * Gets a handle to a body in a scene.
+ * Asserts that the body is in the scene.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param body a body added with scene_add_body()
+ * @return a handle to the body
+ */
+body_handle_t scene_get_handle(scene_t *scene, body_t *body);
+
+/**
+ * Gets the body a handle refers to, in constant time.
+ *
+ * @param scene the scene the handle was got from
+ * @param handle a handle returned from scene_get_handle()
+ * @return the body, or NULL if it has been removed from the scene and freed
+ */
+body_t *scene_get_handle_body(scene_t *scene, body_handle_t handle);
+
+/**
+ * Adds an overlay to a scene, to be drawn until scene_clear_overlays().
+ * The overlay is copied, into memory kept from one set of overlays to the
+ * next, so adding one usually allocates nothing.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param overlay the overlay
+ */
+void scene_add_overlay(scene_t *scene, overlay_t overlay);
+
+/**
+ * Removes all of a scene's overlays.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ */
+void scene_clear_overlays(scene_t *scene);
+
+/**
+ * Gets the number of overlays in a scene.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the number of overlays
+ */
+size_t scene_overlays(scene_t *scene);
+
+/**
+ * Gets an overlay of a scene. The overlays are in the order they are drawn:
+ * by layer, and in the order they were added within a layer.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param index the index of the overlay
+ * @return the overlay, which is valid until the scene's overlays change
+ */
+const overlay_t *scene_get_overlay(scene_t *scene, size_t index);
+
 /**
  * @deprecated Use body_remove() instead
  *
@@ -111,6 +270,8 @@ void scene_add_force_creator(scene_t *scene, force_creator_t forcer, void *aux,
  * The auxiliary value is passed to the force creator each time it is called.
  * The force creator is registered with a list of bodies it applies to,
  * so it can be removed when any one of the bodies is removed.
+ * Forces added before their bodies are added to the scene still work, but
+ * then every removal has to check every force.
  *
  * @param scene a pointer to a scene returned from scene_init()
  * @param forcer a force creator function
@@ -124,18 +285,189 @@ void scene_add_bodies_force_creator(scene_t *scene, force_creator_t forcer,
                                     void *aux, list_t *bodies,
                                     free_func_t freer);
 
+/**
+ * Adds a term to a typed force, to be applied every time scene_tick() is
+ * called. The scene keeps the terms of each kernel together in an array, and
+ * calls the kernel once per tick for all of them, so this is faster than a
+ * force creator per body. Like a force creator's, a term is removed when one
+ * of its bodies is removed.
+ * Typed forces are applied before the force creators.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param kernel the function which applies the force
+ * @param constant the force's constant for this term
+ * @param body1 the body the force acts on
+ * @param body2 the other body for a force between two bodies, or NULL
+ */
+void scene_add_force_term(scene_t *scene, force_kernel_t kernel,
+                          double constant, body_t *body1, body_t *body2);
+
+/**
+ * Registers a function to call each time two bodies of the given types collide.
+ * Instead of checking every pair of bodies, the scene sorts the bounding boxes
+ * of bodies with a registered type (see body_set_type()) once per tick
+ * and only checks the pairs whose boxes overlap.
+ *
+ * The handler is called with a body whose type is in types1 as body1
+ * and a body whose type is in types2 as body2.
+ * Like create_collision(), it is only called once while the bodies are still
+ * colliding, and bodies with body_get_apply_forces() false are skipped.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param types1 a bitmask of body types; bit i matches bodies of type i
+ * @param types2 a bitmask of body types for the second body
+ * @param handler a function to call whenever two matching bodies collide
+ * @param sound_handler if non-NULL, a function to call with the scene's
+ *   sound_set whenever two matching bodies collide
+ * @param aux an auxiliary value to pass to handler
+ * @param freer if non-NULL, a function to call in order to free aux
+ */
+void scene_add_collision_handler(scene_t *scene, unsigned int types1,
+                                 unsigned int types2,
+                                 collision_handler_t handler,
+                                 collision_sound_handler_t sound_handler,
+                                 void *aux, free_func_t freer);
+
+/**
+ * Returns whether any collision handler applies to a pair of bodies,
+ * in either order (see scene_add_collision_handler()).
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param body1 the first body
+ * @param body2 the second body
+ * @return whether a handler would be called if the bodies collided
+ */
+bool scene_has_collision_handler(scene_t *scene, body_t *body1,
+                                 body_t *body2);
+
+/**
+ * Finds the bodies whose bounding boxes overlap a box.
+ *
+ * Queries only look at bodies whose collision type is in types, which in the
+ * game is the body's info_t (see body_set_type()). They are answered from a
+ * bounding volume hierarchy over those bodies (see aabb_tree.h), so they only
+ * look at the bodies near the query, not every body in the scene.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param box the box to look in
+ * @param types a bitmask of the collision types to look for, e.g. 1 << type
+ * @param bodies a list which each body found is added to
+ */
+void scene_query_aabb(scene_t *scene, aabb_t box, unsigned int types,
+                      list_t *bodies);
+
+/**
+ * Finds the bodies whose shapes contain a point, like scene_query_aabb().
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param point the point to look at
+ * @param types a bitmask of the collision types to look for
+ * @param bodies a list which each body found is added to
+ */
+void scene_query_point(scene_t *scene, vector_t point, unsigned int types,
+                       list_t *bodies);
+
+/**
+ * Finds the bodies whose shapes overlap a shape, like scene_query_aabb(),
+ * e.g. every ball within a circle.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param shape the shape to look in, e.g. from circle_view()
+ * @param types a bitmask of the collision types to look for
+ * @param bodies a list which each body found is added to
+ */
+void scene_query_shape(scene_t *scene, shape_view_t shape, unsigned int types,
+                       list_t *bodies);
+
+/**
+ * Finds the first body a ray hits, like scene_query_aabb().
+ * Bodies the ray starts inside are hit straight away.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param origin where the ray starts
+ * @param direction the direction of the ray
+ * @param max_distance how far to follow the ray
+ * @param types a bitmask of the collision types to look for
+ * @return the first body hit, and where
+ */
+raycast_hit_t scene_raycast(scene_t *scene, vector_t origin,
+                            vector_t direction, double max_distance,
+                            unsigned int types);
+
+/**
+ * Finds the first body a circle touches as it moves in a straight line,
+ * like scene_raycast(), e.g. the first body a ball rolling along it hits.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param origin where the center of the circle starts
+ * @param radius the radius of the circle
+ * @param direction the direction the circle moves in
+ * @param max_distance how far to move the circle
+ * @param types a bitmask of the collision types to look for
+ * @return the first body touched, and where the circle is then
+ */
+raycast_hit_t scene_circle_cast(scene_t *scene, vector_t origin,
+                                double radius, vector_t direction,
+                                double max_distance, unsigned int types);
+
 /**
  * Executes a tick of a given scene over a small time interval.
- * This requires executing all the force creators
+ * This requires executing all the force creators and collision handlers
  * and then ticking each body (see body_tick()).
  * If any bodies are marked for removal, they should be removed from the scene
  * and freed, along with any force creators acting on them.
+ * The bodies are all removed together at the end of the tick, keeping the
+ * order of the rest, and only the forces on them are looked at, so removing
+ * k bodies costs O(k + the forces on them) on top of the tick itself.
+ *
+ * If two bodies with a collision handler would start to collide partway
+ * through the tick (see find_time_of_impact()), the tick is split in two at
+ * that moment, so their handler is called before they can pass through each
+ * other. A tick is split at most 8 times.
+ * A tick with dt 0 runs the force creators and collision handlers and applies
+ * any impulses they give, without moving anything.
+ *
+ * A body with a collision type which ends a tick at rest (see
+ * body_is_resting()) falls asleep, and is skipped by its forces, the
+ * collision checks and body_tick() until something wakes it. Bodies touching
+ * each other only fall asleep together: waking one wakes every body touching
+ * it, and so on.
+ *
+ * Only bodies whose bounding boxes are near each other are checked for
+ * collisions. They are found from a bounding volume hierarchy (see
+ * aabb_tree.h) which keeps bodies of infinite mass that have never moved
+ * apart from the rest, so walls are never checked against each other.
  *
  * @param scene a pointer to a scene returned from scene_init()
  * @param dt the time elapsed since the last tick, in seconds
  */
 void scene_tick(scene_t *scene, double dt);
 
+/**
+ * Advances a scene by the wall-clock duration of one frame in ticks of a
+ * fixed size, so the physics behaves the same at every frame rate.
+ * Time left over that is shorter than dt is carried into the next call.
+ * Frames longer than a quarter of a second only advance the scene by a
+ * quarter of a second, so a stall doesn't cause a burst of catch-up ticks.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param frame_time the wall-clock time since the last frame, in seconds
+ * @param dt the fixed timestep to pass to scene_tick()
+ * @return the number of times scene_tick() was called, which may be 0
+ */
+size_t scene_advance(scene_t *scene, double frame_time, double dt);
+
+/**
+ * Gets how far the scene is between its last tick and its next one, as the
+ * fraction of a tick left over by scene_advance(). Passing this to
+ * sdl_render_scene() draws bodies between their last two positions,
+ * so motion looks smooth even when the frame rate and tick rate differ.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return a value in [0, 1), or 1 if scene_advance() has never been called
+ */
+double scene_get_alpha(scene_t *scene);
+
 /**
  * @brief Get the time object
  *
@@ -152,12 +484,23 @@ double scene_get_time(scene_t *scene);
 void scene_reset_time(scene_t *scene);
 
 /**
- * @brief gets the index of a given body in the scene
+ * Gets the timestep of the tick in progress, or of the last tick if called
+ * between ticks. Force creators can use this to avoid overshooting.
+ * When scene_tick() splits a tick at an impact, this is the length of the
+ * part of the tick in progress.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the timestep of the most recent tick, or 0 before any tick
+ */
+double scene_get_dt(scene_t *scene);
+
+/**
+ * @brief gets the index of a given body in the scene, in constant time
  *
  * @param scene a pointer to a scene returned from scene_init()
  * @param body a pointer to a body
  *
- * @returns the index of the body in the scene
+ * @returns the index of the body in the scene, or -1 if it isn't in it
  */
 int scene_get_index(scene_t *scene, body_t *body);
 
@@ -171,7 +514,14 @@ int scene_get_index(scene_t *scene, body_t *body);
 sound_set_t *scene_get_sound_set(scene_t *scene);
 
 /**
- * @brief retruns true if all bodies in the scene have 0 velocity
+ * Returns whether every body in the scene is asleep (see body_sleep()) or at
+ * rest, i.e. whether the scene has come to rest.
+ * Bodies with collision types fall asleep once they are at rest; others just
+ * stop. A body given a velocity, force or impulse since the last tick counts
+ * as moving. Takes constant time.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return whether no body in the scene is moving
  */
 bool scene_is_still(scene_t *scene);
 
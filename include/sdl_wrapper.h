@@ -113,10 +113,43 @@ void sdl_draw_polygon(body_t *body);
 void sdl_show(void);
 
 /**
- * Loads an image as an SDL_Texture.
- * Returns an SDL_Texture.
+ * Loads an image as a sprite.
+ * Each file is only decoded once while it is loaded: loading it again gives
+ * the same sprite and adds a reference to it, which the caller must drop
+ * with sdl_release_image(), e.g. by giving the sprite to a body.
+ *
+ * @param image_path the path of the image file
+ * @return the sprite, or NULL if sdl_init() has not been called or the
+ *   image could not be loaded
+ */
+sprite_t *sdl_load_image(char *image_path);
+
+/**
+ * Loads images into one texture, an atlas, so bodies showing any of them can
+ * be drawn together. sdl_load_image() then gives out the images from the
+ * atlas. Images already loaded are skipped, and images which don't fit are
+ * left to be loaded separately.
+ *
+ * @param image_paths the paths of the image files
+ * @param count the number of paths
  */
-SDL_Texture *sdl_load_image(char *image_path);
+void sdl_pack_images(const char *image_paths[], size_t count);
+
+/**
+ * Drops a reference to a sprite from sdl_load_image().
+ * A sprite nothing holds stays loaded, so it can be given out again without
+ * decoding the file, until sdl_release_unused_images() is called.
+ *
+ * @param image the sprite, or NULL to do nothing
+ */
+void sdl_release_image(sprite_t *image);
+
+/**
+ * Destroys the loaded sprites nothing holds, e.g. once a new scene has
+ * loaded the images it shows. An atlas is kept whole while any of its
+ * sprites are held.
+ */
+void sdl_release_unused_images(void);
 
 // /**
 //  * Rotates an SDL_texture.
@@ -124,13 +157,35 @@ SDL_Texture *sdl_load_image(char *image_path);
 // void sdl_rotate_image(body_t *curr, double angle);
 
 /**
- * Draws all bodies in a scene.
+ * Draws all bodies and overlays in a scene.
  * This internally calls sdl_clear(), sdl_draw_polygon(), and sdl_show(),
  * so those functions should not be called directly.
+ * The window's size and scale are looked up once per frame, and drawing the
+ * bodies allocates nothing once the first frames have been drawn.
+ * Consecutive sprites from the same texture are drawn by one
+ * SDL_RenderGeometry() call, and a run of bodies with shadows in the same
+ * layer has all the shadows drawn under all the bodies.
+ * Bodies are drawn from the lowest layer (see body_set_layer()) up, in the
+ * order they were added within a layer, and each overlay (see
+ * scene_add_overlay()) is drawn over the bodies in its layer and below it.
+ * Background bodies (see body_set_background()) are drawn behind the rest,
+ * from a texture they are drawn into only when they or the window's size
+ * change.
+ * Each body is drawn between where it was before its last tick and where it
+ * is now (see body_get_interpolated_centroid()).
  *
  * @param scene the scene to draw
+ * @param alpha how far between ticks to draw the bodies, e.g.
+ *   scene_get_alpha(), or 1 to draw them where they are
+ */
+void sdl_render_scene(scene_t *scene, double alpha);
+
+/**
+ * Marks the background as changed, so sdl_render_scene() draws the
+ * background bodies again. Call this after changing a background body (see
+ * body_set_background()) or before drawing a different scene.
  */
-void sdl_render_scene(scene_t *scene);
+void sdl_invalidate_background(void);
 
 /**
  * Registers a function to be called every time a key is pressed.
@@ -171,8 +226,9 @@ void sdl_on_key(key_handler_t handler);
 void sdl_on_click(mouse_handler_t handler);
 
 /**
- * Gets the amount of time that has passed since the last time
- * this function was called, in seconds.
+ * Gets the amount of wall-clock time that has passed since the last time
+ * this function was called, in seconds. Uses a monotonic clock, so it is
+ * unaffected by changes to the system time.
  *
  * @return the number of seconds that have elapsed
  */
@@ -4,6 +4,7 @@
 #include "color.h"
 #include "list.h"
 #include "vector.h"
+#include "vertices.h"
 #include <stddef.h>
 #include <stdlib.h>
 
@@ -28,4 +29,19 @@ list_t *draw_quadrilateral(vector_t p1, vector_t p2, vector_t p3, vector_t p4);
 
 list_t *draw_triangle(vector_t p_1, vector_t p_2, vector_t p_3);
 
+// Packed versions of the shapes above, for use with body_init_with_vertices().
+// These build the same vertices without allocating a vector for each one.
+
+vertices_t *draw_circle_vertices(vector_t *centroid, double radius);
+
+vertices_t *draw_ellipse_vertices(vector_t *centroid, double major,
+                                  double minor);
+
+vertices_t *draw_rectangle_vertices(vector_t *centroid, double x, double y);
+
+vertices_t *draw_quadrilateral_vertices(vector_t p1, vector_t p2, vector_t p3,
+                                        vector_t p4);
+
+vertices_t *draw_triangle_vertices(vector_t p_1, vector_t p_2, vector_t p_3);
+
 #endif
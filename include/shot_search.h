@@ -0,0 +1,78 @@
+#ifndef __SHOT_SEARCH_H__
+#define __SHOT_SEARCH_H__
+
+#include "simulator.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Searches for a good shot by sampling random angles and powers around an
+ * aimed shot and playing each one on the headless simulator.
+ *
+ * Every candidate is played on its own table, so candidates are spread over
+ * a pool of worker threads. Each worker takes candidates from its own queue
+ * and, when that runs dry, steals half of the remaining candidates of
+ * another worker. The candidates are sampled before any are played, so the
+ * result only depends on the seed, not on the number of threads.
+ */
+
+/**
+ * The shots to consider: cue angles uniformly within angle_spread of angle,
+ * and cue speeds uniformly within speed_spread of speed (clamped to
+ * [0, CUE_MAX_SPEED]), all from the same cue ball position.
+ */
+typedef struct search_params {
+  vector_t cue_ball;
+  double angle, angle_spread;
+  double speed, speed_spread;
+  int ball_on;    // see shot_t
+  size_t samples; // the number of candidate shots to play
+  size_t threads; // the number of threads to use, or 0 for one per core
+  uint64_t seed;  // the same seed always samples the same candidates
+  double dt;      // the timestep to simulate with, e.g. SIM_DT, or 0 to jump
+                  // between events (see simulate_shot_events())
+} search_params_t;
+
+/**
+ * A shot that was considered, and how it went.
+ */
+typedef struct candidate {
+  size_t index; // the order the candidate was sampled in
+  double angle, speed;
+  shot_t shot;
+  shot_result_t result;
+  double score;
+} candidate_t;
+
+/**
+ * Gets the default search around an aimed shot from the cue ball's starting
+ * position, with a red on.
+ *
+ * @param angle the aimed direction, in radians
+ * @param speed the aimed cue speed
+ * @return parameters to pass to shot_search()
+ */
+search_params_t search_params_init(double angle, double speed);
+
+/**
+ * Scores the outcome of a shot for the player taking it: the points scored,
+ * less the points given away by a foul.
+ * Shots which never came to rest are scored below every other shot.
+ *
+ * @param result the outcome of a shot
+ * @return the score of the shot
+ */
+double shot_score(shot_result_t *result);
+
+/**
+ * Samples and plays params.samples shots and ranks them.
+ * Asserts that at least one shot is sampled.
+ *
+ * @param params the shots to consider
+ * @return a newly allocated array of params.samples candidates, sorted from
+ *   best to worst score (ties are kept in the order they were sampled),
+ *   which must be free()d
+ */
+candidate_t *shot_search(search_params_t params);
+
+#endif // #ifndef __SHOT_SEARCH_H__
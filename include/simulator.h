@@ -0,0 +1,88 @@
+#ifndef __SIMULATOR_H__
+#define __SIMULATOR_H__
+
+#include "game_state.h"
+#include "vector.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Plays shots on a headless table, built by game_state_init_headless().
+ * Nothing is rendered and the physics is stepped at a fixed timestep
+ * instead of the wall clock, so shots can be evaluated offline as fast as
+ * the CPU allows, and the same shot always has the same result.
+ */
+
+// The number of balls on a new table: 15 reds, 6 colors and the cue ball
+#define NUM_BALLS 22
+
+// The timestep shots are simulated with, unless another is given
+static const double SIM_DT = 1.0 / 120;
+// The most ticks a shot is simulated for before giving up on it stopping
+static const size_t SIM_MAX_TICKS = 120 * 120;
+
+/**
+ * A shot: where the cue ball is placed, the impulse the cue gives it, and
+ * which ball is on, i.e. must be hit first (see state_t's ball_on).
+ */
+typedef struct shot {
+  vector_t cue_ball;
+  vector_t impulse;
+  int ball_on;
+} shot_t;
+
+/**
+ * What happened to one ball during a shot.
+ */
+typedef struct ball_result {
+  info_t info;
+  vector_t position; // where the ball stopped, or where it was potted
+  bool potted;
+} ball_result_t;
+
+/**
+ * The outcome of a shot. The balls are listed in the order they are added to
+ * the scene: the reds, then the colors from yellow to black, then the cue
+ * ball. The points and foul are scored as in the game, while every ball is
+ * still on the table.
+ */
+typedef struct shot_result {
+  ball_result_t balls[NUM_BALLS];
+  size_t pots;
+  int points; // points scored by the shot, or 0
+  int foul;   // points awarded to the opponent, or 0 if the shot is fair
+  size_t ticks; // the ticks, or events for simulate_shot_events(), played
+  bool settled; // false if the balls were still moving after SIM_MAX_TICKS
+} shot_result_t;
+
+/**
+ * Plays a shot on a new table until every ball stops moving.
+ *
+ * @param shot the shot to play
+ * @param dt the timestep to simulate with, e.g. SIM_DT
+ * @param result where to store the outcome of the shot
+ */
+void simulate_shot(shot_t shot, double dt, shot_result_t *result);
+
+/**
+ * Plays a shot on a new table like simulate_shot(), but jumps from one event
+ * to the next (see event_solver.h) instead of ticking at a fixed timestep.
+ * This is exact up to the accuracy of the friction model, and plays a shot
+ * with a few hundred events rather than thousands of ticks.
+ *
+ * @param shot the shot to play
+ * @param result where to store the outcome of the shot
+ */
+void simulate_shot_events(shot_t shot, shot_result_t *result);
+
+/**
+ * Gets the shot of a given power and direction from the cue ball's starting
+ * position, as if it were struck by the cue, with a red on.
+ *
+ * @param angle the direction to hit the cue ball in, in radians
+ * @param speed the speed to give the cue ball
+ * @return the shot
+ */
+shot_t shot_init(double angle, double speed);
+
+#endif // #ifndef __SIMULATOR_H__
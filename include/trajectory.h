@@ -0,0 +1,99 @@
+#ifndef __TRAJECTORY_H__
+#define __TRAJECTORY_H__
+
+#include "collision.h"
+#include "vector.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Predicts the path of an aimed ball, for drawing it before the shot.
+ *
+ * The ball travels in straight lines, so instead of being stepped along, it
+ * is cast as a ray against the cushions it bounces off, the pockets which
+ * stop it, and the other balls, which stop it too. Cushions and pockets never
+ * move, so their edges are copied once when they are added. The balls are
+ * given again before each prediction, but as long as neither they nor the
+ * ball's starting point have moved, everything worked out from them is kept.
+ * In particular, each obstacle's distance and the range of angles it covers
+ * as seen from the starting point are sorted once, so while only the aim
+ * changes, the first leg of the path only tests obstacles in its direction,
+ * nearest first.
+ */
+typedef struct trajectory trajectory_t;
+
+/**
+ * Allocates a predictor with no obstacles.
+ *
+ * @param radius the radius of the ball whose path is predicted
+ * @param elasticity the ball's coefficient of restitution with the cushions,
+ *   which makes it bounce off them at a shallower angle
+ * @return a pointer to the new predictor
+ */
+trajectory_t *trajectory_init(double radius, double elasticity);
+
+/**
+ * Releases the memory allocated for a predictor.
+ *
+ * @param trajectory a pointer to a predictor returned from trajectory_init()
+ */
+void trajectory_free(trajectory_t *trajectory);
+
+/**
+ * Adds a cushion, a convex polygon which never moves, to a predictor.
+ * The ball bounces off it.
+ *
+ * @param trajectory a pointer to a predictor returned from trajectory_init()
+ * @param shape the cushion's shape, which is copied
+ */
+void trajectory_add_cushion(trajectory_t *trajectory, shape_view_t shape);
+
+/**
+ * Adds a pocket, a convex polygon which never moves, to a predictor.
+ * The ball's path ends where it touches it.
+ *
+ * @param trajectory a pointer to a predictor returned from trajectory_init()
+ * @param shape the pocket's shape, which is copied
+ */
+void trajectory_add_pocket(trajectory_t *trajectory, shape_view_t shape);
+
+/**
+ * Starts giving the predictor the other balls on the table, which are then
+ * added in turn with trajectory_add_ball(). If they are given in the same
+ * order as last time and none has moved, nothing is worked out again.
+ *
+ * @param trajectory a pointer to a predictor returned from trajectory_init()
+ * @param origin where the ball whose path is predicted starts
+ */
+void trajectory_set_balls(trajectory_t *trajectory, vector_t origin);
+
+/**
+ * Adds a ball after trajectory_set_balls(). The ball's path ends where it
+ * touches it.
+ *
+ * @param trajectory a pointer to a predictor returned from trajectory_init()
+ * @param center the center of the ball
+ * @param radius the radius of the ball
+ */
+void trajectory_add_ball(trajectory_t *trajectory, vector_t center,
+                         double radius);
+
+/**
+ * Predicts the path of the ball when it is sent off in a direction from the
+ * origin given to trajectory_set_balls(). The path ends where the ball first
+ * touches a pocket or another ball, or where it touches a cushion after
+ * bouncing max_bounces times, whichever comes first.
+ *
+ * @param trajectory a pointer to a predictor returned from trajectory_init()
+ * @param direction the direction the ball is sent off in
+ * @param max_bounces the most times the ball may bounce off cushions
+ * @param path an array of at least max_bounces + 2 points, which is filled
+ *   with the origin, where the ball is at each bounce, and where the path
+ *   ends, in order
+ * @return the number of points written to path. If the ball would never
+ *   touch anything, the last point is the last bounce.
+ */
+size_t trajectory_predict(trajectory_t *trajectory, vector_t direction,
+                          size_t max_bounces, vector_t *path);
+
+#endif // #ifndef __TRAJECTORY_H__
@@ -2,6 +2,7 @@
 #define __VECTOR_H__
 
 #include <stdbool.h>
+#include <stddef.h>
 
 /**
  * A real-valued 2-dimensional vector.
@@ -166,4 +167,58 @@ void vec_print(vector_t v);
  */
 void vector_multiply_2(double magnitude, vector_t v);
 
+/*
+ * Batch operations on n points whose coordinates are packed into two arrays,
+ * x and y, as in vertices.h. On x86-64 they use SSE2, or AVX2 when the
+ * processor running the program has it, and elsewhere (e.g. WebAssembly) a
+ * plain loop. Every version gives exactly the same results.
+ */
+
+/**
+ * Translates points by a vector.
+ *
+ * @param x the points' x coordinates
+ * @param y the points' y coordinates
+ * @param n the number of points
+ * @param translation the vector to add to each point
+ */
+void vec_translate_all(double *x, double *y, size_t n, vector_t translation);
+
+/**
+ * Rotates points about another point, by an angle given by its cosine and
+ * sine, so they can be computed once for any number of points.
+ *
+ * @param x the points' x coordinates
+ * @param y the points' y coordinates
+ * @param n the number of points
+ * @param cos_angle the cosine of the angle to rotate counterclockwise by
+ * @param sin_angle the sine of the angle
+ * @param point the point to rotate about
+ */
+void vec_rotate_all(double *x, double *y, size_t n, double cos_angle,
+                    double sin_angle, vector_t point);
+
+/**
+ * Projects points onto an axis, i.e. takes the dot product of each with it.
+ *
+ * @param x the points' x coordinates
+ * @param y the points' y coordinates
+ * @param n the number of points, at least 1
+ * @param axis the vector to project onto
+ * @return the smallest projection as x, and the largest as y
+ */
+vector_t vec_project_all(const double *x, const double *y, size_t n,
+                         vector_t axis);
+
+/**
+ * Computes the magnitude of each of a number of vectors.
+ *
+ * @param x the vectors' x components
+ * @param y the vectors' y components
+ * @param n the number of vectors
+ * @param magnitudes where to store the n magnitudes
+ */
+void vec_magnitude_all(const double *x, const double *y, size_t n,
+                       double *magnitudes);
+
 #endif // #ifndef __VECTOR_H__
@@ -0,0 +1,194 @@
+#ifndef __VERTICES_H__
+#define __VERTICES_H__
+
+#include "list.h"
+#include "vector.h"
+#include <stddef.h>
+
+/**
+ * A growable polygon whose vertices are packed into two contiguous arrays,
+ * one of x coordinates and one of y coordinates.
+ * Unlike a list of vector_t pointers, operating on every vertex is a linear
+ * sweep over memory, which is what the physics does every tick.
+ *
+ * As with the list-based polygon functions, the vertices are listed in
+ * counterclockwise order, and there is an edge between each pair of
+ * consecutive vertices, plus one between the first and last.
+ */
+typedef struct vertices vertices_t;
+
+/**
+ * Allocates memory for a new polygon with space for the given number of
+ * vertices. The polygon initially has no vertices.
+ * Asserts that the required memory was allocated.
+ *
+ * @param initial_size the number of vertices to allocate space for
+ * @return a pointer to the newly allocated polygon
+ */
+vertices_t *vertices_init(size_t initial_size);
+
+/**
+ * Allocates a new polygon like vertices_init(), but takes its memory from an
+ * allocator rather than malloc().
+ *
+ * @param initial_size the number of vertices to allocate space for
+ * @param allocator where to get the polygon's memory from
+ * @return a pointer to the newly allocated polygon
+ */
+vertices_t *vertices_init_with_allocator(size_t initial_size,
+                                         allocator_t allocator);
+
+/**
+ * Allocates a packed copy of a list of vertices.
+ * The list is not modified or freed.
+ *
+ * @param shape a list of vector_t pointers
+ * @return a pointer to the newly allocated polygon
+ */
+vertices_t *vertices_from_list(list_t *shape);
+
+/**
+ * Copies a polygon's vertices into a newly allocated list of vectors,
+ * which must be list_free()d.
+ *
+ * @param vertices a pointer to a polygon returned from vertices_init()
+ * @return a list of newly allocated vector_t pointers
+ */
+list_t *vertices_to_list(vertices_t *vertices);
+
+/**
+ * Allocates a copy of a polygon.
+ *
+ * @param vertices a pointer to a polygon returned from vertices_init()
+ * @return a pointer to the newly allocated copy
+ */
+vertices_t *vertices_copy(vertices_t *vertices);
+
+/**
+ * Releases the memory allocated for a polygon.
+ *
+ * @param vertices a pointer to a polygon returned from vertices_init()
+ */
+void vertices_free(vertices_t *vertices);
+
+/**
+ * Gets the number of vertices in a polygon.
+ *
+ * @param vertices a pointer to a polygon returned from vertices_init()
+ * @return the number of vertices
+ */
+size_t vertices_size(vertices_t *vertices);
+
+/**
+ * Gets the vertex at a given index in a polygon.
+ * Asserts that the index is valid.
+ *
+ * @param vertices a pointer to a polygon returned from vertices_init()
+ * @param index an index in the polygon (the first vertex is at 0)
+ * @return the vertex at the given index
+ */
+vector_t vertices_get(vertices_t *vertices, size_t index);
+
+/**
+ * Appends a vertex to the end of a polygon, growing it if needed.
+ *
+ * @param vertices a pointer to a polygon returned from vertices_init()
+ * @param vertex the vertex to add
+ */
+void vertices_add(vertices_t *vertices, vector_t vertex);
+
+/**
+ * Gets the packed x coordinates of a polygon.
+ * The array is owned by the polygon and is invalidated by vertices_add().
+ *
+ * @param vertices a pointer to a polygon returned from vertices_init()
+ * @return an array of vertices_size() x coordinates
+ */
+const double *vertices_x(vertices_t *vertices);
+
+/**
+ * Gets the packed y coordinates of a polygon.
+ * The array is owned by the polygon and is invalidated by vertices_add().
+ *
+ * @param vertices a pointer to a polygon returned from vertices_init()
+ * @return an array of vertices_size() y coordinates
+ */
+const double *vertices_y(vertices_t *vertices);
+
+/**
+ * Computes the unit normal of each edge of a polygon, replacing the contents
+ * of normals. Normal i is perpendicular to the edge from vertex i to
+ * vertex i + 1 (or to vertex 0, for the last vertex).
+ *
+ * @param vertices a pointer to a polygon returned from vertices_init()
+ * @param normals a pointer to a polygon to store the normals in, as vectors
+ */
+void vertices_normals(vertices_t *vertices, vertices_t *normals);
+
+/**
+ * Computes the area of a polygon. See polygon_area().
+ *
+ * @param vertices a pointer to a polygon returned from vertices_init()
+ * @return the area of the polygon
+ */
+double vertices_area(vertices_t *vertices);
+
+/**
+ * Computes the center of mass of a polygon. See polygon_centroid().
+ *
+ * @param vertices a pointer to a polygon returned from vertices_init()
+ * @return the centroid of the polygon
+ */
+vector_t vertices_centroid(vertices_t *vertices);
+
+/**
+ * Computes the average of a polygon's vertices. See polygon_center().
+ *
+ * @param vertices a pointer to a polygon returned from vertices_init()
+ * @return the center of the polygon
+ */
+vector_t vertices_center(vertices_t *vertices);
+
+/**
+ * Translates all vertices in a polygon by a given vector.
+ *
+ * @param vertices a pointer to a polygon returned from vertices_init()
+ * @param translation the vector to add to each vertex's position
+ */
+void vertices_translate(vertices_t *vertices, vector_t translation);
+
+/**
+ * Rotates all vertices in a polygon by a given angle about a given point.
+ *
+ * @param vertices a pointer to a polygon returned from vertices_init()
+ * @param angle the angle to rotate the polygon, in radians.
+ * A positive angle means counterclockwise.
+ * @param point the point to rotate around
+ */
+void vertices_rotate(vertices_t *vertices, double angle, vector_t point);
+
+/**
+ * Multiplies the x coordinate of every vertex in a polygon by a factor.
+ *
+ * @param vertices a pointer to a polygon returned from vertices_init()
+ * @param factor amount to stretch each vertex by
+ */
+void vertices_stretch_x(vertices_t *vertices, double factor);
+
+/**
+ * Reflects a polygon across the vertical line x = x0.
+ *
+ * @param vertices a pointer to a polygon returned from vertices_init()
+ * @param x0 the x coordinate of the line to reflect across
+ */
+void vertices_reflect_x(vertices_t *vertices, double x0);
+
+/**
+ * Reflects a polygon across the horizontal line y = y0.
+ *
+ * @param vertices a pointer to a polygon returned from vertices_init()
+ * @param y0 the y coordinate of the line to reflect across
+ */
+void vertices_reflect_y(vertices_t *vertices, double y0);
+
+#endif // #ifndef __VERTICES_H__
@@ -0,0 +1,380 @@
+#include "aabb_tree.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+const size_t INITIAL_NODES = 16;
+
+// A leaf has no children, and a free node is on the free list, linked through
+// its parent, with a height of -1
+typedef struct {
+  aabb_t box;
+  void *data;
+  size_t parent, child1, child2;
+  int height;
+} tree_node_t;
+
+typedef struct aabb_tree {
+  double margin;
+  tree_node_t *nodes;
+  size_t capacity;
+  size_t root, free_list;
+  size_t leaf_count;
+  // The nodes left to visit by a query, kept between queries
+  size_t *stack;
+  size_t stack_capacity;
+} aabb_tree_t;
+
+aabb_tree_t *aabb_tree_init(double margin) {
+  aabb_tree_t *tree = malloc(sizeof(aabb_tree_t));
+  assert(tree != NULL);
+  tree->margin = margin;
+  tree->nodes = NULL;
+  tree->capacity = 0;
+  tree->root = AABB_TREE_NONE;
+  tree->free_list = AABB_TREE_NONE;
+  tree->leaf_count = 0;
+  tree->stack = malloc(INITIAL_NODES * sizeof(size_t));
+  assert(tree->stack != NULL);
+  tree->stack_capacity = INITIAL_NODES;
+  return tree;
+}
+
+void aabb_tree_free(aabb_tree_t *tree) {
+  free(tree->nodes);
+  free(tree->stack);
+  free(tree);
+}
+
+aabb_t aabb_union(aabb_t box1, aabb_t box2) {
+  return (aabb_t){{fmin(box1.min.x, box2.min.x), fmin(box1.min.y, box2.min.y)},
+                  {fmax(box1.max.x, box2.max.x), fmax(box1.max.y, box2.max.y)}};
+}
+
+// The cost of a box to the tree: how likely a query is to touch it
+double aabb_perimeter(aabb_t box) {
+  return 2 * (box.max.x - box.min.x + box.max.y - box.min.y);
+}
+
+bool aabb_contains(aabb_t outer, aabb_t inner) {
+  return inner.min.x >= outer.min.x && inner.min.y >= outer.min.y &&
+         inner.max.x <= outer.max.x && inner.max.y <= outer.max.y;
+}
+
+// Grows a leaf's box by the tree's margin and stretches it along the
+// displacement expected before the leaf next moves
+aabb_t fatten_box(aabb_tree_t *tree, aabb_t box, vector_t displacement) {
+  double size = fmax(box.max.x - box.min.x, box.max.y - box.min.y);
+  vector_t margin = {tree->margin * size, tree->margin * size};
+  box.min = vec_subtract(box.min, margin);
+  box.max = vec_add(box.max, margin);
+  box.min.x += fmin(displacement.x, 0);
+  box.min.y += fmin(displacement.y, 0);
+  box.max.x += fmax(displacement.x, 0);
+  box.max.y += fmax(displacement.y, 0);
+  return box;
+}
+
+bool is_leaf(tree_node_t *node) { return node->child1 == AABB_TREE_NONE; }
+
+size_t allocate_node(aabb_tree_t *tree) {
+  if (tree->free_list == AABB_TREE_NONE) {
+    size_t old_capacity = tree->capacity;
+    tree->capacity = old_capacity ? 2 * old_capacity : INITIAL_NODES;
+    tree->nodes = realloc(tree->nodes, tree->capacity * sizeof(tree_node_t));
+    assert(tree->nodes != NULL);
+    for (size_t i = tree->capacity; i > old_capacity; i--) {
+      tree->nodes[i - 1].parent = tree->free_list;
+      tree->nodes[i - 1].height = -1;
+      tree->free_list = i - 1;
+    }
+  }
+  size_t index = tree->free_list;
+  tree_node_t *node = &tree->nodes[index];
+  tree->free_list = node->parent;
+  node->parent = AABB_TREE_NONE;
+  node->child1 = AABB_TREE_NONE;
+  node->child2 = AABB_TREE_NONE;
+  node->data = NULL;
+  node->height = 0;
+  return index;
+}
+
+void free_node(aabb_tree_t *tree, size_t index) {
+  tree->nodes[index].parent = tree->free_list;
+  tree->nodes[index].height = -1;
+  tree->free_list = index;
+}
+
+// Recomputes a node's box and height from its children
+void refit_node(aabb_tree_t *tree, size_t index) {
+  tree_node_t *node = &tree->nodes[index];
+  tree_node_t *child1 = &tree->nodes[node->child1];
+  tree_node_t *child2 = &tree->nodes[node->child2];
+  node->box = aabb_union(child1->box, child2->box);
+  node->height = 1 + (child1->height > child2->height ? child1->height
+                                                      : child2->height);
+}
+
+// Puts new_child where old_child was under parent, or at the root
+void replace_child(aabb_tree_t *tree, size_t parent, size_t old_child,
+                   size_t new_child) {
+  if (parent == AABB_TREE_NONE) {
+    tree->root = new_child;
+  } else if (tree->nodes[parent].child1 == old_child) {
+    tree->nodes[parent].child1 = new_child;
+  } else {
+    tree->nodes[parent].child2 = new_child;
+  }
+}
+
+// Lifts a node's child up in its place. The child's taller child stays
+// with it, and its shorter child moves down under the node.
+// Returns the child, which is now the root of the subtree.
+size_t rotate_up(aabb_tree_t *tree, size_t index, size_t child) {
+  tree_node_t *nodes = tree->nodes;
+  size_t grandchild1 = nodes[child].child1;
+  size_t grandchild2 = nodes[child].child2;
+  size_t keep = nodes[grandchild1].height > nodes[grandchild2].height
+                    ? grandchild1
+                    : grandchild2;
+  size_t move = keep == grandchild1 ? grandchild2 : grandchild1;
+
+  nodes[child].parent = nodes[index].parent;
+  replace_child(tree, nodes[child].parent, index, child);
+  nodes[child].child1 = index;
+  nodes[child].child2 = keep;
+  nodes[index].parent = child;
+  if (nodes[index].child1 == child) {
+    nodes[index].child1 = move;
+  } else {
+    nodes[index].child2 = move;
+  }
+  nodes[move].parent = index;
+  refit_node(tree, index);
+  refit_node(tree, child);
+  return child;
+}
+
+// Rotates a node's taller child up if it is more than one level taller than
+// the other, and returns the node now at the root of the subtree
+size_t balance_node(aabb_tree_t *tree, size_t index) {
+  tree_node_t *node = &tree->nodes[index];
+  if (is_leaf(node) || node->height < 2) {
+    return index;
+  }
+  int balance =
+      tree->nodes[node->child2].height - tree->nodes[node->child1].height;
+  if (balance > 1) {
+    return rotate_up(tree, index, node->child2);
+  }
+  if (balance < -1) {
+    return rotate_up(tree, index, node->child1);
+  }
+  return index;
+}
+
+// Refits and rebalances each node from index up to the root
+void refit_ancestors(aabb_tree_t *tree, size_t index) {
+  while (index != AABB_TREE_NONE) {
+    index = balance_node(tree, index);
+    refit_node(tree, index);
+    index = tree->nodes[index].parent;
+  }
+}
+
+// Finds the node which grows the tree's total perimeter the least when a box
+// is put next to it, descending while a child would be cheaper than its parent
+size_t find_sibling(aabb_tree_t *tree, aabb_t box) {
+  size_t index = tree->root;
+  while (!is_leaf(&tree->nodes[index])) {
+    tree_node_t *node = &tree->nodes[index];
+    double perimeter = aabb_perimeter(node->box);
+    double combined = aabb_perimeter(aabb_union(node->box, box));
+    // Pairing with this node makes a new parent around both
+    double cost = 2 * combined;
+    // Going further down grows this node and every node above it
+    double inherited = 2 * (combined - perimeter);
+    double child_costs[2];
+    size_t children[2] = {node->child1, node->child2};
+    for (size_t i = 0; i < 2; i++) {
+      tree_node_t *child = &tree->nodes[children[i]];
+      double grown = aabb_perimeter(aabb_union(child->box, box));
+      child_costs[i] = inherited + (is_leaf(child)
+                                        ? grown
+                                        : grown - aabb_perimeter(child->box));
+    }
+    if (cost < child_costs[0] && cost < child_costs[1]) {
+      break;
+    }
+    index = child_costs[0] < child_costs[1] ? children[0] : children[1];
+  }
+  return index;
+}
+
+void insert_leaf(aabb_tree_t *tree, size_t leaf) {
+  if (tree->root == AABB_TREE_NONE) {
+    tree->root = leaf;
+    tree->nodes[leaf].parent = AABB_TREE_NONE;
+    return;
+  }
+  size_t sibling = find_sibling(tree, tree->nodes[leaf].box);
+  size_t parent = allocate_node(tree);
+  tree_node_t *nodes = tree->nodes;
+  nodes[parent].parent = nodes[sibling].parent;
+  replace_child(tree, nodes[parent].parent, sibling, parent);
+  nodes[parent].child1 = sibling;
+  nodes[parent].child2 = leaf;
+  nodes[sibling].parent = parent;
+  nodes[leaf].parent = parent;
+  refit_ancestors(tree, parent);
+}
+
+void detach_leaf(aabb_tree_t *tree, size_t leaf) {
+  tree_node_t *nodes = tree->nodes;
+  if (leaf == tree->root) {
+    tree->root = AABB_TREE_NONE;
+    return;
+  }
+  size_t parent = nodes[leaf].parent;
+  size_t grandparent = nodes[parent].parent;
+  size_t sibling = nodes[parent].child1 == leaf ? nodes[parent].child2
+                                                : nodes[parent].child1;
+  replace_child(tree, grandparent, parent, sibling);
+  nodes[sibling].parent = grandparent;
+  free_node(tree, parent);
+  refit_ancestors(tree, grandparent);
+}
+
+size_t aabb_tree_insert(aabb_tree_t *tree, aabb_t box, void *data) {
+  size_t leaf = allocate_node(tree);
+  tree->nodes[leaf].box = fatten_box(tree, box, VEC_ZERO);
+  tree->nodes[leaf].data = data;
+  insert_leaf(tree, leaf);
+  tree->leaf_count++;
+  return leaf;
+}
+
+void aabb_tree_remove(aabb_tree_t *tree, size_t leaf) {
+  assert(leaf < tree->capacity && is_leaf(&tree->nodes[leaf]) &&
+         tree->nodes[leaf].height == 0);
+  detach_leaf(tree, leaf);
+  free_node(tree, leaf);
+  tree->leaf_count--;
+}
+
+bool aabb_tree_move(aabb_tree_t *tree, size_t leaf, aabb_t box,
+                    vector_t displacement) {
+  assert(leaf < tree->capacity && tree->nodes[leaf].height == 0);
+  if (aabb_contains(tree->nodes[leaf].box, box)) {
+    return false;
+  }
+  detach_leaf(tree, leaf);
+  tree->nodes[leaf].box = fatten_box(tree, box, displacement);
+  insert_leaf(tree, leaf);
+  return true;
+}
+
+aabb_t aabb_tree_get_box(aabb_tree_t *tree, size_t leaf) {
+  assert(leaf < tree->capacity && tree->nodes[leaf].height == 0);
+  return tree->nodes[leaf].box;
+}
+
+void *aabb_tree_get_data(aabb_tree_t *tree, size_t leaf) {
+  assert(leaf < tree->capacity && tree->nodes[leaf].height == 0);
+  return tree->nodes[leaf].data;
+}
+
+size_t aabb_tree_size(aabb_tree_t *tree) { return tree->leaf_count; }
+
+int aabb_tree_height(aabb_tree_t *tree) {
+  return tree->root == AABB_TREE_NONE ? -1 : tree->nodes[tree->root].height;
+}
+
+void push_node(aabb_tree_t *tree, size_t *size, size_t index) {
+  if (*size == tree->stack_capacity) {
+    tree->stack_capacity *= 2;
+    tree->stack = realloc(tree->stack, tree->stack_capacity * sizeof(size_t));
+    assert(tree->stack != NULL);
+  }
+  tree->stack[(*size)++] = index;
+}
+
+void aabb_tree_query(aabb_tree_t *tree, aabb_t box,
+                     tree_query_handler_t handler, void *aux) {
+  if (tree->root == AABB_TREE_NONE ||
+      !aabb_overlap(tree->nodes[tree->root].box, box)) {
+    return;
+  }
+  // Only nodes whose boxes overlap the query are pushed
+  size_t size = 0;
+  push_node(tree, &size, tree->root);
+  while (size > 0) {
+    tree_node_t *node = &tree->nodes[tree->stack[--size]];
+    if (is_leaf(node)) {
+      if (!handler(node - tree->nodes, aux)) {
+        return;
+      }
+      continue;
+    }
+    size_t child1 = node->child1, child2 = node->child2;
+    if (aabb_overlap(tree->nodes[child1].box, box)) {
+      push_node(tree, &size, child1);
+    }
+    if (aabb_overlap(tree->nodes[child2].box, box)) {
+      push_node(tree, &size, child2);
+    }
+  }
+}
+
+// Narrows [*enter, *exit], the distances along a ray within a box so far, to
+// where the ray is between lo and hi along one axis. Returns whether any of
+// the ray is left.
+bool clip_axis(double start, double step, double lo, double hi, double *enter,
+               double *exit) {
+  if (step == 0) {
+    return start >= lo && start <= hi;
+  }
+  double t1 = (lo - start) / step, t2 = (hi - start) / step;
+  *enter = fmax(*enter, fmin(t1, t2));
+  *exit = fmin(*exit, fmax(t1, t2));
+  return *enter <= *exit;
+}
+
+// Finds how far along a ray it enters a box, or INFINITY if it misses it
+// within max_distance
+double ray_box_distance(vector_t origin, vector_t direction, aabb_t box,
+                        double max_distance) {
+  double enter = 0, exit = max_distance;
+  if (!clip_axis(origin.x, direction.x, box.min.x, box.max.x, &enter, &exit) ||
+      !clip_axis(origin.y, direction.y, box.min.y, box.max.y, &enter, &exit)) {
+    return INFINITY;
+  }
+  return enter;
+}
+
+void aabb_tree_raycast(aabb_tree_t *tree, vector_t origin, vector_t direction,
+                       double radius, double max_distance,
+                       tree_ray_handler_t handler, void *aux) {
+  if (tree->root == AABB_TREE_NONE) {
+    return;
+  }
+  size_t size = 0;
+  push_node(tree, &size, tree->root);
+  while (size > 0) {
+    tree_node_t *node = &tree->nodes[tree->stack[--size]];
+    // The circle touches a box when its center enters the box grown by radius
+    aabb_t box = {{node->box.min.x - radius, node->box.min.y - radius},
+                  {node->box.max.x + radius, node->box.max.y + radius}};
+    if (ray_box_distance(origin, direction, box, max_distance) == INFINITY) {
+      continue;
+    }
+    if (is_leaf(node)) {
+      max_distance =
+          fmin(max_distance, handler(node - tree->nodes, max_distance, aux));
+    } else {
+      push_node(tree, &size, node->child1);
+      push_node(tree, &size, node->child2);
+    }
+  }
+}
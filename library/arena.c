@@ -0,0 +1,146 @@
+#include "arena.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Blocks in the pools are this many bytes, doubling for each pool after the
+// first, counting the header in front of each block
+const size_t MIN_BLOCK = 32;
+#define POOL_COUNT 8
+// Blocks which don't come from any pool have this pool index
+const size_t NO_POOL = POOL_COUNT;
+
+// In front of every block, so arena_release() knows where it goes back to.
+// Its size keeps the block after it aligned for any type.
+typedef struct {
+  arena_t *arena;
+  size_t pool;
+} block_header_t;
+
+// In front of every chunk, linking the chunks so they can all be freed
+typedef struct chunk {
+  struct chunk *next;
+  size_t size;
+} chunk_t;
+
+typedef struct arena {
+  size_t chunk_size;
+  chunk_t *chunks;
+  // The part of the newest chunk which hasn't been handed out yet
+  char *top, *end;
+  // The blocks given back in each pool, linked through their first bytes
+  void *free_blocks[POOL_COUNT];
+  arena_stats_t stats;
+} arena_t;
+
+// Gets a chunk of memory from malloc() and links it into the arena's chunks,
+// returning the memory after the chunk's header
+char *add_chunk(arena_t *arena, size_t size) {
+  chunk_t *chunk = malloc(sizeof(chunk_t) + size);
+  assert(chunk != NULL);
+  chunk->next = arena->chunks;
+  chunk->size = size;
+  arena->chunks = chunk;
+  arena->stats.chunks++;
+  arena->stats.bytes += sizeof(chunk_t) + size;
+  return (char *)(chunk + 1);
+}
+
+arena_t *arena_init(size_t chunk_size) {
+  assert(chunk_size >= ARENA_MIN_CHUNK);
+  arena_t *arena = malloc(sizeof(arena_t));
+  assert(arena != NULL);
+  arena->chunk_size = chunk_size;
+  arena->chunks = NULL;
+  arena->top = NULL;
+  arena->end = NULL;
+  for (size_t i = 0; i < POOL_COUNT; i++) {
+    arena->free_blocks[i] = NULL;
+  }
+  arena->stats = (arena_stats_t){0, 0, 0, 0, 0};
+  return arena;
+}
+
+// The index of the smallest pool whose blocks hold size bytes, or NO_POOL
+size_t find_pool(size_t size) {
+  size_t block = MIN_BLOCK;
+  for (size_t pool = 0; pool < POOL_COUNT; pool++, block *= 2) {
+    if (size + sizeof(block_header_t) <= block) {
+      return pool;
+    }
+  }
+  return NO_POOL;
+}
+
+void *arena_alloc(arena_t *arena, size_t size) {
+  arena->stats.allocations++;
+  size_t pool = find_pool(size);
+  block_header_t *header;
+  if (pool == NO_POOL) {
+    header = (block_header_t *)add_chunk(arena, sizeof(block_header_t) + size);
+  } else if (arena->free_blocks[pool] != NULL) {
+    void *block = arena->free_blocks[pool];
+    arena->free_blocks[pool] = *(void **)block;
+    arena->stats.reuses++;
+    return block;
+  } else {
+    size_t block_size = MIN_BLOCK << pool;
+    if (arena->top == NULL || (size_t)(arena->end - arena->top) < block_size) {
+      arena->top = add_chunk(arena, arena->chunk_size);
+      arena->end = arena->top + arena->chunk_size;
+    }
+    header = (block_header_t *)arena->top;
+    arena->top += block_size;
+  }
+  header->arena = arena;
+  header->pool = pool;
+  return header + 1;
+}
+
+void *arena_realloc(arena_t *arena, void *block, size_t old_size,
+                    size_t size) {
+  void *moved = arena_alloc(arena, size);
+  if (block != NULL) {
+    memcpy(moved, block, old_size < size ? old_size : size);
+    arena_release(block);
+  }
+  return moved;
+}
+
+void arena_release(void *block) {
+  if (block == NULL) {
+    return;
+  }
+  block_header_t *header = (block_header_t *)block - 1;
+  arena_t *arena = header->arena;
+  arena->stats.releases++;
+  // Blocks with chunks of their own stay until the arena is freed
+  if (header->pool != NO_POOL) {
+    *(void **)block = arena->free_blocks[header->pool];
+    arena->free_blocks[header->pool] = block;
+  }
+}
+
+void *arena_allocator_alloc(void *arena, size_t size) {
+  return arena_alloc(arena, size);
+}
+
+void arena_allocator_release(void *arena, void *block) {
+  arena_release(block);
+}
+
+allocator_t arena_allocator(arena_t *arena) {
+  return (allocator_t){arena_allocator_alloc, arena_allocator_release, arena};
+}
+
+arena_stats_t arena_get_stats(arena_t *arena) { return arena->stats; }
+
+void arena_free(arena_t *arena) {
+  chunk_t *chunk = arena->chunks;
+  while (chunk != NULL) {
+    chunk_t *next = chunk->next;
+    free(chunk);
+    chunk = next;
+  }
+  free(arena);
+}
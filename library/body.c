@@ -1,36 +1,59 @@
+#include "collision.h"
 #include "color.h"
 #include "list.h"
-#include "polygon.h"
 #include "sdl_wrapper.h"
+#include "shape.h"
 #include "vector.h"
+#include "vertices.h"
 #include <SDL2/SDL.h>
 #include <SDL2/SDL2_gfxPrimitives.h>
 #include <SDL2/SDL_image.h>
 #include <assert.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 typedef struct body {
-  list_t *shape;
+  // Circles have no vertices; their shape is given by centroid and radius
+  shape_kind_t kind;
+  vertices_t *shape;
+  // Unit edge normals, recomputed lazily after the shape rotates or stretches
+  vertices_t *normals;
+  bool normals_stale;
+  // Kept up to date as the body moves, so the broad phase never rescans shape
+  aabb_t bounds;
   vector_t centroid, velocity, force, impulse;
+  // Where the centroid was before the last tick, for render interpolation
+  vector_t prev_centroid;
   rgb_color_t color;
-  double mass, angle, alpha;
+  double mass, angle, alpha, radius;
+  int type;
   void *info;
   free_func_t info_freer;
-  bool is_removed, to_respawn, respawnable, hidden, apply_forces;
-  SDL_Texture *image;
-  SDL_Texture *shadow;
+  bool is_removed, to_respawn, respawnable, hidden, apply_forces, asleep;
+  // Whether the body is drawn once into the background rather than per frame
+  bool background;
+  // Bodies in lower layers are drawn first
+  int layer;
+  // Where the scene holding the body keeps it
+  size_t slot;
+  // The scene's count of moving bodies, which setting the body moving adds to
+  size_t *awake_count;
+  sprite_t *image;
+  sprite_t *shadow;
   vector_t dimensions;
+  // Where the body and its vertices were allocated from
+  allocator_t allocator;
 } body_t;
 
-body_t *body_init_with_info_and_sprite(list_t *shape, double mass,
-                                       rgb_color_t color, void *info,
-                                       SDL_Texture *image,
-                                       free_func_t info_freer) {
+// Allocates a body at rest, leaving its shape to be set by the caller
+body_t *body_alloc(double mass, rgb_color_t color, void *info,
+                   sprite_t *image, free_func_t info_freer,
+                   allocator_t allocator) {
   assert(mass != 0);
-  body_t *body = malloc(sizeof(body_t));
-  body->shape = shape;
-  body->centroid = polygon_centroid(shape);
+  body_t *body = allocator.alloc(allocator.context, sizeof(body_t));
+  assert(body != NULL);
+  body->allocator = allocator;
   body->velocity = VEC_ZERO;
   body->force = VEC_ZERO;
   body->impulse = VEC_ZERO;
@@ -38,13 +61,19 @@ body_t *body_init_with_info_and_sprite(list_t *shape, double mass,
   body->mass = mass;
   body->angle = 0;
   body->alpha = 1;
+  body->type = -1;
   body->info = info;
   body->info_freer = info_freer;
   body->is_removed = false;
+  body->slot = SIZE_MAX;
+  body->awake_count = NULL;
   body->to_respawn = false;
   body->respawnable = false;
   body->hidden = false;
+  body->background = false;
+  body->layer = 0;
   body->apply_forces = true;
+  body->asleep = false;
   body->image = image;
   body->shadow = NULL;
   body->dimensions = VEC_ZERO;
@@ -52,6 +81,83 @@ body_t *body_init_with_info_and_sprite(list_t *shape, double mass,
   return body;
 }
 
+// Makes a polygonal body which owns shape, allocated from allocator
+body_t *body_init_polygon(vertices_t *shape, double mass, rgb_color_t color,
+                          void *info, sprite_t *image,
+                          free_func_t info_freer, allocator_t allocator) {
+  body_t *body = body_alloc(mass, color, info, image, info_freer, allocator);
+  body->kind = SHAPE_POLYGON;
+  body->shape = shape;
+  body->normals = vertices_init_with_allocator(vertices_size(shape), allocator);
+  body->normals_stale = true;
+  body->centroid = vertices_centroid(shape);
+  body->prev_centroid = body->centroid;
+  body->radius = 0;
+  body->bounds = find_bounds(vertices_view(shape));
+  return body;
+}
+
+body_t *body_init_with_vertices(vertices_t *shape, double mass,
+                                rgb_color_t color, void *info,
+                                sprite_t *image, free_func_t info_freer) {
+  return body_init_polygon(shape, mass, color, info, image, info_freer,
+                           malloc_allocator());
+}
+
+body_t *body_init_with_allocator(list_t *shape, double mass,
+                                 rgb_color_t color, void *info,
+                                 sprite_t *image, free_func_t info_freer,
+                                 allocator_t allocator) {
+  size_t n = list_size(shape);
+  vertices_t *vertices = vertices_init_with_allocator(n, allocator);
+  for (size_t i = 0; i < n; i++) {
+    vertices_add(vertices, *(vector_t *)list_get(shape, i));
+  }
+  list_free(shape);
+  return body_init_polygon(vertices, mass, color, info, image, info_freer,
+                           allocator);
+}
+
+body_t *body_init_circle_with_allocator(vector_t center, double radius,
+                                        double mass, rgb_color_t color,
+                                        void *info, sprite_t *image,
+                                        free_func_t info_freer,
+                                        allocator_t allocator) {
+  assert(radius > 0);
+  body_t *body = body_alloc(mass, color, info, image, info_freer, allocator);
+  body->kind = SHAPE_CIRCLE;
+  body->shape = NULL;
+  body->normals = NULL;
+  body->normals_stale = false;
+  body->centroid = center;
+  body->prev_centroid = center;
+  body->radius = radius;
+  body->bounds = find_bounds(circle_view(center, radius));
+  return body;
+}
+
+body_t *body_init_circle_with_info_and_sprite(vector_t center, double radius,
+                                              double mass, rgb_color_t color,
+                                              void *info, sprite_t *image,
+                                              free_func_t info_freer) {
+  return body_init_circle_with_allocator(center, radius, mass, color, info,
+                                         image, info_freer, malloc_allocator());
+}
+
+body_t *body_init_circle(vector_t center, double radius, double mass,
+                         rgb_color_t color) {
+  return body_init_circle_with_info_and_sprite(center, radius, mass, color,
+                                               NULL, NULL, NULL);
+}
+
+body_t *body_init_with_info_and_sprite(list_t *shape, double mass,
+                                       rgb_color_t color, void *info,
+                                       sprite_t *image,
+                                       free_func_t info_freer) {
+  return body_init_with_allocator(shape, mass, color, info, image, info_freer,
+                                  malloc_allocator());
+}
+
 body_t *body_init_with_info(list_t *shape, double mass, rgb_color_t color,
                             void *info, free_func_t info_freer) {
   return body_init_with_info_and_sprite(shape, mass, color, info, NULL,
@@ -63,39 +169,98 @@ body_t *body_init(list_t *shape, double mass, rgb_color_t color) {
 }
 
 void body_free(body_t *body) {
-  list_free(body->shape);
+  if (body->shape != NULL) {
+    vertices_free(body->shape);
+    vertices_free(body->normals);
+  }
   if (body->info_freer != NULL) {
     body->info_freer(body->info);
   }
-  if (body->image != NULL) {
-    SDL_DestroyTexture(body->image);
+  sdl_release_image(body->image);
+  sdl_release_image(body->shadow);
+  body->allocator.release(body->allocator.context, body);
+}
+
+list_t *body_get_shape(body_t *body) {
+  if (body->kind == SHAPE_CIRCLE) {
+    vector_t center = body->centroid;
+    return draw_circle(&center, body->radius);
   }
-  free(body);
+  return vertices_to_list(body->shape);
 }
 
-list_t *body_get_shape(body_t *body) { return polygon_copy(body->shape); }
+shape_view_t body_get_shape_view(body_t *body) {
+  if (body->kind == SHAPE_CIRCLE) {
+    return circle_view(body->centroid, body->radius);
+  }
+  if (body->normals_stale) {
+    vertices_normals(body->shape, body->normals);
+    body->normals_stale = false;
+  }
+  shape_view_t view = vertices_view(body->shape);
+  view.nx = vertices_x(body->normals);
+  view.ny = vertices_y(body->normals);
+  return view;
+}
 
 double body_get_angle(body_t *body) { return body->angle; }
 
 vector_t body_get_centroid(body_t *body) { return body->centroid; }
 
-vector_t body_get_center(body_t *body) { return polygon_center(body->shape); }
+vector_t body_get_center(body_t *body) {
+  if (body->kind == SHAPE_CIRCLE) {
+    return body->centroid;
+  }
+  return vertices_center(body->shape);
+}
 
 vector_t body_get_velocity(body_t *body) { return body->velocity; }
 
+void body_save_centroid(body_t *body) {
+  body->prev_centroid = body->centroid;
+}
+
+vector_t body_get_interpolated_centroid(body_t *body, double alpha) {
+  return vec_add(body->prev_centroid,
+                 vec_multiply(alpha, vec_subtract(body->centroid,
+                                                  body->prev_centroid)));
+}
+
+aabb_t body_get_bounds(body_t *body) { return body->bounds; }
+
+int body_get_type(body_t *body) { return body->type; }
+
+void body_set_type(body_t *body, int type) {
+  assert(-1 <= type && type < 32);
+  body->type = type;
+}
+
 double body_get_mass(body_t *body) { return body->mass; }
 
 rgb_color_t body_get_color(body_t *body) { return body->color; }
 
 void *body_get_info(body_t *body) { return body->info; }
 
-SDL_Texture *body_get_image(body_t *body) { return body->image; }
+sprite_t *body_get_image(body_t *body) { return body->image; }
 
-SDL_Texture *body_get_shadow(body_t *body) { return body->shadow; }
+sprite_t *body_get_shadow(body_t *body) { return body->shadow; }
 
 vector_t body_get_dimensions(body_t *body) { return body->dimensions; }
 
-void body_set_velocity(body_t *body, vector_t v) { body->velocity = v; }
+// Wakes a body which has been set moving, and tells its scene
+void body_set_moving(body_t *body) {
+  body->asleep = false;
+  if (body->awake_count != NULL) {
+    (*body->awake_count)++;
+  }
+}
+
+void body_set_velocity(body_t *body, vector_t v) {
+  body->velocity = v;
+  if (!vec_is_equal(v, VEC_ZERO)) {
+    body_set_moving(body);
+  }
+}
 
 void body_set_color(body_t *body, rgb_color_t color) { body->color = color; }
 
@@ -103,20 +268,45 @@ void body_set_dimensions(body_t *body, vector_t dimensions) {
   body->dimensions = dimensions;
 }
 
-void body_set_image(body_t *body, SDL_Texture *image) { body->image = image; }
+void body_set_image(body_t *body, sprite_t *image) {
+  sdl_release_image(body->image);
+  body->image = image;
+}
 
-void body_set_shadow(body_t *body, SDL_Texture *shadow) {
+void body_set_shadow(body_t *body, sprite_t *shadow) {
+  sdl_release_image(body->shadow);
   body->shadow = shadow;
 }
 
+// Updates the cached normals and bounds after the vertices change shape
+void body_reshape(body_t *body) {
+  body->normals_stale = body->kind != SHAPE_CIRCLE;
+  if (body->kind == SHAPE_CIRCLE) {
+    body->bounds = find_bounds(circle_view(body->centroid, body->radius));
+  } else {
+    body->bounds = find_bounds(vertices_view(body->shape));
+  }
+}
+
 void body_rotate_about_point(body_t *body, double angle, vector_t point) {
-  polygon_rotate(body->shape, angle, point);
   body->angle += angle;
-  body->centroid = polygon_centroid(body->shape);
+  if (body->kind == SHAPE_CIRCLE) {
+    body->centroid =
+        vec_add(vec_rotate(vec_subtract(body->centroid, point), angle), point);
+  } else {
+    vertices_rotate(body->shape, angle, point);
+    body->centroid = vertices_centroid(body->shape);
+  }
+  body_reshape(body);
 }
 
 void body_rotate(body_t *body, double angle) {
-  polygon_rotate(body->shape, angle, body->centroid);
+  body->asleep = false;
+  // A circle looks the same at every angle, so only its sprite turns
+  if (body->kind != SHAPE_CIRCLE) {
+    vertices_rotate(body->shape, angle, body->centroid);
+    body_reshape(body);
+  }
   body->angle += angle;
 }
 
@@ -125,20 +315,33 @@ void body_set_rotation(body_t *body, double angle) {
 }
 
 void body_translate(body_t *body, vector_t displacement) {
-  polygon_translate(body->shape, displacement);
+  body->asleep = false;
+  if (body->kind != SHAPE_CIRCLE) {
+    vertices_translate(body->shape, displacement);
+  }
+  body->bounds.min = vec_add(body->bounds.min, displacement);
+  body->bounds.max = vec_add(body->bounds.max, displacement);
   body->centroid = vec_add(body->centroid, displacement);
 }
 
 void body_set_centroid(body_t *body, vector_t v) {
   body_translate(body, vec_subtract(v, body->centroid));
+  // A body placed somewhere jumps there instead of sliding across the screen
+  body->prev_centroid = body->centroid;
 }
 
 void body_add_force(body_t *body, vector_t force) {
   body->force = vec_add(body->force, force);
+  if (!vec_is_equal(force, VEC_ZERO)) {
+    body_set_moving(body);
+  }
 }
 
 void body_add_impulse(body_t *body, vector_t impulse) {
   body->impulse = vec_add(body->impulse, impulse);
+  if (!vec_is_equal(impulse, VEC_ZERO)) {
+    body_set_moving(body);
+  }
 }
 
 void body_tick(body_t *body, double dt) {
@@ -154,14 +357,41 @@ void body_tick(body_t *body, double dt) {
   body_translate(body, vec_multiply(dt, v_avg));
 }
 
+bool body_is_resting(body_t *body) {
+  return vec_is_within(REST_SPEED, body->velocity, VEC_ZERO) &&
+         vec_is_equal(body->force, VEC_ZERO) &&
+         vec_is_equal(body->impulse, VEC_ZERO);
+}
+
+void body_sleep(body_t *body) {
+  body->velocity = VEC_ZERO;
+  // It is drawn where it stopped, not sliding in from where it last was
+  body->prev_centroid = body->centroid;
+  body->asleep = true;
+}
+
+void body_wake(body_t *body) { body->asleep = false; }
+
+bool body_is_asleep(body_t *body) { return body->asleep; }
+
 void body_remove(body_t *body) { body->is_removed = true; }
 
 bool body_is_removed(body_t *body) { return body->is_removed; }
 
+size_t body_get_slot(body_t *body) { return body->slot; }
+
+void body_set_slot(body_t *body, size_t slot) { body->slot = slot; }
+
+void body_set_awake_count(body_t *body, size_t *awake_count) {
+  body->awake_count = awake_count;
+}
+
 void body_stretch_x(body_t *body, double factor) {
+  assert(body->kind != SHAPE_CIRCLE);
   vector_t old_centroid = body_get_centroid(body);
-  polygon_stretch_x(body->shape, factor);
-  body->centroid = polygon_centroid(body->shape);
+  vertices_stretch_x(body->shape, factor);
+  body->centroid = vertices_centroid(body->shape);
+  body_reshape(body);
   body_set_centroid(body, old_centroid);
 }
 
@@ -181,6 +411,16 @@ void body_hide(body_t *body, bool hidden) { body->hidden = hidden; }
 
 bool body_hidden(body_t *body) { return body->hidden; }
 
+void body_set_background(body_t *body, bool background) {
+  body->background = background;
+}
+
+bool body_is_background(body_t *body) { return body->background; }
+
+void body_set_layer(body_t *body, int layer) { body->layer = layer; }
+
+int body_get_layer(body_t *body) { return body->layer; }
+
 void body_set_apply_forces(body_t *body, bool apply_forces) {
   body->apply_forces = apply_forces;
 }
@@ -8,21 +8,10 @@
 
 const int INF = 10000;
 
-vector_t find_projection(list_t *shape, vector_t axis) {
-  double min = DBL_MAX;
-  double max = -DBL_MAX;
-  for (size_t i = 0; i < list_size(shape); i++) {
-    vector_t *vertex = list_get(shape, i);
-    double d = vec_dot(axis, *vertex);
-    if (d < min) {
-      min = d;
-    }
-    if (d > max) {
-      max = d;
-    }
-  }
-  assert(min < max);
-  return (vector_t){min, max};
+vector_t find_projection(shape_view_t shape, vector_t axis) {
+  vector_t projection = vec_project_all(shape.x, shape.y, shape.size, axis);
+  assert(projection.x < projection.y);
+  return projection;
 }
 
 double find_overlap(vector_t proj1, vector_t proj2) {
@@ -35,39 +24,342 @@ double find_overlap(vector_t proj1, vector_t proj2) {
   }
 }
 
-collision_info_t find_collision(list_t *shape1, list_t *shape2) {
-  double min_overlap = DBL_MAX;
-  vector_t collision_axis = VEC_ZERO;
+// Gets the unit normal of edge i of a polygon, from the cache if it has one
+vector_t find_edge_normal(shape_view_t shape, size_t i) {
+  if (shape.nx != NULL) {
+    return (vector_t){shape.nx[i], shape.ny[i]};
+  }
+  size_t j = (i + 1) % shape.size;
+  return vec_unit(
+      (vector_t){shape.y[i] - shape.y[j], shape.x[j] - shape.x[i]});
+}
 
-  for (size_t i = 0; i < list_size(shape1); i++) {
-    vector_t *p1 = list_get(shape1, i);
-    vector_t *p2 = list_get(shape1, (i + 1) % list_size(shape1));
-    vector_t axis = vec_unit((vector_t){p1->y - p2->y, p2->x - p1->x});
-    vector_t proj1 = find_projection(shape1, axis);
-    vector_t proj2 = find_projection(shape2, axis);
+// Finds the smallest overlap between the projections of two shapes onto the
+// edge normals of the first shape. Returns false if some axis separates them.
+bool find_min_overlap(shape_view_t edges, shape_view_t other,
+                      double *min_overlap, vector_t *collision_axis) {
+  for (size_t i = 0; i < edges.size; i++) {
+    vector_t axis = find_edge_normal(edges, i);
+    vector_t proj1 = find_projection(edges, axis);
+    vector_t proj2 = find_projection(other, axis);
     double overlap = find_overlap(proj1, proj2);
     if (overlap == 0) {
-      return (collision_info_t){false, VEC_ZERO};
-    } else if (overlap < min_overlap) {
-      min_overlap = overlap;
-      collision_axis = axis;
+      return false;
+    } else if (overlap < *min_overlap) {
+      *min_overlap = overlap;
+      *collision_axis = axis;
     }
   }
+  return true;
+}
+
+collision_info_t find_polygon_collision(shape_view_t shape1,
+                                        shape_view_t shape2) {
+  double min_overlap = DBL_MAX;
+  vector_t collision_axis = VEC_ZERO;
+  if (!find_min_overlap(shape1, shape2, &min_overlap, &collision_axis) ||
+      !find_min_overlap(shape2, shape1, &min_overlap, &collision_axis)) {
+    return (collision_info_t){false, VEC_ZERO, 0};
+  }
+  return (collision_info_t){true, collision_axis, min_overlap};
+}
 
-  for (size_t i = 0; i < list_size(shape2); i++) {
-    vector_t *p1 = list_get(shape2, i);
-    vector_t *p2 = list_get(shape2, (i + 1) % list_size(shape2));
-    vector_t axis = vec_unit((vector_t){p1->y - p2->y, p2->x - p1->x});
-    vector_t proj2 = find_projection(shape2, axis);
-    vector_t proj1 = find_projection(shape1, axis);
+collision_info_t find_circle_collision(shape_view_t circle1,
+                                       shape_view_t circle2) {
+  vector_t offset = vec_subtract(circle2.center, circle1.center);
+  double distance = vec_magnitude(offset);
+  double depth = circle1.radius + circle2.radius - distance;
+  if (depth <= 0) {
+    return (collision_info_t){false, VEC_ZERO, 0};
+  }
+  // Concentric circles have no preferred axis, so pick one
+  vector_t axis = distance > 0 ? vec_multiply(1 / distance, offset)
+                               : (vector_t){1, 0};
+  return (collision_info_t){true, axis, depth};
+}
+
+// Finds the collision between a polygon and a circle.
+// The axis points from the polygon towards the circle.
+collision_info_t find_polygon_circle_collision(shape_view_t polygon,
+                                               shape_view_t circle) {
+  double min_overlap = DBL_MAX;
+  vector_t collision_axis = VEC_ZERO;
+  // The circle can only touch a vertex if that vertex is the nearest one
+  size_t nearest = 0;
+  double nearest_distance = DBL_MAX;
+  for (size_t i = 0; i < polygon.size; i++) {
+    double dx = circle.center.x - polygon.x[i];
+    double dy = circle.center.y - polygon.y[i];
+    if (dx * dx + dy * dy < nearest_distance) {
+      nearest_distance = dx * dx + dy * dy;
+      nearest = i;
+    }
+  }
+  for (size_t i = 0; i <= polygon.size; i++) {
+    vector_t axis;
+    if (i < polygon.size) {
+      axis = find_edge_normal(polygon, i);
+    } else if (nearest_distance > 0) {
+      axis = vec_unit((vector_t){circle.center.x - polygon.x[nearest],
+                                 circle.center.y - polygon.y[nearest]});
+    } else {
+      break;
+    }
+    double d = vec_dot(axis, circle.center);
+    vector_t proj1 = find_projection(polygon, axis);
+    vector_t proj2 = {d - circle.radius, d + circle.radius};
     double overlap = find_overlap(proj1, proj2);
     if (overlap == 0) {
-      return (collision_info_t){false, VEC_ZERO};
+      return (collision_info_t){false, VEC_ZERO, 0};
     } else if (overlap < min_overlap) {
       min_overlap = overlap;
       collision_axis = axis;
     }
   }
+  // Edge normals have no orientation, so point the axis towards the circle
+  double sum_x = 0, sum_y = 0;
+  for (size_t i = 0; i < polygon.size; i++) {
+    sum_x += polygon.x[i];
+    sum_y += polygon.y[i];
+  }
+  vector_t center = {sum_x / polygon.size, sum_y / polygon.size};
+  if (vec_dot(collision_axis, vec_subtract(circle.center, center)) < 0) {
+    collision_axis = vec_negate(collision_axis);
+  }
+  return (collision_info_t){true, collision_axis, min_overlap};
+}
+
+collision_info_t find_collision_view(shape_view_t shape1, shape_view_t shape2) {
+  if (shape1.kind == SHAPE_CIRCLE && shape2.kind == SHAPE_CIRCLE) {
+    return find_circle_collision(shape1, shape2);
+  } else if (shape1.kind == SHAPE_CIRCLE) {
+    collision_info_t collision = find_polygon_circle_collision(shape2, shape1);
+    collision.axis = vec_negate(collision.axis);
+    return collision;
+  } else if (shape2.kind == SHAPE_CIRCLE) {
+    return find_polygon_circle_collision(shape1, shape2);
+  }
+  return find_polygon_collision(shape1, shape2);
+}
+
+// Finds the first time at which a point moving from start at a velocity
+// comes within radius of center, or INFINITY if it never does
+double ray_circle_impact(vector_t start, vector_t velocity, vector_t center,
+                         double radius) {
+  vector_t offset = vec_subtract(start, center);
+  double a = vec_dot(velocity, velocity);
+  double b = vec_dot(offset, velocity);
+  double c = vec_dot(offset, offset) - radius * radius;
+  // The point has to be closing in on the circle to hit it
+  if (a == 0 || b >= 0) {
+    return INFINITY;
+  }
+  double discriminant = b * b - a * c;
+  if (discriminant < 0) {
+    return INFINITY;
+  }
+  return fmax((-b - sqrt(discriminant)) / a, 0);
+}
+
+// Finds the first time at which a point moving from start at a velocity
+// comes within radius of the segment from a to b, or INFINITY if it never
+// does. The point must start further than radius from the segment.
+double ray_capsule_impact(vector_t start, vector_t velocity, vector_t a,
+                          vector_t b, double radius) {
+  double time = fmin(ray_circle_impact(start, velocity, a, radius),
+                     ray_circle_impact(start, velocity, b, radius));
+  vector_t edge = vec_subtract(b, a);
+  double length = vec_magnitude(edge);
+  if (length == 0) {
+    return time;
+  }
+  vector_t normal = {-edge.y / length, edge.x / length};
+  double distance = vec_dot(vec_subtract(start, a), normal);
+  double closing = vec_dot(velocity, normal);
+  // Only the side of the capsule facing the point can be hit first
+  if (distance * closing >= 0) {
+    return time;
+  }
+  double side = distance > 0 ? radius : -radius;
+  double t = (side - distance) / closing;
+  vector_t hit = vec_add(start, vec_multiply(t, velocity));
+  double along = vec_dot(vec_subtract(hit, a), edge) / (length * length);
+  if (t >= 0 && along >= 0 && along <= 1) {
+    time = fmin(time, t);
+  }
+  return time;
+}
+
+// Finds the distance from a point to a convex polygon, which is 0 inside it
+double point_polygon_distance(vector_t point, shape_view_t polygon) {
+  double min_distance = DBL_MAX;
+  bool left = false, right = false;
+  for (size_t i = 0; i < polygon.size; i++) {
+    size_t j = (i + 1) % polygon.size;
+    vector_t a = {polygon.x[i], polygon.y[i]};
+    vector_t edge = {polygon.x[j] - a.x, polygon.y[j] - a.y};
+    vector_t offset = vec_subtract(point, a);
+    double cross = vec_cross(edge, offset);
+    left |= cross > 0;
+    right |= cross < 0;
+    double along = vec_dot(offset, edge) / vec_dot(edge, edge);
+    along = fmin(fmax(along, 0), 1);
+    min_distance =
+        fmin(min_distance,
+             vec_magnitude(vec_subtract(offset, vec_multiply(along, edge))));
+  }
+  // A point is inside a convex polygon if it is on the same side of every edge
+  return left && right ? min_distance : 0;
+}
+
+// Finds when a circle moving at a velocity relative to a polygon first
+// overlaps it by slop
+double polygon_circle_impact(shape_view_t polygon, shape_view_t circle,
+                             vector_t velocity, double slop) {
+  double radius = circle.radius - slop;
+  if (point_polygon_distance(circle.center, polygon) <= radius) {
+    return 0;
+  }
+  // The polygon grown by the radius is the union of a capsule around each edge
+  double time = INFINITY;
+  for (size_t i = 0; i < polygon.size; i++) {
+    size_t j = (i + 1) % polygon.size;
+    time = fmin(time, ray_capsule_impact(
+                          circle.center, velocity,
+                          (vector_t){polygon.x[i], polygon.y[i]},
+                          (vector_t){polygon.x[j], polygon.y[j]}, radius));
+  }
+  return time;
+}
+
+double find_time_of_impact(shape_view_t shape1, vector_t velocity1,
+                           shape_view_t shape2, vector_t velocity2,
+                           double slop, double max_time) {
+  double time;
+  if (shape1.kind == SHAPE_CIRCLE && shape2.kind == SHAPE_CIRCLE) {
+    double radius = shape1.radius + shape2.radius - slop;
+    vector_t offset = vec_subtract(shape2.center, shape1.center);
+    time = vec_dot(offset, offset) <= radius * radius
+               ? 0
+               : ray_circle_impact(shape2.center,
+                                   vec_subtract(velocity2, velocity1),
+                                   shape1.center, radius);
+  } else if (shape1.kind == SHAPE_CIRCLE) {
+    time = polygon_circle_impact(shape2, shape1,
+                                 vec_subtract(velocity1, velocity2), slop);
+  } else if (shape2.kind == SHAPE_CIRCLE) {
+    time = polygon_circle_impact(shape1, shape2,
+                                 vec_subtract(velocity2, velocity1), slop);
+  } else {
+    return INFINITY;
+  }
+  return time <= max_time ? time : INFINITY;
+}
+
+bool shape_contains_point(shape_view_t shape, vector_t point) {
+  if (shape.kind == SHAPE_CIRCLE) {
+    vector_t offset = vec_subtract(point, shape.center);
+    return vec_dot(offset, offset) <= shape.radius * shape.radius;
+  }
+  return point_polygon_distance(point, shape) == 0;
+}
+
+double find_circle_cast(shape_view_t shape, vector_t start, vector_t direction,
+                        double radius, vector_t *normal) {
+  if (shape.kind == SHAPE_CIRCLE) {
+    double reach = shape.radius + radius;
+    vector_t offset = vec_subtract(start, shape.center);
+    if (vec_dot(offset, offset) <= reach * reach) {
+      *normal = vec_negate(direction);
+      return 0;
+    }
+    double distance = ray_circle_impact(start, direction, shape.center, reach);
+    if (distance < INFINITY) {
+      vector_t hit = vec_add(start, vec_multiply(distance, direction));
+      *normal = vec_unit(vec_subtract(hit, shape.center));
+    }
+    return distance;
+  }
 
-  return (collision_info_t){true, collision_axis};
-}
\ No newline at end of file
+  if (point_polygon_distance(start, shape) <= radius) {
+    *normal = vec_negate(direction);
+    return 0;
+  }
+  double distance = INFINITY;
+  size_t edge = 0;
+  for (size_t i = 0; i < shape.size; i++) {
+    size_t j = (i + 1) % shape.size;
+    double d = ray_capsule_impact(start, direction,
+                                  (vector_t){shape.x[i], shape.y[i]},
+                                  (vector_t){shape.x[j], shape.y[j]}, radius);
+    if (d < distance) {
+      distance = d;
+      edge = i;
+    }
+  }
+  if (distance == INFINITY) {
+    return distance;
+  }
+  size_t next = (edge + 1) % shape.size;
+  vector_t a = {shape.x[edge], shape.y[edge]};
+  vector_t side = {shape.x[next] - a.x, shape.y[next] - a.y};
+  vector_t hit = vec_add(start, vec_multiply(distance, direction));
+  vector_t offset = vec_subtract(hit, a);
+  double along = fmin(fmax(vec_dot(offset, side) / vec_dot(side, side), 0), 1);
+  if (radius > 0) {
+    // The circle's center is radius from the nearest point of the edge
+    *normal = vec_unit(vec_subtract(offset, vec_multiply(along, side)));
+  } else {
+    // A ray ends on the edge itself, so face the edge's normal towards it
+    *normal = vec_unit((vector_t){-side.y, side.x});
+    if (vec_dot(*normal, direction) > 0) {
+      *normal = vec_negate(*normal);
+    }
+  }
+  return distance;
+}
+
+collision_info_t find_collision(list_t *shape1, list_t *shape2) {
+  vertices_t *vertices1 = vertices_from_list(shape1);
+  vertices_t *vertices2 = vertices_from_list(shape2);
+  collision_info_t collision =
+      find_collision_view(vertices_view(vertices1), vertices_view(vertices2));
+  vertices_free(vertices1);
+  vertices_free(vertices2);
+  return collision;
+}
+
+aabb_t find_bounds(shape_view_t shape) {
+  if (shape.kind == SHAPE_CIRCLE) {
+    vector_t extent = {shape.radius, shape.radius};
+    return (aabb_t){vec_subtract(shape.center, extent),
+                    vec_add(shape.center, extent)};
+  }
+  aabb_t bounds = {{DBL_MAX, DBL_MAX}, {-DBL_MAX, -DBL_MAX}};
+  for (size_t i = 0; i < shape.size; i++) {
+    bounds.min.x = fmin(bounds.min.x, shape.x[i]);
+    bounds.max.x = fmax(bounds.max.x, shape.x[i]);
+  }
+  for (size_t i = 0; i < shape.size; i++) {
+    bounds.min.y = fmin(bounds.min.y, shape.y[i]);
+    bounds.max.y = fmax(bounds.max.y, shape.y[i]);
+  }
+  return bounds;
+}
+
+shape_view_t vertices_view(vertices_t *vertices) {
+  return (shape_view_t){.kind = SHAPE_POLYGON,
+                        .x = vertices_x(vertices),
+                        .y = vertices_y(vertices),
+                        .size = vertices_size(vertices)};
+}
+
+shape_view_t circle_view(vector_t center, double radius) {
+  return (shape_view_t){
+      .kind = SHAPE_CIRCLE, .center = center, .radius = radius};
+}
+
+bool aabb_overlap(aabb_t box1, aabb_t box2) {
+  return box1.min.x <= box2.max.x && box2.min.x <= box1.max.x &&
+         box1.min.y <= box2.max.y && box2.min.y <= box1.max.y;
+}
@@ -0,0 +1,406 @@
+#include "event_solver.h"
+#include "collision.h"
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+// How far two bodies overlap when their collision is resolved, as a fraction
+// of the radius of the smaller circle, so the collision handlers see them
+// colliding, as in scene_tick()
+const double EVENT_SLOP = 0.01;
+// How far ahead to look for collisions between balls which never stop
+const double EVENT_HORIZON = 1e6;
+const size_t INITIAL_EVENTS = 64;
+
+// The highest degree of polynomial solved for, i.e. the squared distance
+// between two balls which are both slowing down
+#define MAX_DEGREE 4
+
+typedef enum { EVENT_STOP, EVENT_CONTACT } event_kind_t;
+
+typedef struct {
+  double time;
+  event_kind_t kind;
+  size_t body1, body2;
+  // The versions of the bodies' motion the event was predicted from.
+  // If either body's motion has changed since, the event is skipped.
+  size_t version1, version2;
+} event_t;
+
+typedef struct event_solver {
+  scene_t *scene;
+  double deceleration;
+  double time;
+  size_t event_count;
+  // Indexed in the same order as the scene's bodies
+  body_t **bodies;
+  size_t *versions;
+  vector_t *centroids, *velocities;
+  bool *changed;
+  size_t body_count;
+  // A binary min-heap of predicted events, ordered by time
+  event_t *events;
+  size_t size, capacity;
+} event_solver_t;
+
+// Evaluates c[0] + c[1] t + ... + c[degree] t^degree
+double poly_eval(const double *c, size_t degree, double t) {
+  double value = c[degree];
+  for (size_t i = degree; i > 0; i--) {
+    value = value * t + c[i - 1];
+  }
+  return value;
+}
+
+// Finds each time in (lo, hi) where a polynomial changes sign, in increasing
+// order. Between two roots of its derivative, the polynomial is monotonic,
+// so each of those pieces has at most one root, which is found by bisection.
+size_t poly_roots(const double *c, size_t degree, double lo, double hi,
+                  double *roots) {
+  while (degree > 0 && c[degree] == 0) {
+    degree--;
+  }
+  if (degree == 0) {
+    return 0;
+  }
+  double bounds[MAX_DEGREE + 1];
+  size_t n = 0;
+  bounds[n++] = lo;
+  if (degree > 1) {
+    double derivative[MAX_DEGREE];
+    for (size_t i = 0; i < degree; i++) {
+      derivative[i] = (i + 1) * c[i + 1];
+    }
+    n += poly_roots(derivative, degree - 1, lo, hi, bounds + 1);
+  }
+  bounds[n++] = hi;
+
+  size_t count = 0;
+  for (size_t i = 0; i + 1 < n; i++) {
+    double a = bounds[i], b = bounds[i + 1];
+    bool a_positive = poly_eval(c, degree, a) > 0;
+    if (a_positive == (poly_eval(c, degree, b) > 0)) {
+      continue;
+    }
+    // Halve the interval until it can't be split any further
+    for (double mid = (a + b) / 2; a < mid && mid < b; mid = (a + b) / 2) {
+      if ((poly_eval(c, degree, mid) > 0) == a_positive) {
+        a = mid;
+      } else {
+        b = mid;
+      }
+    }
+    roots[count++] = b;
+  }
+  return count;
+}
+
+// Finds the first time in (0, hi) at which a polynomial goes from positive
+// to negative, or INFINITY if it doesn't
+double poly_first_descent(const double *c, size_t degree, double hi) {
+  double roots[MAX_DEGREE];
+  size_t n = poly_roots(c, degree, 0, hi, roots);
+  double prev = 0;
+  for (size_t i = 0; i < n; i++) {
+    if (poly_eval(c, degree, (prev + roots[i]) / 2) > 0) {
+      return roots[i];
+    }
+    prev = roots[i];
+  }
+  return INFINITY;
+}
+
+bool is_moving(event_solver_t *solver, size_t i) {
+  return body_get_shape_view(solver->bodies[i]).kind == SHAPE_CIRCLE &&
+         !vec_is_equal(body_get_velocity(solver->bodies[i]), VEC_ZERO);
+}
+
+// Gets how long a body has until it stops, or INFINITY if it never does
+double stop_time(event_solver_t *solver, size_t i) {
+  if (!is_moving(solver, i) || solver->deceleration == 0) {
+    return INFINITY;
+  }
+  return vec_magnitude(body_get_velocity(solver->bodies[i])) /
+         solver->deceleration;
+}
+
+// Gets a moving body's acceleration, which opposes its velocity
+vector_t acceleration(event_solver_t *solver, size_t i) {
+  if (!is_moving(solver, i)) {
+    return VEC_ZERO;
+  }
+  return vec_multiply(-solver->deceleration,
+                      vec_unit(body_get_velocity(solver->bodies[i])));
+}
+
+// Finds when two balls will collide, before either of them stops
+double ball_ball_time(event_solver_t *solver, size_t i, size_t j) {
+  shape_view_t circle1 = body_get_shape_view(solver->bodies[i]);
+  shape_view_t circle2 = body_get_shape_view(solver->bodies[j]);
+  double radius = circle1.radius + circle2.radius -
+                  EVENT_SLOP * fmin(circle1.radius, circle2.radius);
+  double hi = fmin(fmin(stop_time(solver, i), stop_time(solver, j)),
+                   EVENT_HORIZON);
+
+  // The offset between the balls is p + v t + a t^2 / 2, so the squared
+  // distance between them is a quartic in t
+  vector_t p = vec_subtract(circle2.center, circle1.center);
+  vector_t v = vec_subtract(body_get_velocity(solver->bodies[j]),
+                            body_get_velocity(solver->bodies[i]));
+  vector_t a = vec_subtract(acceleration(solver, j), acceleration(solver, i));
+  double c[MAX_DEGREE + 1] = {vec_dot(p, p) - radius * radius,
+                              2 * vec_dot(p, v), vec_dot(v, v) + vec_dot(p, a),
+                              vec_dot(v, a), vec_dot(a, a) / 4};
+  return poly_first_descent(c, MAX_DEGREE, hi);
+}
+
+// Finds when a moving ball will hit a still polygon, before it stops
+double ball_polygon_time(event_solver_t *solver, size_t ball, size_t polygon) {
+  if (!is_moving(solver, ball)) {
+    return INFINITY;
+  }
+  shape_view_t circle = body_get_shape_view(solver->bodies[ball]);
+  vector_t velocity = body_get_velocity(solver->bodies[ball]);
+  double speed = vec_magnitude(velocity);
+  double d = solver->deceleration;
+  // The ball moves in a straight line, so find how far along it the ball
+  // hits the polygon, then when it gets that far
+  double distance = d > 0 ? speed * speed / (2 * d) : speed * EVENT_HORIZON;
+  double hit = find_time_of_impact(
+      body_get_shape_view(solver->bodies[polygon]), VEC_ZERO, circle,
+      vec_multiply(1 / speed, velocity), EVENT_SLOP * circle.radius, distance);
+  // A ball already touching the polygon is moving out of it
+  if (hit == 0 || isinf(hit)) {
+    return INFINITY;
+  }
+  if (d == 0) {
+    return hit / speed;
+  }
+  return (speed - sqrt(fmax(speed * speed - 2 * d * hit, 0))) / d;
+}
+
+void push_event(event_solver_t *solver, event_t event) {
+  if (solver->size == solver->capacity) {
+    solver->capacity *= 2;
+    solver->events =
+        realloc(solver->events, solver->capacity * sizeof(event_t));
+    assert(solver->events != NULL);
+  }
+  event_t *events = solver->events;
+  size_t i = solver->size++;
+  while (i > 0 && events[(i - 1) / 2].time > event.time) {
+    events[i] = events[(i - 1) / 2];
+    i = (i - 1) / 2;
+  }
+  events[i] = event;
+}
+
+event_t pop_event(event_solver_t *solver) {
+  event_t *events = solver->events;
+  event_t top = events[0];
+  event_t last = events[--solver->size];
+  size_t i = 0;
+  while (2 * i + 1 < solver->size) {
+    size_t child = 2 * i + 1;
+    if (child + 1 < solver->size &&
+        events[child + 1].time < events[child].time) {
+      child++;
+    }
+    if (events[child].time >= last.time) {
+      break;
+    }
+    events[i] = events[child];
+    i = child;
+  }
+  events[i] = last;
+  return top;
+}
+
+bool event_is_stale(event_solver_t *solver, event_t event) {
+  return solver->versions[event.body1] != event.version1 ||
+         (event.kind == EVENT_CONTACT &&
+          solver->versions[event.body2] != event.version2);
+}
+
+// Predicts a body's next stop and its next collision with every other body.
+// Pairs where both bodies changed are only predicted from the first body.
+void predict(event_solver_t *solver, size_t i) {
+  body_t *body = solver->bodies[i];
+  if (!body_get_apply_forces(body)) {
+    return;
+  }
+  bool moving = is_moving(solver, i);
+  double stop = stop_time(solver, i);
+  if (!isinf(stop)) {
+    push_event(solver, (event_t){solver->time + stop, EVENT_STOP, i, i,
+                                 solver->versions[i], solver->versions[i]});
+  }
+  bool circle = body_get_shape_view(body).kind == SHAPE_CIRCLE;
+  for (size_t j = 0; j < solver->body_count; j++) {
+    body_t *other = solver->bodies[j];
+    if (j == i || (solver->changed[j] && j < i) ||
+        !body_get_apply_forces(other) || (!moving && !is_moving(solver, j)) ||
+        !scene_has_collision_handler(solver->scene, body, other)) {
+      continue;
+    }
+    bool other_circle = body_get_shape_view(other).kind == SHAPE_CIRCLE;
+    double time;
+    if (circle && other_circle) {
+      time = ball_ball_time(solver, i, j);
+    } else if (circle) {
+      time = ball_polygon_time(solver, i, j);
+    } else if (other_circle) {
+      time = ball_polygon_time(solver, j, i);
+    } else {
+      continue;
+    }
+    if (!isinf(time)) {
+      push_event(solver,
+                 (event_t){solver->time + time, EVENT_CONTACT, i, j,
+                           solver->versions[i], solver->versions[j]});
+    }
+  }
+}
+
+// Predicts every event again, e.g. after bodies were removed from the scene
+void predict_all(event_solver_t *solver) {
+  size_t body_count = scene_bodies(solver->scene);
+  if (body_count > solver->body_count) {
+    solver->bodies = realloc(solver->bodies, body_count * sizeof(body_t *));
+    solver->versions = realloc(solver->versions, body_count * sizeof(size_t));
+    solver->centroids =
+        realloc(solver->centroids, body_count * sizeof(vector_t));
+    solver->velocities =
+        realloc(solver->velocities, body_count * sizeof(vector_t));
+    solver->changed = realloc(solver->changed, body_count * sizeof(bool));
+    assert(solver->bodies != NULL && solver->versions != NULL &&
+           solver->centroids != NULL && solver->velocities != NULL &&
+           solver->changed != NULL);
+  }
+  solver->body_count = body_count;
+  solver->size = 0;
+  for (size_t i = 0; i < body_count; i++) {
+    solver->bodies[i] = scene_get_body(solver->scene, i);
+    solver->versions[i] = 0;
+    solver->changed[i] = true;
+  }
+  for (size_t i = 0; i < body_count; i++) {
+    predict(solver, i);
+  }
+}
+
+// Moves every ball along its path for dt
+void advance(event_solver_t *solver, double dt) {
+  double d = solver->deceleration;
+  for (size_t i = 0; i < solver->body_count; i++) {
+    if (!is_moving(solver, i)) {
+      continue;
+    }
+    body_t *body = solver->bodies[i];
+    vector_t velocity = body_get_velocity(body);
+    double speed = vec_magnitude(velocity);
+    double t = fmin(dt, stop_time(solver, i));
+    vector_t direction = vec_multiply(1 / speed, velocity);
+    body_set_centroid(
+        body, vec_add(body_get_centroid(body),
+                      vec_multiply(speed * t - d * t * t / 2, direction)));
+    body_set_velocity(body, t == dt ? vec_multiply(speed - d * t, direction)
+                                    : VEC_ZERO);
+  }
+  solver->time += dt;
+}
+
+// Calls the collision handlers of any bodies that now overlap, then predicts
+// the events of each body whose motion they changed
+void resolve_contacts(event_solver_t *solver) {
+  for (size_t i = 0; i < solver->body_count; i++) {
+    solver->centroids[i] = body_get_centroid(solver->bodies[i]);
+    solver->velocities[i] = body_get_velocity(solver->bodies[i]);
+  }
+  scene_tick(solver->scene, 0);
+  if (scene_bodies(solver->scene) != solver->body_count) {
+    predict_all(solver);
+    return;
+  }
+  for (size_t i = 0; i < solver->body_count; i++) {
+    body_t *body = solver->bodies[i];
+    solver->changed[i] =
+        !vec_is_equal(body_get_centroid(body), solver->centroids[i]) ||
+        !vec_is_equal(body_get_velocity(body), solver->velocities[i]);
+    solver->versions[i] += solver->changed[i];
+  }
+  for (size_t i = 0; i < solver->body_count; i++) {
+    if (solver->changed[i]) {
+      predict(solver, i);
+    }
+  }
+}
+
+event_solver_t *event_solver_init(scene_t *scene, double deceleration) {
+  assert(deceleration >= 0);
+  event_solver_t *solver = malloc(sizeof(event_solver_t));
+  assert(solver != NULL);
+  solver->scene = scene;
+  solver->deceleration = deceleration;
+  solver->time = 0;
+  solver->event_count = 0;
+  solver->bodies = NULL;
+  solver->versions = NULL;
+  solver->centroids = NULL;
+  solver->velocities = NULL;
+  solver->changed = NULL;
+  solver->body_count = 0;
+  solver->events = malloc(INITIAL_EVENTS * sizeof(event_t));
+  assert(solver->events != NULL);
+  solver->size = 0;
+  solver->capacity = INITIAL_EVENTS;
+  predict_all(solver);
+  return solver;
+}
+
+void event_solver_free(event_solver_t *solver) {
+  free(solver->bodies);
+  free(solver->versions);
+  free(solver->centroids);
+  free(solver->velocities);
+  free(solver->changed);
+  free(solver->events);
+  free(solver);
+}
+
+double event_solver_step(event_solver_t *solver, double max_time) {
+  while (solver->size > 0 && event_is_stale(solver, solver->events[0])) {
+    pop_event(solver);
+  }
+  if (solver->size == 0 ||
+      solver->events[0].time - solver->time > max_time) {
+    if (isinf(max_time)) {
+      return 0;
+    }
+    advance(solver, max_time);
+    return max_time;
+  }
+
+  event_t event = pop_event(solver);
+  double dt = fmax(event.time - solver->time, 0);
+  advance(solver, dt);
+  solver->event_count++;
+  if (event.kind == EVENT_STOP) {
+    body_set_velocity(solver->bodies[event.body1], VEC_ZERO);
+    for (size_t i = 0; i < solver->body_count; i++) {
+      solver->changed[i] = i == event.body1;
+    }
+    solver->versions[event.body1]++;
+    predict(solver, event.body1);
+  }
+  // Also lets the scene put a ball which stopped to sleep
+  resolve_contacts(solver);
+  return dt;
+}
+
+double event_solver_get_time(event_solver_t *solver) { return solver->time; }
+
+size_t event_solver_events(event_solver_t *solver) {
+  return solver->event_count;
+}
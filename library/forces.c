@@ -7,145 +7,392 @@
 #include <stdio.h>
 #include <stdlib.h>
 
-const double FRICTION_THRESHOLD = 1e0;
+// Gravity is no stronger than between bodies this far apart, since it blows
+// up as the distance goes to 0
+const double GRAVITY_MIN_DISTANCE = 5;
+// Squares of the quadtree are split at most this many times, so bodies at
+// the same place share a square instead of splitting it forever
+#define MAX_QUAD_DEPTH 40
 
 typedef struct {
   double constant;
-  list_t *bodies;
 } aux_t;
 
 typedef struct {
   void *aux;
   free_func_t freer;
-  list_t *bodies;
+  body_t *body1, *body2;
   collision_handler_t handler;
   collision_sound_handler_t sound_handler;
   bool collided;
   sound_set_t *sound_set;
 } collision_aux_t;
 
-void aux_freer(aux_t *aux) {
-  list_free(aux->bodies);
-  free(aux);
-}
-
 void collision_aux_freer(collision_aux_t *aux) {
   if (aux->freer != NULL) {
     aux->freer(aux->aux);
   }
-  list_free(aux->bodies);
-  free(aux);
+  arena_release(aux);
 }
 
-void newtonian_gravity_helper(void *aux) {
-  int min_distance = 5;
-
-  assert(list_size(((aux_t *)aux)->bodies) == 2);
-  body_t *body1 = list_get(((aux_t *)aux)->bodies, 0);
-  body_t *body2 = list_get(((aux_t *)aux)->bodies, 1);
-  double G = ((aux_t *)aux)->constant;
-
-  vector_t difference =
-      vec_subtract(body_get_centroid(body2), body_get_centroid(body1));
-  double distance = vec_magnitude(difference) > min_distance
-                        ? vec_magnitude(difference)
-                        : min_distance;
-  double magnitude =
-      G * body_get_mass(body1) * body_get_mass(body2) / (distance * distance);
-  vector_t force = vec_init(magnitude, vec_direction(difference));
-  body_add_force(body1, force);
-  body_add_force(body2, vec_negate(force));
+// Allocates the auxiliary value of a collision from the scene's arena, since
+// it lives as long as the collision does
+aux_t *aux_init(scene_t *scene, double constant) {
+  aux_t *aux = arena_alloc(scene_get_arena(scene), sizeof(aux_t));
+  aux->constant = constant;
+  return aux;
+}
+
+void newtonian_gravity_kernel(const force_term_t *terms, size_t count,
+                              double dt) {
+  for (size_t i = 0; i < count; i++) {
+    body_t *body1 = terms[i].body1;
+    body_t *body2 = terms[i].body2;
+    double G = terms[i].constant;
+
+    // The forces are built by scaling the vectors they point along, rather
+    // than finding those vectors' angles and turning them back into vectors
+    vector_t difference =
+        vec_subtract(body_get_centroid(body2), body_get_centroid(body1));
+    double length = vec_magnitude(difference);
+    if (length == 0) {
+      continue;
+    }
+    double distance = fmax(length, GRAVITY_MIN_DISTANCE);
+    double magnitude =
+        G * body_get_mass(body1) * body_get_mass(body2) / (distance * distance);
+    vector_t force = vec_multiply(magnitude / length, difference);
+    body_add_force(body1, force);
+    body_add_force(body2, vec_negate(force));
+  }
 }
 
 void create_newtonian_gravity(scene_t *scene, double G, body_t *body1,
                               body_t *body2) {
-  aux_t *aux = malloc(sizeof(aux_t));
-  aux->constant = G;
-  aux->bodies = list_init(2, NULL);
-  list_add(aux->bodies, body1);
-  list_add(aux->bodies, body2);
-  list_t *bodies = list_init(2, NULL);
-  list_add(bodies, body1);
-  list_add(bodies, body2);
-  scene_add_bodies_force_creator(scene,
-                                 (force_creator_t)newtonian_gravity_helper, aux,
-                                 bodies, (free_func_t)aux_freer);
+  scene_add_force_term(scene, newtonian_gravity_kernel, G, body1, body2);
 }
 
-void spring_helper(void *aux) {
-  assert(list_size(((aux_t *)aux)->bodies) == 2);
-  body_t *body1 = list_get(((aux_t *)aux)->bodies, 0);
-  body_t *body2 = list_get(((aux_t *)aux)->bodies, 1);
-  double k = ((aux_t *)aux)->constant;
-
-  vector_t difference =
-      vec_subtract(body_get_centroid(body2), body_get_centroid(body1));
-  double magnitude = k * vec_magnitude(difference);
-  vector_t force = vec_init(magnitude, vec_direction(difference));
-  body_add_force(body1, force);
-  body_add_force(body2, vec_negate(force));
+/**
+ * A square of the Barnes-Hut quadtree. A leaf holds at most one body, unless
+ * it is as small as squares get; any other square is split into four.
+ */
+typedef struct {
+  vector_t center;
+  double half_side;
+  double mass;
+  // The sum of each body's mass times its position while the tree is built,
+  // then the center of mass
+  vector_t mass_center;
+  // The index of the first of the square's four children, or -1 for a leaf
+  int children;
+  // The index of the body in a leaf, or -1 if it has none
+  int body;
+} quad_node_t;
+
+typedef struct {
+  scene_t *scene;
+  double G, theta;
+  // The bodies the field acts on in the current tick, packed into arrays
+  size_t count, capacity;
+  body_t **bodies;
+  double *x, *y, *mass, *fx, *fy;
+  quad_node_t *quads;
+  size_t quad_count, quad_capacity;
+} gravity_field_t;
+
+void gravity_field_free(gravity_field_t *field) {
+  free(field->bodies);
+  free(field->x);
+  free(field->y);
+  free(field->mass);
+  free(field->fx);
+  free(field->fy);
+  free(field->quads);
+  arena_release(field);
 }
 
-void create_spring(scene_t *scene, double k, body_t *body1, body_t *body2) {
-  aux_t *aux = malloc(sizeof(aux_t));
-  aux->constant = k;
-  aux->bodies = list_init(2, NULL);
-  list_add(aux->bodies, body1);
-  list_add(aux->bodies, body2);
-  list_t *bodies = list_init(2, NULL);
-  list_add(bodies, body1);
-  list_add(bodies, body2);
-  scene_add_bodies_force_creator(scene, (force_creator_t)spring_helper, aux,
-                                 bodies, (free_func_t)aux_freer);
+// Packs the position and mass of each body the field acts on into arrays
+void gather_field_bodies(gravity_field_t *field) {
+  size_t body_count = scene_bodies(field->scene);
+  if (body_count > field->capacity) {
+    field->capacity = body_count;
+    field->bodies = realloc(field->bodies, body_count * sizeof(body_t *));
+    field->x = realloc(field->x, body_count * sizeof(double));
+    field->y = realloc(field->y, body_count * sizeof(double));
+    field->mass = realloc(field->mass, body_count * sizeof(double));
+    field->fx = realloc(field->fx, body_count * sizeof(double));
+    field->fy = realloc(field->fy, body_count * sizeof(double));
+    assert(field->bodies != NULL && field->x != NULL && field->y != NULL &&
+           field->mass != NULL && field->fx != NULL && field->fy != NULL);
+  }
+  field->count = 0;
+  for (size_t i = 0; i < body_count; i++) {
+    body_t *body = scene_get_body(field->scene, i);
+    if (body_is_removed(body) || !body_get_apply_forces(body) ||
+        isinf(body_get_mass(body))) {
+      continue;
+    }
+    size_t j = field->count++;
+    vector_t centroid = body_get_centroid(body);
+    field->bodies[j] = body;
+    field->x[j] = centroid.x;
+    field->y[j] = centroid.y;
+    field->mass[j] = body_get_mass(body);
+    field->fx[j] = 0;
+    field->fy[j] = 0;
+  }
+}
+
+// Adds the pull of body i to the force on every body, including itself,
+// which it doesn't pull. The loop has no branches or calls, so the compiler
+// can run it on several bodies at once with SIMD instructions. (fmax() would
+// stop it, as it has to handle NaN.)
+void pull_every_body(gravity_field_t *field, size_t i) {
+  const double *restrict x = field->x;
+  const double *restrict y = field->y;
+  const double *restrict mass = field->mass;
+  double *restrict fx = field->fx;
+  double *restrict fy = field->fy;
+  double min_squared = GRAVITY_MIN_DISTANCE * GRAVITY_MIN_DISTANCE;
+  double xi = x[i], yi = y[i], g_mass = field->G * mass[i];
+  size_t count = field->count;
+  for (size_t j = 0; j < count; j++) {
+    double dx = xi - x[j], dy = yi - y[j];
+    double squared = dx * dx + dy * dy;
+    // Body i is at distance 0 from itself, so divide by 1 there instead
+    double distance = sqrt(squared) + (squared == 0);
+    double scale = g_mass * mass[j] /
+                   (distance * (squared > min_squared ? squared : min_squared));
+    fx[j] += scale * dx;
+    fy[j] += scale * dy;
+  }
 }
 
-void drag_helper(void *aux) {
-  assert(list_size(((aux_t *)aux)->bodies) == 1);
-  body_t *body = list_get(((aux_t *)aux)->bodies, 0);
-  double gamma = ((aux_t *)aux)->constant;
+// Makes a leaf, returning its index. May move the other squares.
+int add_quad(gravity_field_t *field, vector_t center, double half_side) {
+  if (field->quad_count == field->quad_capacity) {
+    field->quad_capacity = 2 * field->quad_capacity + 4;
+    field->quads =
+        realloc(field->quads, field->quad_capacity * sizeof(quad_node_t));
+    assert(field->quads != NULL);
+  }
+  field->quads[field->quad_count] =
+      (quad_node_t){center, half_side, 0, VEC_ZERO, -1, -1};
+  return field->quad_count++;
+}
 
-  vector_t v = body_get_velocity(body);
-  double magnitude = gamma * vec_magnitude(v) * vec_magnitude(v);
-  vector_t force = vec_init(-magnitude, vec_direction(v));
-  body_add_force(body, force);
+// The index of the child of a split square which a point is in
+int child_quad(quad_node_t *quad, double x, double y) {
+  return quad->children + (x >= quad->center.x) + 2 * (y >= quad->center.y);
 }
 
-void create_drag(scene_t *scene, double gamma, body_t *body) {
-  aux_t *aux = malloc(sizeof(aux_t));
-  aux->constant = gamma;
-  aux->bodies = list_init(1, NULL);
-  list_add(aux->bodies, body);
-  list_t *bodies = list_init(1, NULL);
-  list_add(bodies, body);
-  scene_add_bodies_force_creator(scene, (force_creator_t)drag_helper, aux,
-                                 bodies, (free_func_t)aux_freer);
+// Adds a body to the square it is in, and the square's mass to each square
+// on the way, splitting the leaf it lands in if it already holds a body
+void insert_quad(gravity_field_t *field, int body) {
+  double x = field->x[body], y = field->y[body], mass = field->mass[body];
+  int index = 0;
+  for (size_t depth = 0;; depth++) {
+    quad_node_t *quad = &field->quads[index];
+    quad->mass += mass;
+    quad->mass_center = vec_add(quad->mass_center, (vector_t){mass * x,
+                                                              mass * y});
+    if (quad->children < 0) {
+      if (quad->body < 0) {
+        quad->body = body;
+        return;
+      }
+      if (depth == MAX_QUAD_DEPTH) {
+        return;
+      }
+      // Split the leaf, moving its body down into one of the new squares
+      double quarter = quad->half_side / 2;
+      vector_t center = quad->center;
+      int children = field->quad_count;
+      for (int k = 0; k < 4; k++) {
+        add_quad(field, vec_add(center, (vector_t){k % 2 ? quarter : -quarter,
+                                                   k / 2 ? quarter : -quarter}),
+                 quarter);
+      }
+      quad = &field->quads[index];
+      quad->children = children;
+      int other = quad->body;
+      quad->body = -1;
+      quad_node_t *child = &field->quads[child_quad(quad, field->x[other],
+                                               field->y[other])];
+      child->body = other;
+      child->mass = field->mass[other];
+      child->mass_center = (vector_t){field->mass[other] * field->x[other],
+                                      field->mass[other] * field->y[other]};
+    }
+    index = child_quad(quad, x, y);
+  }
+}
+
+// Builds the quadtree over the bodies, in a square around all of them
+void build_quadtree(gravity_field_t *field) {
+  double min_x = INFINITY, min_y = INFINITY;
+  double max_x = -INFINITY, max_y = -INFINITY;
+  for (size_t i = 0; i < field->count; i++) {
+    min_x = fmin(min_x, field->x[i]);
+    min_y = fmin(min_y, field->y[i]);
+    max_x = fmax(max_x, field->x[i]);
+    max_y = fmax(max_y, field->y[i]);
+  }
+  field->quad_count = 0;
+  add_quad(field, (vector_t){(min_x + max_x) / 2, (min_y + max_y) / 2},
+           fmax(max_x - min_x, max_y - min_y) / 2 + GRAVITY_MIN_DISTANCE);
+  for (size_t i = 0; i < field->count; i++) {
+    insert_quad(field, i);
+  }
+  for (size_t i = 0; i < field->quad_count; i++) {
+    quad_node_t *quad = &field->quads[i];
+    if (quad->mass > 0) {
+      quad->mass_center = vec_multiply(1 / quad->mass, quad->mass_center);
+    }
+  }
 }
 
-void gravity_friction_helper(void *aux) {
-  assert(list_size(((aux_t *)aux)->bodies) == 1);
-  body_t *body = list_get(((aux_t *)aux)->bodies, 0);
-  double mu_x_g = ((aux_t *)aux)->constant;
+// Adds the pull of every other body on body i to its force. A square far
+// enough away that it looks smaller than theta pulls like one body at its
+// center of mass.
+void pull_from_quadtree(gravity_field_t *field, size_t i) {
+  int stack[3 * MAX_QUAD_DEPTH + 4];
+  size_t size = 0;
+  stack[size++] = 0;
+  double xi = field->x[i], yi = field->y[i];
+  double theta_squared = field->theta * field->theta;
+  double min_squared = GRAVITY_MIN_DISTANCE * GRAVITY_MIN_DISTANCE;
+  double fx = 0, fy = 0;
+  while (size > 0) {
+    quad_node_t *quad = &field->quads[stack[--size]];
+    if (quad->mass == 0 || quad->body == (int)i) {
+      continue;
+    }
+    double dx = quad->mass_center.x - xi, dy = quad->mass_center.y - yi;
+    double squared = dx * dx + dy * dy;
+    double side = 2 * quad->half_side;
+    if (quad->children < 0 || side * side < theta_squared * squared) {
+      double distance = sqrt(squared);
+      double scale = distance > 0 ? quad->mass / (distance *
+                                                   fmax(squared, min_squared))
+                                  : 0;
+      fx += scale * dx;
+      fy += scale * dy;
+    } else {
+      for (int k = 0; k < 4; k++) {
+        stack[size++] = quad->children + k;
+      }
+    }
+  }
+  double g_mass = field->G * field->mass[i];
+  field->fx[i] = g_mass * fx;
+  field->fy[i] = g_mass * fy;
+}
 
-  vector_t v = body_get_velocity(body);
-  if (vec_magnitude(v) < FRICTION_THRESHOLD) {
-    body_set_velocity(body, VEC_ZERO);
+void gravity_field_helper(gravity_field_t *field) {
+  gather_field_bodies(field);
+  if (field->count < 2) {
+    return;
+  }
+  if (field->theta == 0) {
+    for (size_t i = 0; i < field->count; i++) {
+      pull_every_body(field, i);
+    }
   } else {
-    double magnitude = mu_x_g * body_get_mass(body);
-    vector_t force = vec_init(-magnitude, vec_direction(v));
+    build_quadtree(field);
+    for (size_t i = 0; i < field->count; i++) {
+      pull_from_quadtree(field, i);
+    }
+  }
+  for (size_t i = 0; i < field->count; i++) {
+    body_add_force(field->bodies[i], (vector_t){field->fx[i], field->fy[i]});
+  }
+}
+
+void create_gravity_field(scene_t *scene, double G, double theta) {
+  assert(theta >= 0);
+  // The packed arrays are resized as bodies come and go, so they are kept on
+  // the heap rather than in the scene's arena
+  arena_t *arena = scene_get_arena(scene);
+  gravity_field_t *field = arena_alloc(arena, sizeof(gravity_field_t));
+  field->scene = scene;
+  field->G = G;
+  field->theta = theta;
+  field->count = 0;
+  field->capacity = 0;
+  field->bodies = NULL;
+  field->x = NULL;
+  field->y = NULL;
+  field->mass = NULL;
+  field->fx = NULL;
+  field->fy = NULL;
+  field->quads = NULL;
+  field->quad_count = 0;
+  field->quad_capacity = 0;
+  scene_add_bodies_force_creator(scene, (force_creator_t)gravity_field_helper,
+                                 field,
+                                 list_init_with_allocator(
+                                     0, NULL, arena_allocator(arena)),
+                                 (free_func_t)gravity_field_free);
+}
+
+void spring_kernel(const force_term_t *terms, size_t count, double dt) {
+  for (size_t i = 0; i < count; i++) {
+    body_t *body1 = terms[i].body1;
+    body_t *body2 = terms[i].body2;
+    double k = terms[i].constant;
+
+    // k times the distance, along the difference
+    vector_t force = vec_multiply(
+        k, vec_subtract(body_get_centroid(body2), body_get_centroid(body1)));
+    body_add_force(body1, force);
+    body_add_force(body2, vec_negate(force));
+  }
+}
+
+void create_spring(scene_t *scene, double k, body_t *body1, body_t *body2) {
+  scene_add_force_term(scene, spring_kernel, k, body1, body2);
+}
+
+void drag_kernel(const force_term_t *terms, size_t count, double dt) {
+  for (size_t i = 0; i < count; i++) {
+    body_t *body = terms[i].body1;
+    double gamma = terms[i].constant;
+
+    // gamma times the speed squared, against the velocity
+    vector_t v = body_get_velocity(body);
+    vector_t force = vec_multiply(-gamma * vec_magnitude(v), v);
     body_add_force(body, force);
   }
 }
 
+void create_drag(scene_t *scene, double gamma, body_t *body) {
+  scene_add_force_term(scene, drag_kernel, gamma, body, NULL);
+}
+
+void gravity_friction_kernel(const force_term_t *terms, size_t count,
+                             double dt) {
+  for (size_t i = 0; i < count; i++) {
+    body_t *body = terms[i].body1;
+    double mu_x_g = terms[i].constant;
+
+    // Friction can stop a body but never reverse it, so a body which would
+    // pass through zero velocity this tick is stopped outright. Otherwise
+    // the body oscillates about zero and the scene never comes to rest.
+    vector_t v = body_get_velocity(body);
+    double speed = vec_magnitude(v);
+    if (speed < REST_SPEED || speed <= mu_x_g * dt) {
+      body_set_velocity(body, VEC_ZERO);
+    } else {
+      double magnitude = mu_x_g * body_get_mass(body);
+      vector_t force = vec_multiply(-magnitude / speed, v);
+      body_add_force(body, force);
+    }
+  }
+}
+
 void create_gravity_friction(scene_t *scene, double mu_x_g, body_t *body) {
-  aux_t *aux = malloc(sizeof(aux_t));
-  aux->constant = mu_x_g;
-  aux->bodies = list_init(1, NULL);
-  list_add(aux->bodies, body);
-  list_t *bodies = list_init(1, NULL);
-  list_add(bodies, body);
-  scene_add_bodies_force_creator(scene,
-                                 (force_creator_t)gravity_friction_helper, aux,
-                                 bodies, (free_func_t)aux_freer);
+  scene_add_force_term(scene, gravity_friction_kernel, mu_x_g, body, NULL);
 }
 
 void destructive_collision_handler(body_t *body1, body_t *body2, vector_t axis,
@@ -156,10 +403,8 @@ void destructive_collision_handler(body_t *body1, body_t *body2, vector_t axis,
 
 void create_destructive_collision(scene_t *scene, body_t *body1,
                                   body_t *body2) {
-  aux_t *aux = malloc(sizeof(aux_t));
-  aux->bodies = list_init(0, NULL);
-  create_collision(scene, body1, body2, destructive_collision_handler, aux,
-                   (free_func_t)aux_freer);
+  create_collision(scene, body1, body2, destructive_collision_handler,
+                   aux_init(scene, 0), arena_release);
 }
 
 void breaking_collision_handler(body_t *body1, body_t *body2, vector_t axis,
@@ -174,11 +419,8 @@ void breaking_collision_handler(body_t *body1, body_t *body2, vector_t axis,
 
 void create_breaking_collision(scene_t *scene, double elasticity, body_t *body1,
                                body_t *body2) {
-  aux_t *aux = malloc(sizeof(aux_t));
-  aux->bodies = list_init(0, NULL);
-  aux->constant = elasticity;
-  create_collision(scene, body1, body2, breaking_collision_handler, aux,
-                   (free_func_t)aux_freer);
+  create_collision(scene, body1, body2, breaking_collision_handler,
+                   aux_init(scene, elasticity), arena_release);
 }
 
 void physics_collision_handler(body_t *body1, body_t *body2, vector_t axis,
@@ -204,21 +446,16 @@ void physics_collision_handler(body_t *body1, body_t *body2, vector_t axis,
 
 void create_physics_collision(scene_t *scene, double elasticity, body_t *body1,
                               body_t *body2) {
-  aux_t *aux = malloc(sizeof(aux_t));
-  aux->bodies = list_init(0, NULL);
-  aux->constant = elasticity;
-  create_collision(scene, body1, body2, physics_collision_handler, aux,
-                   (free_func_t)aux_freer);
+  create_collision(scene, body1, body2, physics_collision_handler,
+                   aux_init(scene, elasticity), arena_release);
 }
 
 void create_physics_collision_with_sound(
     scene_t *scene, double elasticity, body_t *body1, body_t *body2,
     collision_sound_handler_t sound_handler) {
-  aux_t *aux = malloc(sizeof(aux_t));
-  aux->bodies = list_init(0, NULL);
-  aux->constant = elasticity;
   create_collision_with_sound(scene, body1, body2, physics_collision_handler,
-                              sound_handler, aux, (free_func_t)aux_freer);
+                              sound_handler, aux_init(scene, elasticity),
+                              arena_release);
 }
 
 // body 1 = pocket
@@ -240,18 +477,16 @@ void create_physics_collision_with_sound(
 //   int *info = body_get_info(ball);
 //   aux->constant = *info;
 //   create_collision_with_sound(scene, pocket, ball, pocket_collision_handler,
-//                               sound_handler, aux, (free_func_t)aux_freer);
+//                               sound_handler, aux, free);
 // }
 
 void collision_helper(void *aux) {
   collision_aux_t *c_aux = aux;
-  assert(list_size(c_aux->bodies) == 2);
-  body_t *body1 = list_get(c_aux->bodies, 0);
-  body_t *body2 = list_get(c_aux->bodies, 1);
+  body_t *body1 = c_aux->body1;
+  body_t *body2 = c_aux->body2;
 
-  list_t *shape1 = body_get_shape(body1);
-  list_t *shape2 = body_get_shape(body2);
-  collision_info_t collision = find_collision(shape1, shape2);
+  collision_info_t collision = find_collision_view(body_get_shape_view(body1),
+                                                   body_get_shape_view(body2));
   if (collision.collided) {
     if (!c_aux->collided) {
       c_aux->handler(body1, body2, collision.axis, c_aux->aux);
@@ -263,8 +498,6 @@ void collision_helper(void *aux) {
   } else {
     c_aux->collided = false;
   }
-  list_free(shape1);
-  list_free(shape2);
 }
 
 void create_collision(scene_t *scene, body_t *body1, body_t *body2,
@@ -277,17 +510,17 @@ void create_collision_with_sound(scene_t *scene, body_t *body1, body_t *body2,
                                  collision_handler_t handler,
                                  collision_sound_handler_t sound_handler,
                                  void *aux, free_func_t freer) {
-  collision_aux_t *c_aux = malloc(sizeof(collision_aux_t));
+  arena_t *arena = scene_get_arena(scene);
+  collision_aux_t *c_aux = arena_alloc(arena, sizeof(collision_aux_t));
   c_aux->aux = aux;
   c_aux->freer = freer;
-  c_aux->bodies = list_init(2, NULL);
-  list_add(c_aux->bodies, body1);
-  list_add(c_aux->bodies, body2);
+  c_aux->body1 = body1;
+  c_aux->body2 = body2;
   c_aux->handler = handler;
   c_aux->sound_handler = sound_handler;
   c_aux->collided = false;
   c_aux->sound_set = scene_get_sound_set(scene);
-  list_t *bodies = list_init(2, NULL);
+  list_t *bodies = list_init_with_allocator(2, NULL, arena_allocator(arena));
   list_add(bodies, body1);
   list_add(bodies, body2);
   scene_add_bodies_force_creator(scene, collision_helper, c_aux, bodies,
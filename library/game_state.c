@@ -4,6 +4,29 @@
 #include <SDL2/SDL2_gfxPrimitives.h>
 #include <SDL2/SDL_image.h>
 
+// The images on the table small enough to share an atlas, so the balls and
+// their shadows, the cue and the buttons are drawn from one texture. The table
+// and the floor are each too big to.
+const char *TABLE_SPRITES[] = {
+    "assets/Shadow.png",
+    "assets/Red.png",
+    "assets/White.png",
+    "assets/Yellow.png",
+    "assets/Green.png",
+    "assets/Brown.png",
+    "assets/Blue.png",
+    "assets/Pink.png",
+    "assets/Black.png",
+    "assets/CueWood.png",
+    "assets/PowerBar.png",
+    "assets/PowerMarker.png",
+    "assets/ResetButton.png",
+    "assets/MuteButton.png",
+    "assets/MuteButtonON.png",
+};
+const size_t TABLE_SPRITE_COUNT =
+    sizeof(TABLE_SPRITES) / sizeof(TABLE_SPRITES[0]);
+
 double table_width() { return TABLE_WIDTH * SCALE; }
 double table_height() { return TABLE_HEIGHT * SCALE; }
 double wall_width() { return WALL_WIDTH * SCALE; }
@@ -76,14 +99,27 @@ bool on_mute_button(vector_t position) {
           BUTTON_RADIUS);
 }
 
+// Where the table's bodies are allocated from: the scene's arena, so a new
+// game frees the old table in one go
+allocator_t table_allocator(state_t *state) {
+  return arena_allocator(scene_get_arena(state->scene));
+}
+
+// Allocates a body's info in the scene's arena
+info_t *table_info(state_t *state, info_t value) {
+  info_t *info = arena_alloc(scene_get_arena(state->scene), sizeof(info_t));
+  *info = value;
+  return info;
+}
+
 void create_edges(state_t *state) {
+  allocator_t allocator = table_allocator(state);
   double x_center = (MAX_POS.x - MIN_POS.x) / 2;
   double y_center = (MAX_POS.y - MIN_POS.y) / 2;
   double x_base = x_center - table_height() / 2;
   double y_base = y_center - table_width() / 2;
 
-  int *info = malloc(sizeof(int));
-  *info = WALL_INFO;
+  info_t *info = table_info(state, WALL_INFO);
 
   vector_t p1 = {x_center + pocket_size() / 2, y_base};
   vector_t p2 = {x_center + pocket_size() / 2 + edge_width() / 2,
@@ -95,7 +131,8 @@ void create_edges(state_t *state) {
                  y_base};
   list_t *shape_x1 = draw_quadrilateral(p1, p2, p3, p4);
   body_t *wall_x1 =
-      body_init_with_info(shape_x1, INFINITY, DARK_GRAY, info, free);
+      body_init_with_allocator(shape_x1, INFINITY, DARK_GRAY, info, NULL,
+                               arena_release, allocator);
   list_t *shape_x2 = body_get_shape(wall_x1);
   list_t *shape_x3 = body_get_shape(wall_x1);
   list_t *shape_x4 = body_get_shape(wall_x1);
@@ -104,11 +141,14 @@ void create_edges(state_t *state) {
   polygon_reflect_x(shape_x4, x_center);
   polygon_reflect_y(shape_x4, y_center);
   body_t *wall_x2 =
-      body_init_with_info(shape_x2, INFINITY, DARK_GRAY, info, NULL);
+      body_init_with_allocator(shape_x2, INFINITY, DARK_GRAY, info, NULL, NULL,
+                               allocator);
   body_t *wall_x3 =
-      body_init_with_info(shape_x3, INFINITY, DARK_GRAY, info, NULL);
+      body_init_with_allocator(shape_x3, INFINITY, DARK_GRAY, info, NULL, NULL,
+                               allocator);
   body_t *wall_x4 =
-      body_init_with_info(shape_x4, INFINITY, DARK_GRAY, info, NULL);
+      body_init_with_allocator(shape_x4, INFINITY, DARK_GRAY, info, NULL, NULL,
+                               allocator);
 
   p1 = (vector_t){x_base, y_base + pocket_size() / 2 * sqrt(2)};
   p2 = (vector_t){x_base + edge_width(),
@@ -120,12 +160,20 @@ void create_edges(state_t *state) {
                   y_center + table_width() / 2 - pocket_size() / 2 * sqrt(2)};
   list_t *shape_y1 = draw_quadrilateral(p1, p2, p3, p4);
   body_t *wall_y1 =
-      body_init_with_info(shape_y1, INFINITY, DARK_GRAY, info, NULL);
+      body_init_with_allocator(shape_y1, INFINITY, DARK_GRAY, info, NULL, NULL,
+                               allocator);
   list_t *shape_y2 = body_get_shape(wall_y1);
   polygon_reflect_x(shape_y2, x_center);
   body_t *wall_y2 =
-      body_init_with_info(shape_y2, INFINITY, DARK_GRAY, info, NULL);
+      body_init_with_allocator(shape_y2, INFINITY, DARK_GRAY, info, NULL, NULL,
+                               allocator);
   bool hidden = true;
+  body_set_type(wall_x1, WALL_INFO);
+  body_set_type(wall_x2, WALL_INFO);
+  body_set_type(wall_x3, WALL_INFO);
+  body_set_type(wall_x4, WALL_INFO);
+  body_set_type(wall_y1, WALL_INFO);
+  body_set_type(wall_y2, WALL_INFO);
   body_hide(wall_x1, hidden);
   body_hide(wall_x2, hidden);
   body_hide(wall_x3, hidden);
@@ -142,6 +190,7 @@ void create_edges(state_t *state) {
 }
 
 void create_pockets(state_t *state) {
+  allocator_t allocator = table_allocator(state);
   double x_center = (MAX_POS.x - MIN_POS.x) / 2;
   double y_center = (MAX_POS.y - MIN_POS.y) / 2;
   double x_base = x_center - table_height() / 2;
@@ -149,8 +198,7 @@ void create_pockets(state_t *state) {
   double depth = pocket_size();
   list_t *pockets = list_init(18, NULL);
 
-  int *info = malloc(sizeof(int));
-  *info = POCKET_INFO;
+  info_t *info = table_info(state, POCKET_INFO);
 
   vector_t s_p1 = {x_center + pocket_size() / 2, y_base - ball_radius() * 4.25};
   vector_t s_p2 = {x_center - pocket_size() / 2, y_base - ball_radius() * 4.25};
@@ -232,10 +280,13 @@ void create_pockets(state_t *state) {
     list_t *curr = list_get(pockets, i);
     body_t *pocket;
     if (i) {
-      pocket = body_init_with_info(curr, INFINITY, DARK_GRAY, info, NULL);
+      pocket = body_init_with_allocator(curr, INFINITY, DARK_GRAY, info, NULL,
+                                        NULL, allocator);
     } else {
-      pocket = body_init_with_info(curr, INFINITY, DARK_GRAY, info, free);
+      pocket = body_init_with_allocator(curr, INFINITY, DARK_GRAY, info, NULL,
+                                        arena_release, allocator);
     }
+    body_set_type(pocket, POCKET_INFO);
     body_hide(pocket, hidden);
     scene_add_body(state->scene, pocket);
   }
@@ -243,6 +294,7 @@ void create_pockets(state_t *state) {
 }
 
 void create_walls(state_t *state) {
+  allocator_t allocator = table_allocator(state);
   vector_t centroid_1 = {
       (MAX_POS.x - MIN_POS.x) / 2,
       (MAX_POS.y - MIN_POS.y - table_width() - wall_width()) / 2};
@@ -255,20 +307,23 @@ void create_walls(state_t *state) {
   vector_t centroid_4 = {
       (MAX_POS.x - MIN_POS.x + table_height() + wall_width()) / 2,
       (MAX_POS.y - MIN_POS.y) / 2};
-  int *info = malloc(sizeof(int));
-  *info = WALL_INFO;
-  body_t *wall1 = body_init_with_info(
+  info_t *info = table_info(state, WALL_INFO);
+  body_t *wall1 = body_init_with_allocator(
       draw_rectangle(&centroid_1, table_height(), wall_width()), INFINITY,
-      BLACK, info, free);
-  body_t *wall2 = body_init_with_info(
+      BLACK, info, NULL, arena_release, allocator);
+  body_t *wall2 = body_init_with_allocator(
       draw_rectangle(&centroid_2, table_height(), wall_width()), INFINITY,
-      BLACK, info, NULL);
-  body_t *wall3 = body_init_with_info(
-      draw_rectangle(&centroid_3, wall_width(), table_width()), INFINITY, BLACK,
-      info, NULL);
-  body_t *wall4 = body_init_with_info(
-      draw_rectangle(&centroid_4, wall_width(), table_width()), INFINITY, BLACK,
-      info, NULL);
+      BLACK, info, NULL, NULL, allocator);
+  body_t *wall3 = body_init_with_allocator(
+      draw_rectangle(&centroid_3, wall_width(), table_width()), INFINITY,
+      BLACK, info, NULL, NULL, allocator);
+  body_t *wall4 = body_init_with_allocator(
+      draw_rectangle(&centroid_4, wall_width(), table_width()), INFINITY,
+      BLACK, info, NULL, NULL, allocator);
+  body_set_type(wall1, WALL_INFO);
+  body_set_type(wall2, WALL_INFO);
+  body_set_type(wall3, WALL_INFO);
+  body_set_type(wall4, WALL_INFO);
   scene_add_body(state->scene, wall1);
   scene_add_body(state->scene, wall2);
   scene_add_body(state->scene, wall3);
@@ -276,22 +331,24 @@ void create_walls(state_t *state) {
 }
 
 void create_triangle(state_t *state) {
+  allocator_t allocator = table_allocator(state);
   double radius = ball_radius() * 1.1;
   vector_t initial_centroid = pink_pos();
   initial_centroid.x += 3 * ball_radius();
   for (int i = 0; i < 5; i++) {
     vector_t centroid = initial_centroid;
     for (int j = 0; j <= i; j++) {
-      info_t *info = malloc(sizeof(info_t));
-      *info = RED_INFO;
+      info_t *info = table_info(state, RED_INFO);
       char *image_path = "assets/Red.png";
-      SDL_Texture *image = sdl_load_image(image_path);
-      body_t *ball =
-          body_init_with_info_and_sprite(draw_circle(&centroid, ball_radius()),
-                                         BALL_MASS, RED, info, image, free);
+      sprite_t *image = sdl_load_image(image_path);
+      body_t *ball = body_init_circle_with_allocator(
+          centroid, ball_radius(), BALL_MASS, RED, info, image, arena_release,
+          allocator);
       body_set_dimensions(ball,
                           (vector_t){2 * ball_radius(), 2 * ball_radius()});
       body_set_shadow(ball, sdl_load_image("assets/Shadow.png"));
+      body_set_type(ball, RED_INFO);
+      body_set_layer(ball, BALL_LAYER);
       scene_add_body(state->scene, ball);
       centroid.y += 2 * radius;
     }
@@ -301,68 +358,70 @@ void create_triangle(state_t *state) {
 }
 
 void create_balls(state_t *state) {
+  allocator_t allocator = table_allocator(state);
   create_triangle(state);
   for (int i = 0; i < 7; i++) {
-    vector_t *centroid = malloc(sizeof(vector_t));
-    info_t *info = malloc(sizeof(info));
-    char *image_path = malloc(sizeof(char *));
+    vector_t centroid;
+    info_t *info = table_info(state, CUE_BALL_INFO);
+    char *image_path = NULL;
     rgb_color_t color = GRAY;
     switch (i) {
     case 0:
-      *centroid = cue_ball_pos();
+      centroid = cue_ball_pos();
       *info = CUE_BALL_INFO;
       image_path = "assets/White.png";
       break;
     case 1:
-      *centroid = yellow_pos();
+      centroid = yellow_pos();
       *info = YELLOW_INFO;
       color = YELLOW;
       image_path = "assets/Yellow.png";
       break;
     case 2:
-      *centroid = green_pos();
+      centroid = green_pos();
       *info = GREEN_INFO;
       color = GREEN;
       image_path = "assets/Green.png";
       break;
     case 3:
-      *centroid = brown_pos();
+      centroid = brown_pos();
       *info = BROWN_INFO;
       color = BROWN;
       image_path = "assets/Brown.png";
       break;
     case 4:
-      *centroid = blue_pos();
+      centroid = blue_pos();
       *info = BLUE_INFO;
       color = BLUE;
       image_path = "assets/Blue.png";
       break;
     case 5:
-      *centroid = pink_pos();
+      centroid = pink_pos();
       *info = PINK_INFO;
       color = PINK;
       image_path = "assets/Pink.png";
       break;
     case 6:
-      *centroid = black_pos();
+      centroid = black_pos();
       *info = BLACK_INFO;
       color = BLACK;
       image_path = "assets/Black.png";
       break;
     }
-    list_t *points = draw_circle(centroid, ball_radius());
-    SDL_Texture *image = sdl_load_image(image_path);
-    body_t *ball = body_init_with_info_and_sprite(points, BALL_MASS, color,
-                                                  info, image, free);
+    sprite_t *image = sdl_load_image(image_path);
+    body_t *ball = body_init_circle_with_allocator(
+        centroid, ball_radius(), BALL_MASS, color, info, image, arena_release,
+        allocator);
     body_set_dimensions(ball, (vector_t){2 * ball_radius(), 2 * ball_radius()});
     body_set_shadow(ball, sdl_load_image("assets/Shadow.png"));
     body_set_respawnable(ball, true);
+    body_set_type(ball, *info);
+    body_set_layer(ball, BALL_LAYER);
     if (i == CUE_BALL_INFO) {
       state->cue_ball = ball;
     } else {
       scene_add_body(state->scene, ball);
     }
-    free(centroid);
   }
   scene_add_body(state->scene, state->cue_ball);
 }
@@ -377,6 +436,7 @@ void create_semicircle(state_t *state) {
 }
 
 void create_cue(state_t *state) {
+  allocator_t allocator = table_allocator(state);
   vector_t centroid = cue_pos();
   double width = CUE_WIDTH * SCALE;
   vector_t p1 = {centroid.x - width / 2, centroid.y - cue_height() / 2};
@@ -384,17 +444,19 @@ void create_cue(state_t *state) {
   vector_t p3 = {centroid.x + width / 2, centroid.y + cue_height() / 2};
   vector_t p4 = {centroid.x - width / 2, centroid.y + cue_height() / 2};
   list_t *shape = draw_quadrilateral(p1, p2, p3, p4);
-  info_t *info = malloc(sizeof(info));
-  *info = CUE_INFO;
+  info_t *info = table_info(state, CUE_INFO);
   char *image_path = "assets/CueWood.png";
-  SDL_Texture *image = sdl_load_image(image_path);
-  state->cue = body_init_with_info_and_sprite(shape, TABLE_MASS, MAGENTA, info,
-                                              image, free);
+  sprite_t *image = sdl_load_image(image_path);
+  state->cue = body_init_with_allocator(shape, TABLE_MASS, MAGENTA, info, image,
+                                        arena_release, allocator);
   body_set_dimensions(state->cue, (vector_t){cue_width(), cue_height()});
+  body_set_type(state->cue, CUE_INFO);
+  body_set_layer(state->cue, CUE_LAYER);
   scene_add_body(state->scene, state->cue);
 }
 
 void create_table(state_t *state) {
+  allocator_t allocator = table_allocator(state);
   vector_t centroid =
       (vector_t){(MAX_POS.x - MIN_POS.x) / 2, (MAX_POS.y - MIN_POS.y) / 2};
   vector_t p1 = {centroid.x - table_height() / 2,
@@ -407,76 +469,93 @@ void create_table(state_t *state) {
                  centroid.y - table_width() / 2};
   list_t *shape = draw_quadrilateral(p1, p2, p3, p4);
   char *image_path = "assets/TableLowerdpi.png";
-  SDL_Texture *image = sdl_load_image(image_path);
+  sprite_t *image = sdl_load_image(image_path);
   body_t *table =
-      body_init_with_info_and_sprite(shape, CUE_MASS, WHITE, NULL, image, free);
+      body_init_with_allocator(shape, CUE_MASS, WHITE, NULL, image,
+                               arena_release, allocator);
   body_set_dimensions(table, (vector_t){table_height() + 8 * edge_width(),
                                         table_width() + 8 * edge_width()});
   // body_hide(table, true);
+  body_set_background(table, true);
   scene_add_body(state->scene, table);
-  state->table = shape;
 }
 
 void create_powerbar(state_t *state) {
+  allocator_t allocator = table_allocator(state);
   char *image_path = "assets/PowerBar.png";
-  SDL_Texture *image = sdl_load_image(image_path);
+  sprite_t *image = sdl_load_image(image_path);
   vector_t centroid = (vector_t){power_bar_pos().x + power_bar_width() / 2,
                                  power_bar_pos().y + power_bar_height() / 2};
   list_t *shape =
       draw_rectangle(&centroid, power_bar_width(), power_bar_height());
   body_t *power_bar =
-      body_init_with_info_and_sprite(shape, CUE_MASS, WHITE, NULL, image, free);
+      body_init_with_allocator(shape, CUE_MASS, WHITE, NULL, image,
+                               arena_release, allocator);
   body_set_dimensions(power_bar,
                       (vector_t){power_bar_width(), power_bar_height()});
+  body_set_background(power_bar, true);
+  body_set_layer(power_bar, UI_LAYER);
   scene_add_body(state->scene, power_bar);
 }
 
 void create_floor(state_t *state) {
+  allocator_t allocator = table_allocator(state);
   vector_t p1 = MIN_POS;
   vector_t p2 = {MIN_POS.x, MAX_POS.y};
   vector_t p3 = MAX_POS;
   vector_t p4 = {MAX_POS.x, MIN_POS.y};
   list_t *shape = draw_quadrilateral(p1, p2, p3, p4);
-  info_t *info = malloc(sizeof(info));
   char *image_path = "assets/Floor.png";
-  SDL_Texture *image = sdl_load_image(image_path);
-  body_t *floor = body_init_with_info_and_sprite(shape, CUE_MASS, MAGENTA, NULL,
-                                                 image, free);
+  sprite_t *image = sdl_load_image(image_path);
+  body_t *floor = body_init_with_allocator(shape, CUE_MASS, MAGENTA, NULL,
+                                           image, arena_release, allocator);
   body_set_dimensions(floor, MAX_POS);
   // body_hide(floor, true);
+  body_set_background(floor, true);
   scene_add_body(state->scene, floor);
 }
 
 void create_slider(state_t *state) {
+  allocator_t allocator = table_allocator(state);
   vector_t centroid = slider_pos();
   list_t *shape = draw_rectangle(&centroid, 100, 100);
   char *image_path = "assets/PowerMarker.png";
-  SDL_Texture *image = sdl_load_image(image_path);
+  sprite_t *image = sdl_load_image(image_path);
   state->slider =
-      body_init_with_info_and_sprite(shape, INFINITY, BLACK, NULL, image, free);
+      body_init_with_allocator(shape, INFINITY, BLACK, NULL, image,
+                               arena_release, allocator);
   body_set_dimensions(state->slider,
                       (vector_t){power_marker_width(), power_marker_height()});
   body_hide(state->slider, true);
+  body_set_layer(state->slider, UI_LAYER);
   scene_add_body(state->scene, state->slider);
 }
 
 void create_reset_button(state_t *state) {
+  allocator_t allocator = table_allocator(state);
   vector_t centroid = reset_button_pos();
   list_t *shape = draw_circle(&centroid, BUTTON_RADIUS);
   char *image_path = "assets/ResetButton.png";
-  SDL_Texture *image = sdl_load_image(image_path);
+  sprite_t *image = sdl_load_image(image_path);
   state->reset_button =
-      body_init_with_info_and_sprite(shape, INFINITY, GRAY, NULL, image, free);
+      body_init_with_allocator(shape, INFINITY, GRAY, NULL, image,
+                               arena_release, allocator);
+  body_set_layer(state->reset_button, UI_LAYER);
   scene_add_body(state->scene, state->reset_button);
 }
 
 void create_mute_button(state_t *state) {
+  allocator_t allocator = table_allocator(state);
   vector_t centroid = mute_button_pos();
   list_t *shape = draw_circle(&centroid, BUTTON_RADIUS);
   char *image_path = "assets/MuteButton.png";
-  SDL_Texture *image = sdl_load_image(image_path);
-  state->mute_button = body_init_with_info_and_sprite(shape, INFINITY, MAGENTA,
-                                                      NULL, image, free);
+  sprite_t *image = sdl_load_image(image_path);
+  state->mute_button = body_init_with_allocator(
+      shape, INFINITY, MAGENTA, NULL, image, arena_release, allocator);
+  // Toggling mute changes the button's image, which draws the background
+  // again
+  body_set_background(state->mute_button, true);
+  body_set_layer(state->mute_button, UI_LAYER);
   scene_add_body(state->scene, state->mute_button);
 }
 
@@ -556,75 +635,78 @@ bool ball_in_semicircle(body_t *ball) {
   return false;
 }
 
+// Builds the predictor for the cue ball's path, copying the cushions and
+// pockets, which never move
+trajectory_t *create_trajectory(state_t *state) {
+  trajectory_t *trajectory = trajectory_init(ball_radius(), B_W_ELASTICITY);
+  for (size_t i = 0; i < scene_bodies(state->scene); i++) {
+    body_t *body = scene_get_body(state->scene, i);
+    int *info = body_get_info(body);
+    if (info == NULL) {
+      continue;
+    }
+    if (*info == WALL_INFO) {
+      trajectory_add_cushion(trajectory, body_get_shape_view(body));
+    } else if (*info == POCKET_INFO) {
+      trajectory_add_pocket(trajectory, body_get_shape_view(body));
+    }
+  }
+  return trajectory;
+}
+
 void create_dotted_lines(state_t *state, vector_t axis) {
   if (!state->training_lines) {
     return;
   }
+  if (state->trajectory == NULL) {
+    state->trajectory = create_trajectory(state);
+  }
 
-  int separation = 150;
-  int increment = 20;
-  list_t *lines = list_init(10, NULL);
-  vector_t initial_c = body_get_centroid(state->cue_ball);
-  body_t *ball =
-      body_init(draw_circle(&initial_c, ball_radius()), BALL_MASS, WHITE);
-  vector_t velocity = vec_init(increment, vec_direction(axis));
-  int steps = 0;
-  int collisions = 0;
-  while (collisions < MAX_COLLISIONS) {
-    body_translate(ball, velocity);
-    for (int i = 0; i < scene_bodies(state->scene); i++) {
-      body_t *curr = scene_get_body(state->scene, i);
-      int *info = body_get_info(curr);
-      if (info == NULL || *info == CUE_BALL_INFO || *info == CUE_INFO) {
-        continue;
-      }
-      list_t *shape1 = body_get_shape(ball);
-      list_t *shape2 = body_get_shape(curr);
-      collision_info_t collision = find_collision(shape1, shape2);
-      list_free(shape1);
-      list_free(shape2);
-      if (collision.collided) {
-        if (*info == WALL_INFO) {
-          ball_near_table_edge(ball);
-        } else {
-          collisions = MAX_COLLISIONS;
-          break;
-        }
-        vector_t impulse = vec_multiply(-(1 + B_W_ELASTICITY) *
-                                            vec_dot(velocity, collision.axis),
-                                        collision.axis);
-        velocity = vec_add(velocity, impulse);
-        collisions++;
-        break;
-      }
+  trajectory_t *trajectory = state->trajectory;
+  trajectory_set_balls(trajectory, body_get_centroid(state->cue_ball));
+  for (size_t i = 0; i < scene_bodies(state->scene); i++) {
+    body_t *body = scene_get_body(state->scene, i);
+    int *info = body_get_info(body);
+    if (info != NULL && *info <= BLACK_INFO && body != state->cue_ball) {
+      trajectory_add_ball(trajectory, body_get_centroid(body), ball_radius());
     }
-    vector_t c = body_get_centroid(ball);
-    if (collisions == MAX_COLLISIONS) {
-      list_t *shape = draw_circle(&c, ball_radius() * 2 / 3);
-      body_t *end = body_init(shape, INFINITY, WHITE);
-      scene_add_body(state->scene, end);
-      list_add(lines, end);
-    } else if (steps % (separation / increment) == separation / increment / 2) {
-      list_t *shape = draw_rectangle(&c, LINE_LENGTH, LINE_WIDTH);
-      body_t *line = body_init(shape, INFINITY, WHITE);
-      body_rotate(line, vec_direction(velocity));
-      scene_add_body(state->scene, line);
-      list_add(lines, line);
+  }
+  vector_t path[MAX_COLLISIONS + 1];
+  size_t points =
+      trajectory_predict(trajectory, axis, MAX_COLLISIONS - 1, path);
+
+  // Dashes every LINE_SEPARATION along the path, carrying on around bounces.
+  // They are only drawn, so they are overlays rather than bodies.
+  double travelled = 0;
+  double next_line = LINE_OFFSET;
+  for (size_t i = 1; i < points; i++) {
+    vector_t leg = vec_subtract(path[i], path[i - 1]);
+    double length = vec_magnitude(leg);
+    for (; next_line < travelled + length; next_line += LINE_SEPARATION) {
+      vector_t c = vec_add(
+          path[i - 1], vec_multiply((next_line - travelled) / length, leg));
+      scene_add_overlay(state->scene,
+                        (overlay_t){.kind = OVERLAY_RECTANGLE,
+                                    .center = c,
+                                    .size = {LINE_LENGTH, LINE_WIDTH},
+                                    .angle = vec_direction(leg),
+                                    .color = WHITE,
+                                    .layer = GUIDE_LAYER});
     }
-    steps++;
+    travelled += length;
+  }
+  if (points > 1) {
+    scene_add_overlay(state->scene,
+                      (overlay_t){.kind = OVERLAY_CIRCLE,
+                                  .center = path[points - 1],
+                                  .size = {ball_radius() * 2 / 3, 0},
+                                  .color = WHITE,
+                                  .layer = GUIDE_LAYER});
   }
-  state->dotted_lines = lines;
 }
 
 void remove_dotted_lines(state_t *state) {
-  if (state->dotted_lines == NULL) {
-    return;
-  }
-  for (int i = 0; i < list_size(state->dotted_lines); i++) {
-    body_remove((body_t *)list_get(state->dotted_lines, i));
-  }
-  list_free(state->dotted_lines);
-  state->dotted_lines = NULL;
+  scene_clear_overlays(state->scene);
 }
 
 void cue_collision_handler(body_t *cue, body_t *ball, vector_t axis,
@@ -729,8 +811,17 @@ void ball_collision_handler(body_t *body1, body_t *body2, vector_t axis,
   }
 }
 
+void wall_collision_handler(body_t *wall, body_t *ball, vector_t axis,
+                            void *aux) {
+  vector_t v1 = body_get_velocity(wall);
+  vector_t v2 = body_get_velocity(ball);
+  double J = body_get_mass(ball) * (1 + B_W_ELASTICITY) *
+             vec_dot(vec_subtract(v2, v1), axis);
+  body_add_impulse(ball, vec_multiply(-J, axis));
+}
+
 void sound_handler(sound_set_t *sound_set, body_t *body1, body_t *body2) {
-  if (!sound_set_get_muted(sound_set)) {
+  if (sound_set != NULL && !sound_set_get_muted(sound_set)) {
     int *info1 = body_get_info(body1);
     int *info2 = body_get_info(body2);
     if (*info1 == CUE_INFO || *info2 == CUE_INFO) {
@@ -748,42 +839,25 @@ void sound_handler(sound_set_t *sound_set, body_t *body1, body_t *body2) {
 void apply_forces(state_t *state) {
   size_t body_count = scene_bodies(state->scene);
   for (size_t i = 0; i < body_count; i++) {
-    body_t *body1 = scene_get_body(state->scene, i);
-    int *info1 = body_get_info(body1);
-    if (*info1 <= BLACK_INFO) {
-      create_gravity_friction(state->scene, MU * G, body1);
-    }
-
-    for (size_t j = i + 1; j < body_count; j++) {
-      body_t *body2 = scene_get_body(state->scene, j);
-      int *info2 = body_get_info(body2);
-
-      if (*info1 == CUE_BALL_INFO &&
-          *info2 == CUE_INFO) { // create physics for cue (only should interact
-                                // with cue ball)
-        create_collision_with_sound(state->scene, state->cue, state->cue_ball,
-                                    cue_collision_handler, sound_handler, state,
-                                    NULL);
-      } else if (*info1 <= BLACK_INFO) { // create physics for balls
-        if (*info2 <= BLACK_INFO) {
-          create_collision_with_sound(state->scene, body1, body2,
-                                      ball_collision_handler, sound_handler,
-                                      state, NULL);
-        }
-      } else if (*info1 == WALL_INFO) { // create physics for walls
-        if (*info2 <= BLACK_INFO) {
-          create_physics_collision_with_sound(state->scene, B_W_ELASTICITY,
-                                              body1, body2, sound_handler);
-        }
-      } else if (*info1 == POCKET_INFO) { // create physics for pockets
-        if (*info2 <= BLACK_INFO) {
-          create_collision_with_sound(state->scene, body1, body2,
-                                      pocket_collision_handler, sound_handler,
-                                      state, NULL);
-        }
-      }
+    body_t *body = scene_get_body(state->scene, i);
+    int *info = body_get_info(body);
+    if (info != NULL && *info <= BLACK_INFO) {
+      create_gravity_friction(state->scene, MU * G, body);
     }
   }
+
+  scene_add_collision_handler(state->scene, 1 << CUE_INFO, 1 << CUE_BALL_INFO,
+                              cue_collision_handler, sound_handler, state,
+                              NULL);
+  scene_add_collision_handler(state->scene, BALL_TYPES, BALL_TYPES,
+                              ball_collision_handler, sound_handler, state,
+                              NULL);
+  scene_add_collision_handler(state->scene, 1 << WALL_INFO, BALL_TYPES,
+                              wall_collision_handler, sound_handler, NULL,
+                              NULL);
+  scene_add_collision_handler(state->scene, 1 << POCKET_INFO, BALL_TYPES,
+                              pocket_collision_handler, sound_handler, state,
+                              NULL);
 }
 
 void game_state_toggle_mute(state_t *state) {
@@ -791,20 +865,16 @@ void game_state_toggle_mute(state_t *state) {
   if (sound_set_get_muted(scene_get_sound_set(state->scene))) {
     image_path = "assets/MuteButtonON.png";
   }
-  SDL_Texture *image = sdl_load_image(image_path);
+  sprite_t *image = sdl_load_image(image_path);
   body_set_image(state->mute_button, image);
+  // The mute button is in the background
+  sdl_invalidate_background();
 }
 
-void game_state_init(state_t *state) {
-  state->scene = scene_init_with_audio("assets/BackgroundJazz_Quiet.wav");
-  scene_add_sound_set(state->scene, "assets/BallBallCollision-[CROPPED_2].wav",
-                      "assets/CueBallCollision-[CROPPED_2].wav",
-                      "assets/PocketBallCollision-[CROPPED_2].wav",
-                      "assets/WallBallCollision-[CROPPED_2].wav");
+void game_state_reset(state_t *state) {
   state->goto_next_state = false;
   state->flags = SET_CUE_BALL | CUE_HIT;
   state->in_alt_state = false;
-  state->dotted_lines = NULL;
   state->player = 0;
   state->scores[0] = 0;
   state->scores[1] = 0;
@@ -817,6 +887,19 @@ void game_state_init(state_t *state) {
   state->training_lines = true;
   state->chalk[0] = 1;
   state->chalk[1] = 1;
+}
+
+void game_state_init(state_t *state) {
+  state->scene = scene_init_with_audio("assets/BackgroundJazz_Quiet.wav");
+  state->trajectory = NULL;
+  scene_add_sound_set(state->scene, "assets/BallBallCollision-[CROPPED_2].wav",
+                      "assets/CueBallCollision-[CROPPED_2].wav",
+                      "assets/PocketBallCollision-[CROPPED_2].wav",
+                      "assets/WallBallCollision-[CROPPED_2].wav");
+  sdl_pack_images(TABLE_SPRITES, TABLE_SPRITE_COUNT);
+  // The new scene's background hasn't been drawn yet
+  sdl_invalidate_background();
+  game_state_reset(state);
   create_semicircle(state);
   create_floor(state);
   create_table(state);
@@ -829,4 +912,21 @@ void game_state_init(state_t *state) {
   create_slider(state);
   create_cue(state);
   apply_forces(state);
-}
\ No newline at end of file
+}
+
+void game_state_init_headless(state_t *state) {
+  state->scene = scene_init();
+  state->trajectory = NULL;
+  game_state_reset(state);
+  state->semicircle = NULL;
+  state->cue = NULL;
+  state->slider = NULL;
+  state->reset_button = NULL;
+  state->mute_button = NULL;
+  state->start_button = NULL;
+  state->rules_button = NULL;
+  create_edges(state);
+  create_pockets(state);
+  create_balls(state);
+  apply_forces(state);
+}
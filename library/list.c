@@ -2,39 +2,63 @@
 #include <assert.h>
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 
 typedef struct list {
   size_t capacity;
   size_t length;
   void **array;
   void (*freer)(void *);
+  allocator_t allocator;
 } list_t;
 
-list_t *list_init(size_t initial_size, free_func_t freer) {
+void *malloc_alloc(void *context, size_t size) { return malloc(size); }
+
+void malloc_release(void *context, void *block) { free(block); }
+
+allocator_t malloc_allocator(void) {
+  return (allocator_t){malloc_alloc, malloc_release, NULL};
+}
+
+list_t *list_init_with_allocator(size_t initial_size, free_func_t freer,
+                                 allocator_t allocator) {
   initial_size = initial_size ? initial_size : 1;
-  list_t *list = malloc(sizeof(list_t));
+  list_t *list = allocator.alloc(allocator.context, sizeof(list_t));
   assert(list != NULL);
-  list->array = malloc(initial_size * sizeof(void *));
+  list->array =
+      allocator.alloc(allocator.context, initial_size * sizeof(void *));
   assert(list->array != NULL);
   list->length = 0;
   list->capacity = initial_size;
   list->freer = freer;
+  list->allocator = allocator;
   return list;
 }
 
+list_t *list_init(size_t initial_size, free_func_t freer) {
+  return list_init_with_allocator(initial_size, freer, malloc_allocator());
+}
+
 void list_free(list_t *list) {
   if (list->freer != NULL) {
     for (size_t i = 0; i < list->length; i++) {
       list->freer(list->array[i]);
     }
   }
-  free(list->array);
-  free(list);
+  allocator_t allocator = list->allocator;
+  allocator.release(allocator.context, list->array);
+  allocator.release(allocator.context, list);
 }
 
 void resize(list_t *list) {
   if (list->length >= list->capacity) {
-    list->array = realloc(list->array, 2 * list->capacity * sizeof(void *));
+    allocator_t allocator = list->allocator;
+    void **array =
+        allocator.alloc(allocator.context, 2 * list->capacity * sizeof(void *));
+    assert(array != NULL);
+    memcpy(array, list->array, list->length * sizeof(void *));
+    allocator.release(allocator.context, list->array);
+    list->array = array;
     list->capacity *= 2;
   }
 }
@@ -75,4 +99,29 @@ void *list_remove(list_t *list, size_t index) {
   list->array[list->length - 1] = NULL;
   list->length--;
   return v;
-}
\ No newline at end of file
+}
+
+void *list_swap_remove(list_t *list, size_t index) {
+  assert(list->length && index < list->length);
+  void *v = list->array[index];
+  list->length--;
+  list->array[index] = list->array[list->length];
+  list->array[list->length] = NULL;
+  return v;
+}
+
+size_t list_filter(list_t *list, bool (*keep)(void *value, void *aux),
+                   void *aux) {
+  size_t kept = 0;
+  for (size_t i = 0; i < list->length; i++) {
+    if (keep(list->array[i], aux)) {
+      list->array[kept++] = list->array[i];
+    }
+  }
+  size_t removed = list->length - kept;
+  for (size_t i = kept; i < list->length; i++) {
+    list->array[i] = NULL;
+  }
+  list->length = kept;
+  return removed;
+}
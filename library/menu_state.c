@@ -12,7 +12,7 @@ void create_rules_page(state_t *state) {
                                              // image (placeholder).
   // i'll load an image with the rules and text once we have the rules
   // incorporated in gameplay so i know which ones to actually write down.
-  SDL_Texture *image = sdl_load_image(image_path);
+  sprite_t *image = sdl_load_image(image_path);
   body_t *page = body_init_with_info_and_sprite(shape, CUE_MASS, MAGENTA, NULL,
                                                 image, free);
   scene_add_body(state->scene, page);
@@ -57,7 +57,7 @@ void create_start_button(state_t *state) {
   vector_t centroid = (vector_t)start_button_pos();
   list_t *shape = draw_rectangle(&centroid, BUTTON_WIDTH, BUTTON_HEIGHT);
   char *image_path = "assets/GameButton.png";
-  SDL_Texture *image = sdl_load_image(image_path);
+  sprite_t *image = sdl_load_image(image_path);
   state->start_button =
       body_init_with_info_and_sprite(shape, INFINITY, GREEN, NULL, image, free);
   body_set_dimensions(state->start_button,
@@ -69,7 +69,7 @@ void create_rules_button(state_t *state) {
   vector_t centroid = (vector_t)rules_button_pos();
   list_t *shape = draw_rectangle(&centroid, BUTTON_WIDTH, BUTTON_HEIGHT);
   char *image_path = "assets/RulesButton.png";
-  SDL_Texture *image = sdl_load_image(image_path);
+  sprite_t *image = sdl_load_image(image_path);
   state->rules_button =
       body_init_with_info_and_sprite(shape, INFINITY, BROWN, NULL, image, free);
   body_set_dimensions(state->rules_button,
@@ -85,7 +85,7 @@ void create_background(state_t *state) {
   list_t *shape = draw_quadrilateral(p1, p2, p3, p4);
   info_t *info = malloc(sizeof(info));
   char *image_path = "assets/MenuFloor.png";
-  SDL_Texture *image = sdl_load_image(image_path);
+  sprite_t *image = sdl_load_image(image_path);
   body_t *floor = body_init_with_info_and_sprite(shape, CUE_MASS, MAGENTA, NULL,
                                                  image, free);
   body_set_dimensions(floor, MAX_POS);
@@ -97,6 +97,7 @@ state_t *menu_state_init() {
   state_t *state = malloc(sizeof(state_t));
   sdl_init_with_title(TITLE, MIN_POS, MAX_POS);
   state->scene = scene_init();
+  state->trajectory = NULL;
   state->goto_next_state = false;
   state->in_alt_state = false;
   create_background(state);
@@ -53,11 +53,13 @@ void polygon_translate(list_t *polygon, vector_t translation) {
 }
 
 void polygon_rotate(list_t *polygon, double angle, vector_t point) {
+  // The vertices aren't packed into arrays, so rotate each one, but only
+  // find the cosine and sine once
+  double c = cos(angle), s = sin(angle);
   for (size_t i = 0; i < list_size(polygon); i++) {
-    *(vector_t *)list_get(polygon, i) = vec_add(
-        vec_rotate(vec_subtract(*(vector_t *)list_get(polygon, i), point),
-                   angle),
-        point);
+    vector_t *vertex = list_get(polygon, i);
+    double dx = vertex->x - point.x, dy = vertex->y - point.y;
+    *vertex = (vector_t){dx * c - dy * s + point.x, dx * s + dy * c + point.y};
   }
 }
 
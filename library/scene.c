@@ -1,27 +1,168 @@
 #include "scene.h"
+#include "aabb_tree.h"
+#include "collision.h"
 #include "sound_set.h"
 #include <SDL2/SDL_mixer.h>
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 const int INITIAL_SIZE = 20;
+// How much memory the scene's arena gets at a time, enough for a table of
+// bodies in one go
+const size_t SCENE_ARENA_CHUNK = 65536;
 const int INITIAL_FORCE_NUM = 10;
+const size_t INITIAL_TERMS = 16;
 
 const int STD_FREQUENCY = 44100;
 const int STD_CHANNELS = 2;
 const int STD_CHUNKSIZE = 2048;
+// Frames longer than this are cut short, so a stall (e.g. a backgrounded tab)
+// doesn't make the next frame run a long burst of ticks to catch up
+const double MAX_FRAME_TIME = 0.25;
+// The most times scene_tick() stops early for an impact before it gives up
+// and ticks the rest of the way, so a tick's cost is bounded
+const size_t MAX_SUBSTEPS = 8;
+// How far a circle is moved into what it hits, as a fraction of its radius,
+// so the collision handlers see the two shapes overlapping
+const double CONTACT_SLOP = 0.01;
+// How much the broad phase fattens a moving body's box on every side, as a
+// fraction of its longest side, so a slow body keeps its leaf for many ticks
+const double FAT_MARGIN = 0.25;
+// How many ticks of its velocity a moving body's box is stretched along
+const double FAT_LOOKAHEAD = 4;
+// Marks the end of the list of free body slots
+const size_t NO_SLOT = SIZE_MAX;
 
 typedef struct {
   force_creator_t forcer;
   void *aux;
   list_t *bodies;
   free_func_t freer;
+  size_t index; // where the force is in the scene's list of forces
 } force_t;
 
+/**
+ * Every term of one typed force, packed together. A removed term leaves a
+ * hole, with a NULL body1, which the next term added fills, so terms never
+ * move and their bodies' references to them stay valid. active is where the
+ * terms applied in a tick are gathered before the kernel is called.
+ */
+typedef struct {
+  force_kernel_t kernel;
+  force_term_t *terms, *active;
+  size_t count, capacity;
+  size_t *holes; // the indices of the holes
+  size_t hole_count;
+} force_batch_t;
+
+// Where one of a body's typed force terms is
+typedef struct {
+  force_batch_t *batch;
+  size_t index;
+} term_ref_t;
+
+typedef struct {
+  unsigned int types1, types2;
+  collision_handler_t handler;
+  collision_sound_handler_t sound_handler;
+  void *aux;
+  free_func_t freer;
+} collision_entry_t;
+
+/**
+ * Where a body is in the broad phase. A fixed body has infinite mass and
+ * hasn't moved since it was put in the static tree, whose leaves are never
+ * refit. Every other body is in the dynamic tree.
+ */
+typedef struct {
+  body_t *body;
+  size_t leaf;
+  bool fixed;
+  // Whether the leaf is new or has been put back in its tree since the
+  // broad phase last looked for pairs
+  bool moved;
+  vector_t centroid; // where a fixed body was when it was put in the tree
+  // The body's place in the scene's list of bodies, and its slot
+  size_t index, slot;
+  // The forces and typed force terms on the body, so they can be found
+  // without a search when it is removed
+  list_t *forces; // NULL until there are any
+  term_ref_t *terms;
+  size_t term_count, term_capacity;
+  // Whether the body is being removed, so its pairs are dropped
+  bool removed;
+} proxy_t;
+
+/**
+ * Where a body_handle_t points. The generation goes up each time the slot's
+ * body is removed, so old handles to the slot no longer match it.
+ */
+typedef struct {
+  proxy_t *proxy; // NULL if the slot is free
+  size_t generation;
+  size_t next_free;
+} body_slot_t;
+
+/**
+ * Two leaves whose boxes overlapped when one of them last moved. Leaves'
+ * boxes only change when they move, so they overlap until one moves again.
+ */
+typedef struct {
+  proxy_t *proxy1, *proxy2;
+} proxy_pair_t;
+
+/**
+ * A pair of bodies which collided during the last tick,
+ * so their handler should not be called again until they separate.
+ */
+typedef struct {
+  collision_entry_t *entry;
+  body_t *body1, *body2;
+  bool touching;
+} contact_t;
+
 typedef struct scene {
+  // Where the scene, its lists, forces and contacts are allocated from
+  arena_t *arena;
   list_t *bodies;
   list_t *forces;
-  double time;
+  list_t *force_batches;
+  list_t *collision_entries;
+  list_t *contacts;
+  unsigned int collision_types; // every type matched by a collision entry
+  // Spatial index for the broad phase and queries, over the bodies with a
+  // type. Each body's proxy holds its place in the trees, and is brought up
+  // to date at the start of each sweep and query.
+  aabb_tree_t *static_tree, *dynamic_tree;
+  // Each body's slot, which holds its proxy, and the first free slot
+  body_slot_t *slots;
+  size_t slot_count, slot_capacity, first_free;
+  // The proxies of the bodies being freed at the end of a tick
+  list_t *removed;
+  // Whether a force was added on a body not (yet) in the scene, so isn't in
+  // its reverse index, and removing bodies must check every force
+  bool unindexed;
+  // Every pair of overlapping leaves, except pairs of fixed bodies
+  proxy_pair_t *pairs;
+  size_t pair_count, pair_capacity;
+  // Whether any leaf has moved since the pairs were found
+  bool moved;
+  // Whether a sweep is going through the pairs, so they mustn't change
+  bool sweeping;
+  // The earliest impact found by the sweep in progress
+  double impact_time;
+  // How many bodies were awake and moving at the end of the last tick, plus
+  // those set moving since (see body_set_awake_count())
+  size_t awake;
+  double time, dt;
+  // Wall-clock time not yet simulated by scene_advance()
+  double accumulator, step_dt;
+  // The shapes drawn over the scene, ordered by layer
+  overlay_t *overlays;
+  size_t overlay_count, overlay_capacity;
   Mix_Music *music;
   sound_set_t *sound_set;
 } scene_t;
@@ -31,23 +172,69 @@ void force_free(force_t *force) {
     force->freer(force->aux);
   }
   list_free(force->bodies);
-  free(force);
+  arena_release(force);
 }
 
-scene_t *scene_init_with_audio(const char *music_path) {
-  scene_t *scene = malloc(sizeof(scene_t));
-  scene->bodies = list_init(INITIAL_SIZE, (free_func_t)body_free);
-  scene->forces = list_init(INITIAL_FORCE_NUM, (free_func_t)force_free);
+void collision_entry_free(collision_entry_t *entry) {
+  if (entry->freer != NULL) {
+    entry->freer(entry->aux);
+  }
+  arena_release(entry);
+}
+
+scene_t *scene_init(void) {
+  arena_t *arena = arena_init(SCENE_ARENA_CHUNK);
+  allocator_t allocator = arena_allocator(arena);
+  scene_t *scene = arena_alloc(arena, sizeof(scene_t));
+  scene->arena = arena;
+  // The batches, contacts and proxies are all in the arena, so nothing needs
+  // to be done to free them when the scene is freed
+  scene->bodies =
+      list_init_with_allocator(INITIAL_SIZE, (free_func_t)body_free, allocator);
+  scene->forces = list_init_with_allocator(
+      INITIAL_FORCE_NUM, (free_func_t)force_free, allocator);
+  scene->force_batches =
+      list_init_with_allocator(INITIAL_FORCE_NUM, NULL, allocator);
+  scene->collision_entries = list_init_with_allocator(
+      INITIAL_FORCE_NUM, (free_func_t)collision_entry_free, allocator);
+  scene->contacts =
+      list_init_with_allocator(INITIAL_FORCE_NUM, NULL, allocator);
+  scene->collision_types = 0;
+  scene->static_tree = aabb_tree_init(0);
+  scene->dynamic_tree = aabb_tree_init(FAT_MARGIN);
+  scene->slots = NULL;
+  scene->slot_count = 0;
+  scene->slot_capacity = 0;
+  scene->first_free = NO_SLOT;
+  scene->removed = list_init_with_allocator(INITIAL_SIZE, NULL, allocator);
+  scene->unindexed = false;
+  scene->pairs = NULL;
+  scene->pair_count = 0;
+  scene->pair_capacity = 0;
+  scene->moved = false;
+  scene->sweeping = false;
+  scene->impact_time = INFINITY;
+  scene->awake = 0;
   scene->time = 0;
+  scene->dt = 0;
+  scene->accumulator = 0;
+  scene->step_dt = 0;
+  scene->overlays = NULL;
+  scene->overlay_count = 0;
+  scene->overlay_capacity = 0;
+  scene->music = NULL;
   scene->sound_set = NULL;
+  return scene;
+}
+
+scene_t *scene_init_with_audio(const char *music_path) {
+  scene_t *scene = scene_init();
   Mix_OpenAudio(STD_FREQUENCY, MIX_DEFAULT_FORMAT, STD_CHANNELS, STD_CHUNKSIZE);
   scene->music = Mix_LoadMUS(music_path);
   Mix_PlayMusic(scene->music, -1);
   return scene;
 }
 
-scene_t *scene_init(void) { return scene_init_with_audio(NULL); }
-
 void scene_add_sound_set(scene_t *scene, const char *bb_path,
                          const char *cb_path, const char *pb_path,
                          const char *wb_path) {
@@ -56,24 +243,188 @@ void scene_add_sound_set(scene_t *scene, const char *bb_path,
 }
 
 void scene_free(scene_t *scene) {
+  // Only what the scene holds for others needs freeing one at a time; the
+  // rest goes with the arena
   list_free(scene->bodies);
   list_free(scene->forces);
+  list_free(scene->collision_entries);
+  aabb_tree_free(scene->static_tree);
+  aabb_tree_free(scene->dynamic_tree);
   if (scene->sound_set != NULL) {
     sound_set_free(scene->sound_set);
   }
-  Mix_FreeMusic(scene->music);
-  Mix_Quit();
-  free(scene);
+  if (scene->music != NULL) {
+    Mix_FreeMusic(scene->music);
+    Mix_Quit();
+  }
+  arena_free(scene->arena);
 }
 
+arena_t *scene_get_arena(scene_t *scene) { return scene->arena; }
+
 size_t scene_bodies(scene_t *scene) { return list_size(scene->bodies); }
 
 body_t *scene_get_body(scene_t *scene, size_t index) {
   return list_get(scene->bodies, index);
 }
 
+unsigned int type_bit(body_t *body) {
+  int type = body_get_type(body);
+  return type < 0 ? 0 : 1u << type;
+}
+
+// Whether a body belongs in the scene's trees
+bool in_tree(body_t *body) {
+  return type_bit(body) != 0 && !body_is_removed(body);
+}
+
+aabb_tree_t *proxy_tree(scene_t *scene, proxy_t *proxy) {
+  return proxy->fixed ? scene->static_tree : scene->dynamic_tree;
+}
+
+// Puts a body in the tree it belongs in, with the given box
+void insert_proxy(scene_t *scene, proxy_t *proxy, aabb_t box) {
+  body_t *body = proxy->body;
+  proxy->fixed = body_get_mass(body) == INFINITY &&
+                 vec_is_equal(body_get_velocity(body), VEC_ZERO);
+  proxy->centroid = body_get_centroid(body);
+  proxy->leaf = aabb_tree_insert(proxy_tree(scene, proxy), box, proxy);
+  proxy->moved = true;
+  scene->moved = true;
+}
+
+// Takes a body out of its tree, leaving its pairs to be dropped
+void remove_leaf(scene_t *scene, proxy_t *proxy) {
+  aabb_tree_remove(proxy_tree(scene, proxy), proxy->leaf);
+  proxy->leaf = AABB_TREE_NONE;
+  proxy->moved = false;
+}
+
+// Takes a body out of its tree and forgets its pairs
+void remove_proxy(scene_t *scene, proxy_t *proxy) {
+  if (proxy->leaf == AABB_TREE_NONE) {
+    return;
+  }
+  remove_leaf(scene, proxy);
+  size_t kept = 0;
+  for (size_t i = 0; i < scene->pair_count; i++) {
+    proxy_pair_t pair = scene->pairs[i];
+    if (pair.proxy1 != proxy && pair.proxy2 != proxy) {
+      scene->pairs[kept++] = pair;
+    }
+  }
+  scene->pair_count = kept;
+}
+
+// Gives a body a slot, reusing a free one if there is one
+size_t add_slot(scene_t *scene, proxy_t *proxy) {
+  size_t slot = scene->first_free;
+  if (slot != NO_SLOT) {
+    scene->first_free = scene->slots[slot].next_free;
+  } else {
+    if (scene->slot_count == scene->slot_capacity) {
+      size_t old_bytes = scene->slot_capacity * sizeof(body_slot_t);
+      scene->slot_capacity =
+          scene->slot_capacity == 0 ? INITIAL_SIZE : 2 * scene->slot_capacity;
+      scene->slots =
+          arena_realloc(scene->arena, scene->slots, old_bytes,
+                        scene->slot_capacity * sizeof(body_slot_t));
+    }
+    slot = scene->slot_count++;
+    scene->slots[slot].generation = 0;
+  }
+  scene->slots[slot].proxy = proxy;
+  return slot;
+}
+
+// Frees a body's slot, so handles to it no longer find anything
+void free_slot(scene_t *scene, size_t slot) {
+  scene->slots[slot].proxy = NULL;
+  scene->slots[slot].generation++;
+  scene->slots[slot].next_free = scene->first_free;
+  scene->first_free = slot;
+}
+
+// Gets the proxy of a body known to be in the scene
+proxy_t *get_proxy(scene_t *scene, body_t *body) {
+  return scene->slots[body_get_slot(body)].proxy;
+}
+
+// Gets the proxy of a body in the scene, or NULL if the body isn't in it
+proxy_t *find_proxy(scene_t *scene, body_t *body) {
+  size_t slot = body_get_slot(body);
+  if (slot >= scene->slot_count) {
+    return NULL;
+  }
+  proxy_t *proxy = scene->slots[slot].proxy;
+  return proxy != NULL && proxy->body == body ? proxy : NULL;
+}
+
 void scene_add_body(scene_t *scene, body_t *body) {
+  proxy_t *proxy = arena_alloc(scene->arena, sizeof(proxy_t));
+  proxy->body = body;
+  proxy->leaf = AABB_TREE_NONE;
+  proxy->fixed = false;
+  proxy->moved = false;
+  proxy->index = list_size(scene->bodies);
+  proxy->slot = add_slot(scene, proxy);
+  proxy->forces = NULL;
+  proxy->terms = NULL;
+  proxy->term_count = 0;
+  proxy->term_capacity = 0;
+  proxy->removed = false;
+  body_set_slot(body, proxy->slot);
+  body_set_awake_count(body, &scene->awake);
   list_add(scene->bodies, body);
+  scene->awake += !body_is_asleep(body);
+  // A body added during a sweep joins the trees after it
+  if (!scene->sweeping && in_tree(body)) {
+    insert_proxy(scene, proxy, body_get_bounds(body));
+  }
+}
+
+body_handle_t scene_get_handle(scene_t *scene, body_t *body) {
+  proxy_t *proxy = find_proxy(scene, body);
+  assert(proxy != NULL);
+  return (body_handle_t){proxy->slot, scene->slots[proxy->slot].generation};
+}
+
+body_t *scene_get_handle_body(scene_t *scene, body_handle_t handle) {
+  if (handle.slot >= scene->slot_count) {
+    return NULL;
+  }
+  body_slot_t slot = scene->slots[handle.slot];
+  return slot.proxy != NULL && slot.generation == handle.generation
+             ? slot.proxy->body
+             : NULL;
+}
+
+void scene_add_overlay(scene_t *scene, overlay_t overlay) {
+  if (scene->overlay_count == scene->overlay_capacity) {
+    size_t old_bytes = scene->overlay_capacity * sizeof(overlay_t);
+    scene->overlay_capacity = scene->overlay_capacity == 0
+                                  ? INITIAL_SIZE
+                                  : 2 * scene->overlay_capacity;
+    scene->overlays =
+        arena_realloc(scene->arena, scene->overlays, old_bytes,
+                      scene->overlay_capacity * sizeof(overlay_t));
+  }
+  // Keep the overlays in layer order, after any already in the same layer
+  size_t index = scene->overlay_count++;
+  while (index > 0 && scene->overlays[index - 1].layer > overlay.layer) {
+    scene->overlays[index] = scene->overlays[index - 1];
+    index--;
+  }
+  scene->overlays[index] = overlay;
+}
+
+void scene_clear_overlays(scene_t *scene) { scene->overlay_count = 0; }
+
+size_t scene_overlays(scene_t *scene) { return scene->overlay_count; }
+
+const overlay_t *scene_get_overlay(scene_t *scene, size_t index) {
+  assert(index < scene->overlay_count);
+  return &scene->overlays[index];
 }
 
 void scene_remove_body(scene_t *scene, size_t index) {
@@ -84,80 +435,827 @@ void scene_remove_body(scene_t *scene, size_t index) {
 
 void scene_add_force_creator(scene_t *scene, force_creator_t forcer, void *aux,
                              free_func_t freer) {
-  scene_add_bodies_force_creator(scene, forcer, aux, list_init(0, NULL), freer);
+  scene_add_bodies_force_creator(
+      scene, forcer, aux,
+      list_init_with_allocator(0, NULL, arena_allocator(scene->arena)), freer);
 }
 
 void scene_add_bodies_force_creator(scene_t *scene, force_creator_t forcer,
                                     void *aux, list_t *bodies,
                                     free_func_t freer) {
-  force_t *force = malloc(sizeof(force_t));
+  force_t *force = arena_alloc(scene->arena, sizeof(force_t));
   force->forcer = forcer;
   force->aux = aux;
   force->bodies = bodies;
   force->freer = freer;
+  force->index = list_size(scene->forces);
   list_add(scene->forces, force);
+  for (size_t i = 0; i < list_size(bodies); i++) {
+    proxy_t *proxy = find_proxy(scene, list_get(bodies, i));
+    if (proxy == NULL) {
+      scene->unindexed = true;
+      continue;
+    }
+    if (proxy->forces == NULL) {
+      proxy->forces =
+          list_init_with_allocator(1, NULL, arena_allocator(scene->arena));
+    }
+    list_add(proxy->forces, force);
+  }
 }
 
-void scene_tick(scene_t *scene, double dt) {
-  scene->time += dt;
+// Records that a term is on a body, so it is removed with the body
+void add_term_ref(scene_t *scene, body_t *body, term_ref_t ref) {
+  proxy_t *proxy = find_proxy(scene, body);
+  if (proxy == NULL) {
+    scene->unindexed = true;
+    return;
+  }
+  if (proxy->term_count == proxy->term_capacity) {
+    size_t old_bytes = proxy->term_capacity * sizeof(term_ref_t);
+    proxy->term_capacity =
+        proxy->term_capacity == 0 ? 1 : 2 * proxy->term_capacity;
+    proxy->terms = arena_realloc(scene->arena, proxy->terms, old_bytes,
+                                 proxy->term_capacity * sizeof(term_ref_t));
+  }
+  proxy->terms[proxy->term_count++] = ref;
+}
+
+// Forgets that a term is on a body
+void remove_term_ref(scene_t *scene, body_t *body, term_ref_t ref) {
+  proxy_t *proxy = find_proxy(scene, body);
+  if (proxy == NULL) {
+    return;
+  }
+  for (size_t i = 0; i < proxy->term_count; i++) {
+    if (proxy->terms[i].batch == ref.batch &&
+        proxy->terms[i].index == ref.index) {
+      proxy->terms[i] = proxy->terms[--proxy->term_count];
+      return;
+    }
+  }
+}
+
+force_batch_t *find_force_batch(scene_t *scene, force_kernel_t kernel) {
+  for (size_t i = 0; i < list_size(scene->force_batches); i++) {
+    force_batch_t *batch = list_get(scene->force_batches, i);
+    if (batch->kernel == kernel) {
+      return batch;
+    }
+  }
+  force_batch_t *batch = arena_alloc(scene->arena, sizeof(force_batch_t));
+  batch->kernel = kernel;
+  batch->terms = NULL;
+  batch->active = NULL;
+  batch->count = 0;
+  batch->capacity = 0;
+  batch->holes = NULL;
+  batch->hole_count = 0;
+  list_add(scene->force_batches, batch);
+  return batch;
+}
+
+void scene_add_force_term(scene_t *scene, force_kernel_t kernel,
+                          double constant, body_t *body1, body_t *body2) {
+  force_batch_t *batch = find_force_batch(scene, kernel);
+  size_t index;
+  if (batch->hole_count > 0) {
+    index = batch->holes[--batch->hole_count];
+  } else {
+    if (batch->count == batch->capacity) {
+      size_t old_capacity = batch->capacity;
+      batch->capacity = old_capacity == 0 ? INITIAL_TERMS : 2 * old_capacity;
+      size_t bytes = batch->capacity * sizeof(force_term_t);
+      batch->terms =
+          arena_realloc(scene->arena, batch->terms,
+                        old_capacity * sizeof(force_term_t), bytes);
+      // The active terms are gathered afresh each tick, so aren't copied
+      arena_release(batch->active);
+      batch->active = arena_alloc(scene->arena, bytes);
+      batch->holes = arena_realloc(scene->arena, batch->holes,
+                                   old_capacity * sizeof(size_t),
+                                   batch->capacity * sizeof(size_t));
+    }
+    index = batch->count++;
+  }
+  batch->terms[index] = (force_term_t){body1, body2, constant};
+  term_ref_t ref = {batch, index};
+  add_term_ref(scene, body1, ref);
+  if (body2 != NULL) {
+    add_term_ref(scene, body2, ref);
+  }
+}
+
+void scene_add_collision_handler(scene_t *scene, unsigned int types1,
+                                 unsigned int types2,
+                                 collision_handler_t handler,
+                                 collision_sound_handler_t sound_handler,
+                                 void *aux, free_func_t freer) {
+  collision_entry_t *entry =
+      arena_alloc(scene->arena, sizeof(collision_entry_t));
+  entry->types1 = types1;
+  entry->types2 = types2;
+  entry->handler = handler;
+  entry->sound_handler = sound_handler;
+  entry->aux = aux;
+  entry->freer = freer;
+  list_add(scene->collision_entries, entry);
+  scene->collision_types |= types1 | types2;
+}
+
+contact_t *find_contact(scene_t *scene, collision_entry_t *entry,
+                        body_t *body1, body_t *body2) {
+  for (size_t i = 0; i < list_size(scene->contacts); i++) {
+    contact_t *contact = list_get(scene->contacts, i);
+    if (contact->entry == entry && contact->body1 == body1 &&
+        contact->body2 == body2) {
+      return contact;
+    }
+  }
+  return NULL;
+}
+
+void handle_contact(scene_t *scene, collision_entry_t *entry, body_t *body1,
+                    body_t *body2, vector_t axis) {
+  contact_t *contact = find_contact(scene, entry, body1, body2);
+  if (contact == NULL) {
+    entry->handler(body1, body2, axis, entry->aux);
+    if (entry->sound_handler != NULL) {
+      entry->sound_handler(scene->sound_set, body1, body2);
+    }
+    contact = arena_alloc(scene->arena, sizeof(contact_t));
+    contact->entry = entry;
+    contact->body1 = body1;
+    contact->body2 = body2;
+    list_add(scene->contacts, contact);
+  }
+  contact->touching = true;
+}
+
+// Gets which way round an entry applies to two bodies: forward if body1
+// matches types1, reverse if body2 does
+void entry_matches(collision_entry_t *entry, body_t *body1, body_t *body2,
+                   bool *forward, bool *reverse) {
+  unsigned int bit1 = type_bit(body1), bit2 = type_bit(body2);
+  *forward = (entry->types1 & bit1) && (entry->types2 & bit2);
+  *reverse = (entry->types1 & bit2) && (entry->types2 & bit1);
+}
+
+bool scene_has_collision_handler(scene_t *scene, body_t *body1,
+                                 body_t *body2) {
+  for (size_t i = 0; i < list_size(scene->collision_entries); i++) {
+    bool forward, reverse;
+    entry_matches(list_get(scene->collision_entries, i), body1, body2,
+                  &forward, &reverse);
+    if (forward || reverse) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void collide_pair(scene_t *scene, body_t *body1, body_t *body2) {
+  bool checked = false;
+  collision_info_t collision;
+  for (size_t i = 0; i < list_size(scene->collision_entries); i++) {
+    collision_entry_t *entry = list_get(scene->collision_entries, i);
+    bool forward, reverse;
+    entry_matches(entry, body1, body2, &forward, &reverse);
+    if (!forward && !reverse) {
+      continue;
+    }
+    if (!checked) {
+      collision = find_collision_view(body_get_shape_view(body1),
+                                      body_get_shape_view(body2));
+      checked = true;
+    }
+    if (!collision.collided) {
+      return;
+    }
+    // A sleeping body is woken by whatever hits it
+    body_wake(body1);
+    body_wake(body2);
+    if (forward) {
+      handle_contact(scene, entry, body1, body2, collision.axis);
+    } else {
+      handle_contact(scene, entry, body2, body1, vec_negate(collision.axis));
+    }
+  }
+}
+
+// Finds when two bodies with a collision handler would first collide,
+// keeping the earliest time found so far in scene->impact_time
+void impact_pair(scene_t *scene, body_t *body1, body_t *body2) {
+  vector_t velocity1 = body_get_velocity(body1);
+  vector_t velocity2 = body_get_velocity(body2);
+  if (vec_is_equal(velocity1, velocity2)) {
+    return;
+  }
+  if (!scene_has_collision_handler(scene, body1, body2)) {
+    return;
+  }
+  shape_view_t shape1 = body_get_shape_view(body1);
+  shape_view_t shape2 = body_get_shape_view(body2);
+  double radius = shape1.kind != SHAPE_CIRCLE ? shape2.radius
+                  : shape2.kind != SHAPE_CIRCLE
+                      ? shape1.radius
+                      : fmin(shape1.radius, shape2.radius);
+  double time = find_time_of_impact(shape1, velocity1, shape2, velocity2,
+                                    CONTACT_SLOP * radius, scene->impact_time);
+  // Bodies which already overlap are left to the collision handlers
+  if (time > 0 && time < scene->impact_time) {
+    scene->impact_time = time;
+  }
+}
+
+// Gets a body's bounding box, swept along its velocity for dt
+aabb_t swept_bounds(body_t *body, double dt) {
+  aabb_t box = body_get_bounds(body);
+  vector_t velocity = body_get_velocity(body);
+  if (dt == 0 || vec_is_equal(velocity, VEC_ZERO)) {
+    return box;
+  }
+  vector_t displacement = vec_multiply(dt, velocity);
+  box.min.x += fmin(displacement.x, 0);
+  box.min.y += fmin(displacement.y, 0);
+  box.max.x += fmax(displacement.x, 0);
+  box.max.y += fmax(displacement.y, 0);
+  return box;
+}
+
+void add_pair(scene_t *scene, proxy_t *proxy1, proxy_t *proxy2) {
+  if (scene->pair_count == scene->pair_capacity) {
+    size_t old_bytes = scene->pair_capacity * sizeof(proxy_pair_t);
+    scene->pair_capacity =
+        scene->pair_capacity ? 2 * scene->pair_capacity : INITIAL_SIZE;
+    scene->pairs = arena_realloc(scene->arena, scene->pairs, old_bytes,
+                                 scene->pair_capacity * sizeof(proxy_pair_t));
+  }
+  scene->pairs[scene->pair_count++] = (proxy_pair_t){proxy1, proxy2};
+}
+
+typedef struct {
+  scene_t *scene;
+  proxy_t *proxy;
+  aabb_tree_t *tree; // the tree being searched
+} pair_query_t;
+
+bool pair_leaf(size_t leaf, void *aux) {
+  pair_query_t *query = aux;
+  proxy_t *other = aabb_tree_get_data(query->tree, leaf);
+  // A pair of moved leaves is found by whichever looks for its pairs second
+  if (!other->moved) {
+    add_pair(query->scene, query->proxy, other);
+  }
+  return true;
+}
+
+// Forgets the pairs of each leaf which has moved, then finds its new ones
+void scene_find_pairs(scene_t *scene) {
+  size_t kept = 0;
+  for (size_t i = 0; i < scene->pair_count; i++) {
+    proxy_pair_t pair = scene->pairs[i];
+    if (!pair.proxy1->moved && !pair.proxy2->moved) {
+      scene->pairs[kept++] = pair;
+    }
+  }
+  scene->pair_count = kept;
+  for (size_t i = 0; i < list_size(scene->bodies); i++) {
+    proxy_t *proxy = get_proxy(scene, list_get(scene->bodies, i));
+    if (!proxy->moved) {
+      continue;
+    }
+    aabb_t box = aabb_tree_get_box(proxy_tree(scene, proxy), proxy->leaf);
+    pair_query_t query = {scene, proxy, scene->dynamic_tree};
+    aabb_tree_query(scene->dynamic_tree, box, pair_leaf, &query);
+    if (!proxy->fixed) {
+      query.tree = scene->static_tree;
+      aabb_tree_query(scene->static_tree, box, pair_leaf, &query);
+    }
+    proxy->moved = false;
+  }
+  scene->moved = false;
+}
+
+// Brings the trees up to date with the bodies, making sure each leaf's box
+// holds its body's box swept along its velocity for dt. A fixed body is only
+// checked for having moved. Any other body's leaf is moved when the body
+// leaves its fat box.
+void scene_update_tree(scene_t *scene, double dt) {
+  if (scene->sweeping) {
+    return;
+  }
+  for (size_t i = 0; i < list_size(scene->bodies); i++) {
+    body_t *body = list_get(scene->bodies, i);
+    proxy_t *proxy = get_proxy(scene, body);
+    if (!in_tree(body)) {
+      remove_proxy(scene, proxy);
+      continue;
+    }
+    // Sleeping bodies don't move
+    if (proxy->leaf != AABB_TREE_NONE && body_is_asleep(body)) {
+      continue;
+    }
+    bool in_static_tree = proxy->leaf != AABB_TREE_NONE && proxy->fixed;
+    vector_t velocity = body_get_velocity(body);
+    if (in_static_tree && vec_is_equal(velocity, VEC_ZERO) &&
+        vec_is_equal(body_get_centroid(body), proxy->centroid)) {
+      continue;
+    }
+    aabb_t box = swept_bounds(body, dt);
+    if (proxy->leaf == AABB_TREE_NONE || in_static_tree) {
+      // A fixed body which has moved goes back in whichever tree it now
+      // belongs in
+      remove_proxy(scene, proxy);
+      insert_proxy(scene, proxy, box);
+      continue;
+    }
+    vector_t displacement = vec_multiply(FAT_LOOKAHEAD * scene->dt, velocity);
+    if (aabb_tree_move(scene->dynamic_tree, proxy->leaf, box, displacement)) {
+      proxy->moved = true;
+      scene->moved = true;
+    }
+  }
+  if (scene->moved) {
+    scene_find_pairs(scene);
+  }
+}
+
+typedef void (*pair_handler_t)(scene_t *scene, body_t *body1, body_t *body2);
+
+// Whether a body is paired up by the broad phase
+bool in_sweep(scene_t *scene, body_t *body) {
+  return (type_bit(body) & scene->collision_types) &&
+         body_get_apply_forces(body);
+}
+
+// Calls handler with each pair of bodies with registered types whose bounding
+// boxes overlap, after sweeping each box along its body's velocity for dt.
+// Only pairs of overlapping leaves are checked, so bodies far apart, and
+// pairs of fixed bodies, are never looked at. Nor are pairs of sleeping
+// bodies, which can't start to collide.
+void scene_sweep(scene_t *scene, double dt, pair_handler_t handler) {
+  scene_update_tree(scene, dt);
+  scene->sweeping = true;
+  for (size_t i = 0; i < scene->pair_count; i++) {
+    body_t *body1 = scene->pairs[i].proxy1->body;
+    body_t *body2 = scene->pairs[i].proxy2->body;
+    if ((!body_is_asleep(body1) || !body_is_asleep(body2)) &&
+        in_sweep(scene, body1) && in_sweep(scene, body2) &&
+        aabb_overlap(swept_bounds(body1, dt), swept_bounds(body2, dt))) {
+      handler(scene, body1, body2);
+    }
+  }
+  scene->sweeping = false;
+}
+
+void scene_collide(scene_t *scene) {
+  if (list_size(scene->collision_entries) == 0) {
+    return;
+  }
+  // Pairs of sleeping bodies aren't checked, so they stay touching
+  for (size_t i = 0; i < list_size(scene->contacts); i++) {
+    contact_t *contact = list_get(scene->contacts, i);
+    contact->touching =
+        body_is_asleep(contact->body1) && body_is_asleep(contact->body2);
+  }
+  scene_sweep(scene, 0, collide_pair);
+  // Bodies which skipped this tick keep their contacts until they come back
+  for (size_t i = 0; i < list_size(scene->contacts); i++) {
+    contact_t *contact = list_get(scene->contacts, i);
+    if (!contact->touching && body_get_apply_forces(contact->body1) &&
+        body_get_apply_forces(contact->body2)) {
+      arena_release(list_swap_remove(scene->contacts, i));
+      i--;
+    }
+  }
+}
+
+// Finds the earliest time within dt at which two bodies with a collision
+// handler would start to collide, or INFINITY if none do
+double scene_find_impact(scene_t *scene, double dt) {
+  if (list_size(scene->collision_entries) == 0) {
+    return INFINITY;
+  }
+  scene->impact_time = dt;
+  scene_sweep(scene, dt, impact_pair);
+  return scene->impact_time < dt ? scene->impact_time : INFINITY;
+}
+
+// Wakes body2 if it is asleep and touching body1, which is awake. Bodies of
+// infinite mass can't be pushed, so they are never woken, and walls don't
+// join the bodies touching them into one island.
+bool wake_touching(scene_t *scene, body_t *body1, body_t *body2) {
+  if (body_is_asleep(body1) || !body_is_asleep(body2) ||
+      body_get_mass(body2) == INFINITY) {
+    return false;
+  }
+  body_wake(body2);
+  scene->awake++;
+  return true;
+}
+
+// Wakes every sleeping body touching an awake one, and so on through the
+// bodies touching those, so each island of touching bodies sleeps only once
+// all of it is at rest
+void wake_islands(scene_t *scene) {
+  bool woke;
+  do {
+    woke = false;
+    for (size_t i = 0; i < list_size(scene->contacts); i++) {
+      contact_t *contact = list_get(scene->contacts, i);
+      if (contact->touching) {
+        woke |= wake_touching(scene, contact->body1, contact->body2);
+        woke |= wake_touching(scene, contact->body2, contact->body1);
+      }
+    }
+  } while (woke);
+}
+
+// Whether a typed force's term should be applied this tick: like a force
+// creator, unless any of its bodies skip forces or all of them are asleep
+bool term_applies(const force_term_t *term) {
+  body_t *body2 = term->body2 == NULL ? term->body1 : term->body2;
+  return body_get_apply_forces(term->body1) && body_get_apply_forces(body2) &&
+         (!body_is_asleep(term->body1) || !body_is_asleep(body2));
+}
+
+// Calls each typed force's kernel once with all its terms that apply
+void apply_force_terms(scene_t *scene, double dt) {
+  for (size_t i = 0; i < list_size(scene->force_batches); i++) {
+    force_batch_t *batch = list_get(scene->force_batches, i);
+    size_t count = 0;
+    for (size_t j = 0; j < batch->count; j++) {
+      if (batch->terms[j].body1 != NULL && term_applies(&batch->terms[j])) {
+        batch->active[count++] = batch->terms[j];
+      }
+    }
+    if (count > 0) {
+      batch->kernel(batch->active, count, dt);
+    }
+  }
+}
+
+// Takes a term out of its batch, leaving a hole, and out of its bodies'
+// references to it
+void remove_term(scene_t *scene, term_ref_t ref) {
+  force_term_t *term = &ref.batch->terms[ref.index];
+  remove_term_ref(scene, term->body1, ref);
+  if (term->body2 != NULL) {
+    remove_term_ref(scene, term->body2, ref);
+  }
+  term->body1 = NULL;
+  term->body2 = NULL;
+  ref.batch->holes[ref.batch->hole_count++] = ref.index;
+}
+
+// Takes a force out of the scene and the reverse index of each of its
+// bodies, and frees it
+void remove_force(scene_t *scene, force_t *force) {
+  for (size_t i = 0; i < list_size(force->bodies); i++) {
+    proxy_t *proxy = find_proxy(scene, list_get(force->bodies, i));
+    // A body added after the force isn't in the reverse index
+    if (proxy == NULL || proxy->forces == NULL) {
+      continue;
+    }
+    for (size_t j = 0; j < list_size(proxy->forces); j++) {
+      if (list_get(proxy->forces, j) == force) {
+        list_swap_remove(proxy->forces, j);
+        j--;
+      }
+    }
+  }
+  list_swap_remove(scene->forces, force->index);
+  if (force->index < list_size(scene->forces)) {
+    ((force_t *)list_get(scene->forces, force->index))->index = force->index;
+  }
+  force_free(force);
+}
+
+// Drops the forces and typed force terms on a removed body
+void reap_forces(scene_t *scene, proxy_t *proxy) {
+  while (proxy->forces != NULL && list_size(proxy->forces) > 0) {
+    remove_force(scene, list_get(proxy->forces, 0));
+  }
+  while (proxy->term_count > 0) {
+    remove_term(scene, proxy->terms[proxy->term_count - 1]);
+  }
+}
+
+// Drops every force and term on any removed body, for when some of their
+// bodies aren't in the reverse index
+void reap_unindexed_forces(scene_t *scene) {
   for (size_t i = 0; i < list_size(scene->forces); i++) {
-    force_t *curr = list_get(scene->forces, i);
-    bool apply_force = true;
-    for (size_t j = 0; j < list_size(curr->bodies); j++) {
-      if (!body_get_apply_forces(list_get(curr->bodies, j))) {
-        apply_force = false;
+    force_t *force = list_get(scene->forces, i);
+    for (size_t j = 0; j < list_size(force->bodies); j++) {
+      if (body_is_removed(list_get(force->bodies, j))) {
+        remove_force(scene, force);
+        // The last force has been moved into this one's place
+        i--;
         break;
       }
     }
-    if (apply_force)
-      curr->forcer(curr->aux);
   }
+  for (size_t i = 0; i < list_size(scene->force_batches); i++) {
+    force_batch_t *batch = list_get(scene->force_batches, i);
+    for (size_t j = 0; j < batch->count; j++) {
+      force_term_t term = batch->terms[j];
+      if (term.body1 != NULL &&
+          (body_is_removed(term.body1) ||
+           (term.body2 != NULL && body_is_removed(term.body2)))) {
+        remove_term(scene, (term_ref_t){batch, j});
+      }
+    }
+  }
+}
+
+// Frees the bodies gathered in scene->removed, with everything which depends
+// on them. Their forces and terms are found through their reverse indices,
+// so no other force is looked at.
+void reap_bodies(scene_t *scene) {
+  bool paired = false, touching = false;
+  for (size_t i = 0; i < list_size(scene->removed); i++) {
+    proxy_t *proxy = list_get(scene->removed, i);
+    reap_forces(scene, proxy);
+    touching |= (type_bit(proxy->body) & scene->collision_types) != 0;
+    if (proxy->leaf != AABB_TREE_NONE) {
+      remove_leaf(scene, proxy);
+      paired = true;
+    }
+  }
+  if (scene->unindexed) {
+    reap_unindexed_forces(scene);
+  }
+  // Only bodies with a collision type have contacts
+  for (size_t i = 0; touching && i < list_size(scene->contacts); i++) {
+    contact_t *contact = list_get(scene->contacts, i);
+    if (body_is_removed(contact->body1) || body_is_removed(contact->body2)) {
+      arena_release(list_swap_remove(scene->contacts, i));
+      i--;
+    }
+  }
+  if (paired) {
+    size_t kept = 0;
+    for (size_t i = 0; i < scene->pair_count; i++) {
+      proxy_pair_t pair = scene->pairs[i];
+      if (!pair.proxy1->removed && !pair.proxy2->removed) {
+        scene->pairs[kept++] = pair;
+      }
+    }
+    scene->pair_count = kept;
+  }
+  while (list_size(scene->removed) > 0) {
+    proxy_t *proxy =
+        list_remove(scene->removed, list_size(scene->removed) - 1);
+    free_slot(scene, proxy->slot);
+    body_free(proxy->body);
+    if (proxy->forces != NULL) {
+      list_free(proxy->forces);
+    }
+    arena_release(proxy->terms);
+    arena_release(proxy);
+  }
+}
+
+typedef struct {
+  scene_t *scene;
+  double dt;
+} body_pass_t;
+
+// Ticks a body, or if it has been removed, drops it from the scene's bodies
+// and gathers its proxy in scene->removed, so removing bodies takes no pass
+// over them besides the one which ticks them
+bool tick_body(void *value, void *aux) {
+  body_pass_t *pass = aux;
+  scene_t *scene = pass->scene;
+  body_t *body = value;
+  size_t removed = list_size(scene->removed);
+  if (body_is_removed(body)) {
+    proxy_t *proxy = get_proxy(scene, body);
+    proxy->removed = true;
+    list_add(scene->removed, proxy);
+    return false;
+  }
+  if (removed > 0) {
+    get_proxy(scene, body)->index -= removed;
+  }
+  if (!body_is_asleep(body)) {
+    bool resting = body_is_resting(body);
+    body_tick(body, pass->dt);
+    // Only bodies which collide can be woken by contact, so only they sleep
+    if (resting && in_tree(body)) {
+      body_sleep(body);
+    } else if (!resting) {
+      scene->awake++;
+    }
+  }
+  return true;
+}
+
+// Ticks a scene by dt without looking for impacts within the tick
+void scene_step(scene_t *scene, double dt) {
+  scene->time += dt;
+  scene->dt = dt;
+  apply_force_terms(scene, dt);
   for (size_t i = 0; i < list_size(scene->forces); i++) {
     force_t *curr = list_get(scene->forces, i);
+    // A force on sleeping bodies only is skipped; one on no bodies in
+    // particular always runs
+    bool apply_force = true, awake = list_size(curr->bodies) == 0;
     for (size_t j = 0; j < list_size(curr->bodies); j++) {
-      if (body_is_removed(list_get(curr->bodies, j))) {
-        force_free(list_get(scene->forces, i));
-        list_remove(scene->forces, i);
-        i--;
+      body_t *body = list_get(curr->bodies, j);
+      if (!body_get_apply_forces(body)) {
+        apply_force = false;
         break;
       }
+      awake |= !body_is_asleep(body);
     }
+    if (apply_force && awake)
+      curr->forcer(curr->aux);
   }
+  scene_collide(scene);
+  scene->awake = 0;
+  body_pass_t pass = {scene, dt};
+  if (list_filter(scene->bodies, tick_body, &pass) > 0) {
+    reap_bodies(scene);
+  }
+  wake_islands(scene);
+}
+
+size_t scene_advance(scene_t *scene, double frame_time, double dt) {
+  assert(dt > 0);
+  scene->accumulator += fmin(frame_time, MAX_FRAME_TIME);
+  scene->step_dt = dt;
+  size_t ticks = 0;
+  while (scene->accumulator >= dt) {
+    scene_tick(scene, dt);
+    scene->accumulator -= dt;
+    ticks++;
+  }
+  return ticks;
+}
+
+double scene_get_alpha(scene_t *scene) {
+  return scene->step_dt > 0 ? scene->accumulator / scene->step_dt : 1;
+}
+
+void scene_tick(scene_t *scene, double dt) {
+  // Bodies are drawn moving from where they were before the whole tick, not
+  // just its last step
   for (size_t i = 0; i < list_size(scene->bodies); i++) {
-    body_t *curr = list_get(scene->bodies, i);
-    if (body_is_removed(curr)) {
-      body_free(curr);
-      list_remove(scene->bodies, i);
-      i--;
-    } else {
-      body_tick(curr, dt);
-    }
+    body_save_centroid(list_get(scene->bodies, i));
   }
+  // Stop at each impact, so fast bodies can't pass through each other
+  double remaining = dt;
+  size_t substeps = 0;
+  do {
+    double step = remaining;
+    if (substeps < MAX_SUBSTEPS && remaining > 0) {
+      step = fmin(step, scene_find_impact(scene, remaining));
+    }
+    scene_step(scene, step);
+    remaining -= step;
+    substeps++;
+  } while (remaining > 0);
 }
 
 double scene_get_time(scene_t *scene) { return scene->time; }
 
+double scene_get_dt(scene_t *scene) { return scene->dt; }
+
 void scene_reset_time(scene_t *scene) { scene->time = 0; }
 
 int scene_get_index(scene_t *scene, body_t *body) {
-  for (size_t i = 0; i < scene_bodies(scene); i++) {
-    if (scene_get_body(scene, i) == body) {
-      return i;
-    }
+  proxy_t *proxy = find_proxy(scene, body);
+  return proxy == NULL ? -1 : (int)proxy->index;
+}
+
+bool scene_is_still(scene_t *scene) { return scene->awake == 0; }
+
+typedef struct {
+  aabb_tree_t *tree; // the tree being searched
+  unsigned int types;
+  list_t *bodies;
+  // Only bodies overlapping the shape are kept, unless it is NULL, in which
+  // case only bodies whose boxes overlap box are kept
+  shape_view_t *shape;
+  aabb_t box;
+  vector_t point;
+} query_t;
+
+bool query_leaf(size_t leaf, void *aux) {
+  query_t *query = aux;
+  body_t *body = ((proxy_t *)aabb_tree_get_data(query->tree, leaf))->body;
+  if (!(type_bit(body) & query->types)) {
+    return true;
   }
-  return -1;
+  // The leaves' boxes may be bigger than the bodies'
+  if (query->shape == NULL
+          ? aabb_overlap(query->box, body_get_bounds(body))
+          : find_collision_view(*query->shape, body_get_shape_view(body))
+                .collided) {
+    list_add(query->bodies, body);
+  }
+  return true;
 }
 
-bool scene_is_still(scene_t *scene) {
-  for (size_t i = 0; i < scene_bodies(scene); i++) {
-    body_t *curr = scene_get_body(scene, i);
-    if (!vec_is_within(1e0, body_get_velocity(curr), VEC_ZERO)) {
-      return false;
-    }
+// Brings the trees up to date, then calls handler with each leaf in either
+// whose box overlaps the query's box
+void query_trees(scene_t *scene, tree_query_handler_t handler,
+                 query_t *query) {
+  scene_update_tree(scene, 0);
+  query->tree = scene->static_tree;
+  aabb_tree_query(scene->static_tree, query->box, handler, query);
+  query->tree = scene->dynamic_tree;
+  aabb_tree_query(scene->dynamic_tree, query->box, handler, query);
+}
+
+void scene_query_aabb(scene_t *scene, aabb_t box, unsigned int types,
+                      list_t *bodies) {
+  query_t query = {NULL, types, bodies, NULL, box, VEC_ZERO};
+  query_trees(scene, query_leaf, &query);
+}
+
+void scene_query_shape(scene_t *scene, shape_view_t shape, unsigned int types,
+                       list_t *bodies) {
+  query_t query = {NULL, types, bodies, &shape, find_bounds(shape), VEC_ZERO};
+  query_trees(scene, query_leaf, &query);
+}
+
+bool query_point_leaf(size_t leaf, void *aux) {
+  query_t *query = aux;
+  body_t *body = ((proxy_t *)aabb_tree_get_data(query->tree, leaf))->body;
+  if ((type_bit(body) & query->types) &&
+      shape_contains_point(body_get_shape_view(body), query->point)) {
+    list_add(query->bodies, body);
   }
   return true;
 }
 
+void scene_query_point(scene_t *scene, vector_t point, unsigned int types,
+                       list_t *bodies) {
+  query_t query = {NULL, types, bodies, NULL, {point, point}, point};
+  query_trees(scene, query_point_leaf, &query);
+}
+
+typedef struct {
+  aabb_tree_t *tree; // the tree being searched
+  unsigned int types;
+  vector_t origin, direction;
+  double radius;
+  raycast_hit_t hit;
+} cast_t;
+
+double cast_leaf(size_t leaf, double max_distance, void *aux) {
+  cast_t *cast = aux;
+  body_t *body = ((proxy_t *)aabb_tree_get_data(cast->tree, leaf))->body;
+  if (!(type_bit(body) & cast->types)) {
+    return INFINITY;
+  }
+  vector_t normal;
+  double distance =
+      find_circle_cast(body_get_shape_view(body), cast->origin,
+                       cast->direction, cast->radius, &normal);
+  if (distance > max_distance || distance >= cast->hit.distance) {
+    return INFINITY;
+  }
+  vector_t position =
+      vec_add(cast->origin, vec_multiply(distance, cast->direction));
+  cast->hit = (raycast_hit_t){.body = body,
+                              .position = position,
+                              .normal = normal,
+                              .distance = distance};
+  return distance;
+}
+
+raycast_hit_t scene_circle_cast(scene_t *scene, vector_t origin,
+                                double radius, vector_t direction,
+                                double max_distance, unsigned int types) {
+  scene_update_tree(scene, 0);
+  cast_t cast = {.tree = scene->static_tree,
+                 .types = types,
+                 .origin = origin,
+                 .direction = vec_unit(direction),
+                 .radius = radius,
+                 .hit = {.body = NULL,
+                         .position = VEC_ZERO,
+                         .normal = VEC_ZERO,
+                         .distance = INFINITY}};
+  aabb_tree_raycast(scene->static_tree, origin, cast.direction, radius,
+                    max_distance, cast_leaf, &cast);
+  // Nothing in the other tree beyond the nearest hit so far needs testing
+  cast.tree = scene->dynamic_tree;
+  aabb_tree_raycast(scene->dynamic_tree, origin, cast.direction, radius,
+                    fmin(max_distance, cast.hit.distance), cast_leaf, &cast);
+  return cast.hit;
+}
+
+raycast_hit_t scene_raycast(scene_t *scene, vector_t origin,
+                            vector_t direction, double max_distance,
+                            unsigned int types) {
+  return scene_circle_cast(scene, origin, 0, direction, max_distance, types);
+}
+
 void scene_toggle_muted(scene_t *scene) {
   sound_set_toggle_muted(scene->sound_set);
   if (Mix_PausedMusic()) {
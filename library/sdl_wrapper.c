@@ -4,9 +4,10 @@
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL_mixer.h>
 #include <assert.h>
+#include <limits.h>
 #include <math.h>
 #include <stdlib.h>
-#include <time.h>
+#include <string.h>
 
 const char WINDOW_TITLE[] = "CS 3";
 const int WINDOW_WIDTH = 1200;
@@ -14,6 +15,14 @@ const int WINDOW_HEIGHT = 600;
 const double MS_PER_S = 1e3;
 const double DEFAULT_IMG_SCALE = .6;
 const double DEFAULT_SHADOW_SCALE = 1.4;
+// The width of an atlas, and the most it may grow to downwards, in pixels.
+// WebGL only promises textures up to 4096 pixels across, and this leaves room.
+const int ATLAS_WIDTH = 2048;
+const int ATLAS_MAX_HEIGHT = 2048;
+// The gap left around each image in an atlas, so scaling one never samples
+// the pixels of its neighbours
+const int ATLAS_PADDING = 1;
+const SDL_Color SPRITE_COLOR = {255, 255, 255, 255};
 
 /**
  * The coordinate at the center of the screen.
@@ -50,25 +59,94 @@ uint32_t key_start_timestamp;
  */
 uint32_t click_start_timestamp = 0;
 /**
- * The value of clock() when time_since_last_tick() was last called.
- * Initially 0.
+ * The value of SDL's performance counter when time_since_last_tick() was last
+ * called. Initially 0.
  */
-clock_t last_clock = 0;
+uint64_t last_counter = 0;
 /**
  * The music that will be played during the game.
  */
 // Mix_Music *gMusic = NULL;
 
+/**
+ * Space for a polygon's vertices in pixel coordinates, kept from one polygon
+ * to the next so drawing doesn't allocate.
+ */
+int16_t *x_scratch = NULL, *y_scratch = NULL;
+size_t scratch_size = 0;
+
+/**
+ * An image file loaded as a texture, shared by everything that shows it.
+ */
+typedef struct sprite {
+  char *path;
+  // The texture the image is in, which may be an atlas shared with others
+  SDL_Texture *texture;
+  // Where the image is in the texture, in pixels and as texture coordinates
+  SDL_Rect source;
+  SDL_FPoint uv_min, uv_max;
+  // How many holders, e.g. bodies, have the sprite
+  size_t references;
+} sprite_t;
+
+const size_t INITIAL_CACHED_IMAGES = 16;
+
+/**
+ * The images currently loaded, so each file is decoded once however many
+ * bodies show it.
+ */
+list_t *image_cache = NULL;
+
+/**
+ * Sprites waiting to be drawn by one SDL_RenderGeometry() call, as two
+ * triangles each, since they all come from batch_texture.
+ */
+SDL_Texture *batch_texture = NULL;
+SDL_Vertex *batch_vertices = NULL;
+int *batch_indices = NULL;
+size_t batch_sprites = 0, batch_capacity = 0;
+
+/**
+ * A body to draw in a frame, with what orders it among the others.
+ */
+typedef struct {
+  body_t *body;
+  int layer;
+  size_t index;
+} draw_entry_t;
+
+/**
+ * The bodies being drawn in the order they are drawn in, kept from one frame
+ * to the next so ordering them doesn't allocate.
+ */
+draw_entry_t *draw_order = NULL;
+size_t draw_order_capacity = 0;
+
+/**
+ * The background bodies drawn into a texture the size of the window, which is
+ * copied to the window each frame instead of drawing them again.
+ * background_drawn is cleared by sdl_invalidate_background().
+ */
+SDL_Texture *background_layer = NULL;
+int background_width = 0, background_height = 0;
+bool background_drawn = false;
+// Whether the layer holds any bodies, so is worth copying to the window
+bool background_used = false;
+
+/**
+ * The transform from scene to window coordinates, worked out once per frame
+ * rather than once per body or vertex.
+ */
+typedef struct {
+  vector_t window_center;
+  double scale;
+} render_context_t;
+
 /** Computes the center of the window in pixel coordinates */
 vector_t get_window_center(void) {
-  int *width = malloc(sizeof(*width)), *height = malloc(sizeof(*height));
-  assert(width != NULL);
-  assert(height != NULL);
-  SDL_GetWindowSize(window, width, height);
-  vector_t dimensions = {.x = *width, .y = *height};
-  free(width);
-  free(height);
-  return vec_multiply(0.5, dimensions);
+  int width, height;
+  SDL_GetWindowSize(window, &width, &height);
+  return vec_multiply(0.5, (vector_t){.x = width, .y = height});
 }
 
 /**
@@ -84,16 +162,24 @@ double get_scene_scale(vector_t window_center) {
   return x_scale < y_scale ? x_scale : y_scale;
 }
 
+/** Gets the window's current transform, for drawing a frame */
+render_context_t get_render_context(void) {
+  vector_t window_center = get_window_center();
+  return (render_context_t){window_center, get_scene_scale(window_center)};
+}
+
 /** Maps a scene coordinate to a window coordinate */
-vector_t get_window_position(vector_t scene_pos, vector_t window_center) {
+vector_t get_window_position(const render_context_t *context,
+                             vector_t scene_pos) {
   // Scale scene coordinates by the scaling factor
   // and map the center of the scene to the center of the window
   vector_t scene_center_offset = vec_subtract(scene_pos, center);
-  double scale = get_scene_scale(window_center);
-  vector_t pixel_center_offset = vec_multiply(scale, scene_center_offset);
-  vector_t pixel = {.x = round(window_center.x + pixel_center_offset.x),
-                    // Flip y axis since positive y is down on the screen
-                    .y = round(window_center.y - pixel_center_offset.y)};
+  vector_t pixel_center_offset =
+      vec_multiply(context->scale, scene_center_offset);
+  vector_t pixel = {
+      .x = round(context->window_center.x + pixel_center_offset.x),
+      // Flip y axis since positive y is down on the screen
+      .y = round(context->window_center.y - pixel_center_offset.y)};
   return pixel;
 }
 
@@ -162,13 +248,16 @@ void sdl_init(vector_t min, vector_t max) {
 }
 
 bool sdl_is_done(void *state) {
-  SDL_Event *event = malloc(sizeof(*event));
-  assert(event != NULL);
+  SDL_Event event_storage;
+  SDL_Event *event = &event_storage;
   while (SDL_PollEvent(event)) {
     switch (event->type) {
     case SDL_QUIT:
-      free(event);
       return true;
+    case SDL_RENDER_TARGETS_RESET:
+      // The background layer's pixels have been lost
+      sdl_invalidate_background();
+      break;
     case SDL_KEYDOWN:
     case SDL_KEYUP:
       // Skip the keypress if no handler is configured
@@ -213,7 +302,6 @@ bool sdl_is_done(void *state) {
       break;
     }
   }
-  free(event);
   return false;
 }
 
@@ -222,105 +310,543 @@ void sdl_clear(void) {
   SDL_RenderClear(renderer);
 }
 
-void sdl_draw_polygon(body_t *body) {
+// Makes sure the scratch arrays hold at least n vertices
+void reserve_scratch(size_t n) {
+  if (n <= scratch_size) {
+    return;
+  }
+  scratch_size = n > 2 * scratch_size ? n : 2 * scratch_size;
+  x_scratch = realloc(x_scratch, scratch_size * sizeof(*x_scratch));
+  y_scratch = realloc(y_scratch, scratch_size * sizeof(*y_scratch));
+  assert(x_scratch != NULL);
+  assert(y_scratch != NULL);
+}
+
+// Draws a body's shape shifted by offset, e.g. back to where it was between
+// ticks
+void draw_body_shape(const render_context_t *context, body_t *body,
+                     vector_t offset) {
   rgb_color_t color = body_get_color(body);
   double alpha = body_get_alpha(body);
-  list_t *points = body_get_shape(body);
+  shape_view_t points = body_get_shape_view(body);
   // Check parameters
-  size_t n = list_size(points);
-  assert(n >= 3);
   assert(0 <= color.r && color.r <= 1);
   assert(0 <= color.g && color.g <= 1);
   assert(0 <= color.b && color.b <= 1);
 
-  vector_t window_center = get_window_center();
+  // Circles are drawn exactly, since they have no vertices
+  if (points.kind == SHAPE_CIRCLE) {
+    vector_t pixel =
+        get_window_position(context, vec_add(points.center, offset));
+    double radius = points.radius * context->scale;
+    filledCircleRGBA(renderer, pixel.x, pixel.y, round(radius), color.r * 255,
+                     color.g * 255, color.b * 255, alpha * 255);
+    return;
+  }
+  size_t n = points.size;
+  assert(n >= 3);
 
   // Convert each vertex to a point on screen
-  int16_t *x_points = malloc(sizeof(*x_points) * n),
-          *y_points = malloc(sizeof(*y_points) * n);
-  assert(x_points != NULL);
-  assert(y_points != NULL);
+  reserve_scratch(n);
   for (size_t i = 0; i < n; i++) {
-    vector_t *vertex = list_get(points, i);
-    vector_t pixel = get_window_position(*vertex, window_center);
-    x_points[i] = pixel.x;
-    y_points[i] = pixel.y;
+    vector_t pixel = get_window_position(
+        context, (vector_t){points.x[i] + offset.x, points.y[i] + offset.y});
+    x_scratch[i] = pixel.x;
+    y_scratch[i] = pixel.y;
   }
 
   // Draw polygon with the given color
-  filledPolygonRGBA(renderer, x_points, y_points, n, color.r * 255,
+  filledPolygonRGBA(renderer, x_scratch, y_scratch, n, color.r * 255,
                     color.g * 255, color.b * 255, alpha * 255);
-  list_free(points);
-  free(x_points);
-  free(y_points);
 }
 
-void sdl_show(void) {
-  // Draw boundary lines
-  vector_t window_center = get_window_center();
+void sdl_draw_polygon(body_t *body) {
+  render_context_t context = get_render_context();
+  draw_body_shape(&context, body, VEC_ZERO);
+}
+
+// Draws the boundary of the scene and shows the frame
+void show_frame(const render_context_t *context) {
   vector_t max = vec_add(center, max_diff),
            min = vec_subtract(center, max_diff);
-  vector_t max_pixel = get_window_position(max, window_center),
-           min_pixel = get_window_position(min, window_center);
-  SDL_Rect *boundary = malloc(sizeof(*boundary));
-  boundary->x = min_pixel.x;
-  boundary->y = max_pixel.y;
-  boundary->w = max_pixel.x - min_pixel.x;
-  boundary->h = min_pixel.y - max_pixel.y;
+  vector_t max_pixel = get_window_position(context, max),
+           min_pixel = get_window_position(context, min);
+  SDL_Rect boundary = {.x = min_pixel.x,
+                       .y = max_pixel.y,
+                       .w = max_pixel.x - min_pixel.x,
+                       .h = min_pixel.y - max_pixel.y};
   SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-  SDL_RenderDrawRect(renderer, boundary);
-  free(boundary);
+  SDL_RenderDrawRect(renderer, &boundary);
 
   SDL_RenderPresent(renderer);
 }
 
-void sdl_render_image(SDL_Texture *image, body_t *curr, vector_t dimensions) {
-  int w, h;
-  vector_t centroid =
-      get_window_position(body_get_centroid(curr), get_window_center());
-  SDL_QueryTexture(image, NULL, NULL, &w, &h);
-  SDL_Rect dims;
-  double scale = get_scene_scale(get_window_center());
+void sdl_show(void) {
+  render_context_t context = get_render_context();
+  show_frame(&context);
+}
+
+// Draws the sprites waiting in the batch
+void flush_sprites(void) {
+  if (batch_sprites == 0) {
+    return;
+  }
+  SDL_RenderGeometry(renderer, batch_texture, batch_vertices,
+                     4 * batch_sprites, batch_indices, 6 * batch_sprites);
+  batch_sprites = 0;
+}
+
+// Queues a sprite to be drawn centered on position and turned to the body's
+// angle, at the given size in the scene, or if that is zero, at a fixed
+// fraction of its size in pixels
+void queue_sprite(const render_context_t *context, sprite_t *sprite,
+                  body_t *curr, vector_t position, vector_t dimensions) {
+  if (sprite->texture != batch_texture) {
+    flush_sprites();
+    batch_texture = sprite->texture;
+  }
+  if (batch_sprites == batch_capacity) {
+    batch_capacity = batch_capacity == 0 ? 16 : 2 * batch_capacity;
+    batch_vertices = realloc(batch_vertices,
+                             4 * batch_capacity * sizeof(*batch_vertices));
+    batch_indices =
+        realloc(batch_indices, 6 * batch_capacity * sizeof(*batch_indices));
+    assert(batch_vertices != NULL);
+    assert(batch_indices != NULL);
+  }
+
+  vector_t centroid = get_window_position(context, position);
+  vector_t half_size;
   if (dimensions.x != 0 && dimensions.y != 0) {
-    dims.w = dimensions.x * scale;
-    dims.h = dimensions.y * scale;
+    half_size = vec_multiply(context->scale / 2, dimensions);
   } else {
-    dims.w = w * DEFAULT_IMG_SCALE; // TODO: Fix Scale Factor
-    dims.h = h * DEFAULT_IMG_SCALE;
+    // TODO: Fix Scale Factor
+    half_size = vec_multiply(DEFAULT_IMG_SCALE / 2,
+                             (vector_t){sprite->source.w, sprite->source.h});
+  }
+  // The corners in order around the image, starting at its top left, and
+  // turned counterclockwise on the screen, whose y axis points down
+  double angle = body_get_angle(curr);
+  double c = cos(angle), s = sin(angle);
+  vector_t corners[] = {{-half_size.x, -half_size.y},
+                        {half_size.x, -half_size.y},
+                        {half_size.x, half_size.y},
+                        {-half_size.x, half_size.y}};
+  SDL_FPoint uvs[] = {sprite->uv_min,
+                      {sprite->uv_max.x, sprite->uv_min.y},
+                      sprite->uv_max,
+                      {sprite->uv_min.x, sprite->uv_max.y}};
+  SDL_Vertex *vertices = &batch_vertices[4 * batch_sprites];
+  for (size_t i = 0; i < 4; i++) {
+    vector_t corner = corners[i];
+    vertices[i].position.x = centroid.x + corner.x * c + corner.y * s;
+    vertices[i].position.y = centroid.y - corner.x * s + corner.y * c;
+    vertices[i].color = SPRITE_COLOR;
+    vertices[i].tex_coord = uvs[i];
   }
-  dims.x = centroid.x - dims.w / 2;
-  dims.y = centroid.y - dims.h / 2;
-  SDL_RenderCopyEx(renderer, image, NULL, &dims,
-                   -body_get_angle(curr) * 180 / M_PI, NULL, SDL_FLIP_NONE);
+  int first = 4 * batch_sprites;
+  int *indices = &batch_indices[6 * batch_sprites];
+  int triangles[] = {0, 1, 2, 0, 2, 3};
+  for (size_t i = 0; i < 6; i++) {
+    indices[i] = first + triangles[i];
+  }
+  batch_sprites++;
 }
 
-SDL_Texture *sdl_load_image(char *image_path) {
-  SDL_Texture *image = IMG_LoadTexture(renderer, image_path);
-  return image;
+// Finds an image in the cache by its path, or returns NULL if it isn't there
+sprite_t *find_cached_image(const char *path) {
+  size_t size = image_cache == NULL ? 0 : list_size(image_cache);
+  for (size_t i = 0; i < size; i++) {
+    sprite_t *sprite = list_get(image_cache, i);
+    if (strcmp(sprite->path, path) == 0) {
+      return sprite;
+    }
+  }
+  return NULL;
 }
 
-void sdl_render_scene(scene_t *scene) { // check if body has a sprite and then
-                                        // either display sprite or shape
-  sdl_clear();
+// Adds an image in part of a texture to the cache, with nothing holding it
+sprite_t *add_cached_image(const char *path, SDL_Texture *texture,
+                           SDL_Rect source, int texture_w, int texture_h) {
+  if (image_cache == NULL) {
+    image_cache = list_init(INITIAL_CACHED_IMAGES, free);
+  }
+  sprite_t *sprite = malloc(sizeof(*sprite));
+  assert(sprite != NULL);
+  sprite->path = malloc(strlen(path) + 1);
+  assert(sprite->path != NULL);
+  strcpy(sprite->path, path);
+  sprite->texture = texture;
+  sprite->source = source;
+  sprite->uv_min = (SDL_FPoint){(float)source.x / texture_w,
+                                (float)source.y / texture_h};
+  sprite->uv_max = (SDL_FPoint){(float)(source.x + source.w) / texture_w,
+                                (float)(source.y + source.h) / texture_h};
+  sprite->references = 0;
+  list_add(image_cache, sprite);
+  return sprite;
+}
+
+sprite_t *sdl_load_image(char *image_path) {
+  // Without a window (e.g. when simulating headlessly) there is nothing to
+  // draw images with, so skip loading them
+  if (renderer == NULL) {
+    return NULL;
+  }
+  sprite_t *sprite = find_cached_image(image_path);
+  if (sprite == NULL) {
+    SDL_Texture *texture = IMG_LoadTexture(renderer, image_path);
+    if (texture == NULL) {
+      return NULL;
+    }
+    int w, h;
+    SDL_QueryTexture(texture, NULL, NULL, &w, &h);
+    sprite = add_cached_image(image_path, texture, (SDL_Rect){0, 0, w, h}, w,
+                              h);
+  }
+  sprite->references++;
+  return sprite;
+}
+
+/**
+ * An image being packed into an atlas, and where it goes.
+ */
+typedef struct {
+  const char *path;
+  SDL_Surface *surface;
+  SDL_Rect place;
+} atlas_image_t;
+
+// Orders images being packed from tallest to shortest
+int compare_atlas_heights(const void *a, const void *b) {
+  return ((const atlas_image_t *)b)->surface->h -
+         ((const atlas_image_t *)a)->surface->h;
+}
+
+// Places each image on the first shelf across the atlas with room for it,
+// tallest first, leaving the place's size zero if the atlas is full.
+// Returns the height of the atlas.
+int place_atlas_images(atlas_image_t *images, size_t count) {
+  qsort(images, count, sizeof(*images), compare_atlas_heights);
+  // Each shelf's top and how far across it is filled
+  int *shelf_tops = malloc(count * sizeof(int));
+  int *shelf_widths = malloc(count * sizeof(int));
+  assert(shelf_tops != NULL);
+  assert(shelf_widths != NULL);
+  size_t shelves = 0;
+  int height = 0;
+  for (size_t i = 0; i < count; i++) {
+    int w = images[i].surface->w + ATLAS_PADDING,
+        h = images[i].surface->h + ATLAS_PADDING;
+    size_t shelf = 0;
+    while (shelf < shelves && shelf_widths[shelf] + w > ATLAS_WIDTH) {
+      shelf++;
+    }
+    if (shelf == shelves) {
+      if (w > ATLAS_WIDTH || height + h > ATLAS_MAX_HEIGHT) {
+        images[i].place = (SDL_Rect){0, 0, 0, 0};
+        continue;
+      }
+      shelf_tops[shelves] = height;
+      shelf_widths[shelves] = 0;
+      shelves++;
+      height += h;
+    }
+    images[i].place =
+        (SDL_Rect){shelf_widths[shelf], shelf_tops[shelf],
+                   images[i].surface->w, images[i].surface->h};
+    shelf_widths[shelf] += w;
+  }
+  free(shelf_tops);
+  free(shelf_widths);
+  return height;
+}
+
+void sdl_pack_images(const char *image_paths[], size_t count) {
+  if (renderer == NULL) {
+    return;
+  }
+  atlas_image_t *images = malloc(count * sizeof(*images));
+  assert(images != NULL);
+  size_t loaded = 0;
+  for (size_t i = 0; i < count; i++) {
+    if (find_cached_image(image_paths[i]) != NULL) {
+      continue;
+    }
+    SDL_Surface *surface = IMG_Load(image_paths[i]);
+    if (surface == NULL) {
+      continue;
+    }
+    images[loaded].path = image_paths[i];
+    images[loaded].surface =
+        SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
+    assert(images[loaded].surface != NULL);
+    SDL_FreeSurface(surface);
+    loaded++;
+  }
+  int height = place_atlas_images(images, loaded);
+  if (height > 0) {
+    SDL_Surface *atlas = SDL_CreateRGBSurfaceWithFormat(
+        0, ATLAS_WIDTH, height, 32, SDL_PIXELFORMAT_RGBA32);
+    assert(atlas != NULL);
+    for (size_t i = 0; i < loaded; i++) {
+      if (images[i].place.w > 0) {
+        // Copy the pixels as they are, rather than blending them with the
+        // empty atlas
+        SDL_SetSurfaceBlendMode(images[i].surface, SDL_BLENDMODE_NONE);
+        SDL_BlitSurface(images[i].surface, NULL, atlas, &images[i].place);
+      }
+    }
+    SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, atlas);
+    assert(texture != NULL);
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    SDL_FreeSurface(atlas);
+    for (size_t i = 0; i < loaded; i++) {
+      if (images[i].place.w > 0) {
+        add_cached_image(images[i].path, texture, images[i].place,
+                         ATLAS_WIDTH, height);
+      }
+    }
+  }
+  for (size_t i = 0; i < loaded; i++) {
+    SDL_FreeSurface(images[i].surface);
+  }
+  free(images);
+}
+
+void sdl_release_image(sprite_t *image) {
+  if (image == NULL) {
+    return;
+  }
+  assert(image->references > 0);
+  image->references--;
+}
+
+// Counts the references to the cached sprites in a texture, and how many of
+// them there are
+size_t texture_references(SDL_Texture *texture, size_t *sprites) {
+  size_t references = 0;
+  *sprites = 0;
+  for (size_t i = 0; i < list_size(image_cache); i++) {
+    sprite_t *sprite = list_get(image_cache, i);
+    if (sprite->texture == texture) {
+      references += sprite->references;
+      (*sprites)++;
+    }
+  }
+  return references;
+}
+
+void sdl_release_unused_images(void) {
+  size_t size = image_cache == NULL ? 0 : list_size(image_cache);
+  // An atlas stays whole while any of its images are held, so the rest can
+  // be given out again without loading them separately
+  for (size_t i = size; i-- > 0;) {
+    sprite_t *sprite = list_get(image_cache, i);
+    size_t sprites;
+    if (texture_references(sprite->texture, &sprites) == 0) {
+      list_swap_remove(image_cache, i);
+      if (sprites == 1) {
+        SDL_DestroyTexture(sprite->texture);
+      }
+      free(sprite->path);
+      free(sprite);
+    }
+  }
+}
+
+// Whether a body is drawn, in the background or in front of it
+bool is_drawn(body_t *body, bool background) {
+  return !body_hidden(body) && body_is_background(body) == background;
+}
+
+// Orders bodies by layer, then by where they are in the scene
+int compare_draw_entries(const void *a, const void *b) {
+  const draw_entry_t *entry1 = a, *entry2 = b;
+  if (entry1->layer != entry2->layer) {
+    return entry1->layer < entry2->layer ? -1 : 1;
+  }
+  return entry1->index < entry2->index ? -1 : entry1->index > entry2->index;
+}
+
+// Puts the bodies in the background, or those in front of it, into
+// draw_order in the order they are drawn, returning how many there are
+size_t order_bodies(scene_t *scene, bool background) {
   size_t body_count = scene_bodies(scene);
+  if (body_count > draw_order_capacity) {
+    draw_order_capacity = body_count;
+    draw_order =
+        realloc(draw_order, draw_order_capacity * sizeof(*draw_order));
+    assert(draw_order != NULL);
+  }
+  size_t count = 0;
+  bool sorted = true;
   for (size_t i = 0; i < body_count; i++) {
-    body_t *curr = scene_get_body(scene, i);
-    if (!body_hidden(curr)) {
-      SDL_Texture *image = body_get_image(curr);
-      SDL_Texture *shadow = body_get_shadow(curr);
-      if (shadow != NULL) {
-        sdl_render_image(
-            shadow, curr,
-            vec_multiply(DEFAULT_SHADOW_SCALE, body_get_dimensions(curr)));
-      }
+    body_t *body = scene_get_body(scene, i);
+    if (is_drawn(body, background)) {
+      draw_order[count] = (draw_entry_t){body, body_get_layer(body), i};
+      sorted = sorted && (count == 0 || draw_order[count - 1].layer <=
+                                            draw_order[count].layer);
+      count++;
+    }
+  }
+  // Usually the bodies are already in order, e.g. all in one layer
+  if (!sorted) {
+    qsort(draw_order, count, sizeof(*draw_order), compare_draw_entries);
+  }
+  return count;
+}
+
+// Draws a rectangle or circle overlay
+void draw_overlay(const render_context_t *context, const overlay_t *overlay) {
+  rgb_color_t color = overlay->color;
+  if (overlay->kind == OVERLAY_CIRCLE) {
+    vector_t pixel = get_window_position(context, overlay->center);
+    double radius = overlay->size.x * context->scale;
+    filledCircleRGBA(renderer, pixel.x, pixel.y, round(radius), color.r * 255,
+                     color.g * 255, color.b * 255, 255);
+    return;
+  }
+  // Half the rectangle's length along its angle and half its width across it
+  vector_t direction = {cos(overlay->angle), sin(overlay->angle)};
+  vector_t along = vec_multiply(overlay->size.x / 2, direction);
+  vector_t across =
+      vec_multiply(overlay->size.y / 2, (vector_t){-direction.y, direction.x});
+  vector_t corners[] = {vec_add(along, across), vec_subtract(across, along),
+                        vec_negate(vec_add(along, across)),
+                        vec_subtract(along, across)};
+  reserve_scratch(4);
+  for (size_t i = 0; i < 4; i++) {
+    vector_t pixel =
+        get_window_position(context, vec_add(overlay->center, corners[i]));
+    x_scratch[i] = pixel.x;
+    y_scratch[i] = pixel.y;
+  }
+  filledPolygonRGBA(renderer, x_scratch, y_scratch, 4, color.r * 255,
+                    color.g * 255, color.b * 255, 255);
+}
+
+// Draws the scene's overlays from index first on, up to the first in a layer
+// at or above layer, returning the index of the next overlay to draw
+size_t draw_overlays(const render_context_t *context, scene_t *scene,
+                     size_t first, int layer) {
+  size_t count = scene_overlays(scene);
+  if (first < count && scene_get_overlay(scene, first)->layer < layer) {
+    flush_sprites();
+  }
+  while (first < count && scene_get_overlay(scene, first)->layer < layer) {
+    draw_overlay(context, scene_get_overlay(scene, first));
+    first++;
+  }
+  return first;
+}
+
+// Draws the bodies in the background, or those and the overlays in front of
+// it, by layer and then in the scene's order
+void draw_bodies(const render_context_t *context, scene_t *scene,
+                 double alpha, bool background) {
+  size_t count = order_bodies(scene, background);
+  size_t overlay = 0;
+  size_t i = 0;
+  while (i < count) {
+    int layer = draw_order[i].layer;
+    if (!background) {
+      overlay = draw_overlays(context, scene, overlay, layer);
+    }
+    // Draw the shadows of a run of bodies with shadows in the layer before
+    // any of the bodies, so the shadows are drawn together and none falls on
+    // a neighbour, e.g. in the triangle of balls
+    size_t run_end = i;
+    while (run_end < count && draw_order[run_end].layer == layer &&
+           body_get_shadow(draw_order[run_end].body) != NULL) {
+      body_t *shadowed = draw_order[run_end].body;
+      queue_sprite(context, body_get_shadow(shadowed), shadowed,
+                   body_get_interpolated_centroid(shadowed, alpha),
+                   vec_multiply(DEFAULT_SHADOW_SCALE,
+                                body_get_dimensions(shadowed)));
+      run_end++;
+    }
+    // Then draw the run's bodies, or the next body if it has no shadow
+    if (run_end == i) {
+      run_end++;
+    }
+    for (; i < run_end; i++) {
+      body_t *curr = draw_order[i].body;
+      sprite_t *image = body_get_image(curr);
+      vector_t position = body_get_interpolated_centroid(curr, alpha);
       if (image != NULL) {
-        sdl_render_image(image, curr, body_get_dimensions(curr));
+        queue_sprite(context, image, curr, position,
+                     body_get_dimensions(curr));
       } else {
-        sdl_draw_polygon(curr);
+        flush_sprites();
+        draw_body_shape(context, curr,
+                        vec_subtract(position, body_get_centroid(curr)));
       }
     }
   }
-  sdl_show();
+  if (!background) {
+    draw_overlays(context, scene, overlay, INT_MAX);
+  }
+  flush_sprites();
+}
+
+// Draws the scene's background bodies into the background layer, if they or
+// the window's size have changed since they were last drawn
+void update_background(const render_context_t *context, scene_t *scene) {
+  int width = round(2 * context->window_center.x),
+      height = round(2 * context->window_center.y);
+  if (background_drawn && width == background_width &&
+      height == background_height) {
+    return;
+  }
+  background_drawn = true;
+  background_used = false;
+  size_t body_count = scene_bodies(scene);
+  for (size_t i = 0; i < body_count && !background_used; i++) {
+    background_used = is_drawn(scene_get_body(scene, i), true);
+  }
+  if (!background_used) {
+    return;
+  }
+  if (width != background_width || height != background_height) {
+    if (background_layer != NULL) {
+      SDL_DestroyTexture(background_layer);
+    }
+    background_layer =
+        SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
+                          SDL_TEXTUREACCESS_TARGET, width, height);
+    background_width = width;
+    background_height = height;
+    if (background_layer != NULL) {
+      SDL_SetTextureBlendMode(background_layer, SDL_BLENDMODE_NONE);
+    }
+  }
+  // Without render targets, the background is drawn every frame instead
+  if (background_layer == NULL) {
+    background_used = false;
+    return;
+  }
+  SDL_SetRenderTarget(renderer, background_layer);
+  sdl_clear();
+  draw_bodies(context, scene, 1, true);
+  SDL_SetRenderTarget(renderer, NULL);
+}
+
+void sdl_invalidate_background(void) { background_drawn = false; }
+
+void sdl_render_scene(scene_t *scene, double alpha) {
+  // check if body has a sprite and then either display sprite or shape
+  render_context_t context = get_render_context();
+  update_background(&context, scene);
+  if (background_used) {
+    // The background covers the window, so there is no need to clear it
+    SDL_RenderCopy(renderer, background_layer, NULL, NULL);
+  } else {
+    sdl_clear();
+    draw_bodies(&context, scene, alpha, true);
+  }
+  draw_bodies(&context, scene, alpha, false);
+  show_frame(&context);
 }
 
 void sdl_on_key(key_handler_t handler) { key_handler = handler; }
@@ -328,11 +854,14 @@ void sdl_on_key(key_handler_t handler) { key_handler = handler; }
 void sdl_on_click(mouse_handler_t handler) { mouse_handler = handler; }
 
 double time_since_last_tick(void) {
-  clock_t now = clock();
-  double difference = last_clock
-                          ? (double)(now - last_clock) / CLOCKS_PER_SEC
-                          : 0.0; // return 0 the first time this is called
-  last_clock = now;
+  // Wall-clock time, unlike clock(), which counts CPU time and so runs slow
+  // whenever the process waits, e.g. for vsync
+  uint64_t now = SDL_GetPerformanceCounter();
+  double difference =
+      last_counter
+          ? (double)(now - last_counter) / SDL_GetPerformanceFrequency()
+          : 0.0; // return 0 the first time this is called
+  last_counter = now;
   return difference;
 }
 
@@ -6,24 +6,37 @@ const int CIRCLE_POINTS = 60;
 
 double normalize(double angle) { return fmod(angle + 2 * M_PI, 2 * M_PI); }
 
-list_t *draw_helper(size_t n, vector_t *centroid, double inner, double major,
-                    double minor, double angle1, double angle2) {
+// Converts a packed polygon into a list of vectors, freeing the polygon
+list_t *unpack(vertices_t *vertices) {
+  list_t *shape = vertices_to_list(vertices);
+  vertices_free(vertices);
+  return shape;
+}
+
+vertices_t *draw_helper_vertices(size_t n, vector_t *centroid, double inner,
+                                 double major, double minor, double angle1,
+                                 double angle2) {
   assert(n >= 3);
-  list_t *shape = list_init(n + 2, (free_func_t)free);
+  vertices_t *shape = vertices_init(n + 2);
   double theta = (angle2 - angle1) / n;
   if (n == CIRCLE_POINTS) {
     n--;
   }
   for (int i = 0; i <= n; i++) {
     double f = i % 2 == 0 ? 1 : inner / major;
-    vector_t *p = malloc(sizeof(vector_t));
-    *p = (vector_t){centroid->x + f * major * cos(i * theta + angle1),
-                    centroid->y + f * minor * sin(i * theta + angle1)};
-    list_add(shape, p);
+    vertices_add(shape,
+                 (vector_t){centroid->x + f * major * cos(i * theta + angle1),
+                            centroid->y + f * minor * sin(i * theta + angle1)});
   }
   return shape;
 }
 
+list_t *draw_helper(size_t n, vector_t *centroid, double inner, double major,
+                    double minor, double angle1, double angle2) {
+  return unpack(draw_helper_vertices(n, centroid, inner, major, minor, angle1,
+                                     angle2));
+}
+
 list_t *draw_star(size_t n, vector_t *centroid, double inner, double outer) {
   assert(n >= 2);
   return draw_helper(n * 2, centroid, inner, outer, outer, 0, 2 * M_PI);
@@ -47,19 +60,33 @@ list_t *draw_arc_offset(vector_t *centroid, double radius, double angle1,
 }
 
 list_t *draw_circle(vector_t *centroid, double radius) {
-  return draw_ellipse(centroid, radius, radius);
+  return unpack(draw_circle_vertices(centroid, radius));
+}
+
+vertices_t *draw_circle_vertices(vector_t *centroid, double radius) {
+  return draw_ellipse_vertices(centroid, radius, radius);
 }
 
 list_t *draw_ellipse(vector_t *centroid, double major, double minor) {
-  return draw_helper(CIRCLE_POINTS, centroid, major, major, minor, 0, 2 * M_PI);
+  return unpack(draw_ellipse_vertices(centroid, major, minor));
+}
+
+vertices_t *draw_ellipse_vertices(vector_t *centroid, double major,
+                                  double minor) {
+  return draw_helper_vertices(CIRCLE_POINTS, centroid, major, major, minor, 0,
+                              2 * M_PI);
 }
 
 list_t *draw_rectangle(vector_t *centroid, double x, double y) {
+  return unpack(draw_rectangle_vertices(centroid, x, y));
+}
+
+vertices_t *draw_rectangle_vertices(vector_t *centroid, double x, double y) {
   vector_t p1 = {centroid->x - x / 2, centroid->y - y / 2};
   vector_t p2 = {centroid->x + x / 2, centroid->y - y / 2};
   vector_t p3 = {centroid->x + x / 2, centroid->y + y / 2};
   vector_t p4 = {centroid->x - x / 2, centroid->y + y / 2};
-  return draw_quadrilateral(p1, p2, p3, p4);
+  return draw_quadrilateral_vertices(p1, p2, p3, p4);
 }
 
 list_t *draw_cup(vector_t *edge1, vector_t *edge2, vector_t *centroid,
@@ -74,32 +101,27 @@ list_t *draw_cup(vector_t *edge1, vector_t *edge2, vector_t *centroid,
 
 list_t *draw_quadrilateral(vector_t p_1, vector_t p_2, vector_t p_3,
                            vector_t p_4) {
-  list_t *shape = list_init(4, (free_func_t)free);
-  vector_t *p1 = malloc(sizeof(vector_t));
-  vector_t *p2 = malloc(sizeof(vector_t));
-  vector_t *p3 = malloc(sizeof(vector_t));
-  vector_t *p4 = malloc(sizeof(vector_t));
-  *p1 = p_1;
-  *p2 = p_2;
-  *p3 = p_3;
-  *p4 = p_4;
-  list_add(shape, p1);
-  list_add(shape, p2);
-  list_add(shape, p3);
-  list_add(shape, p4);
+  return unpack(draw_quadrilateral_vertices(p_1, p_2, p_3, p_4));
+}
+
+vertices_t *draw_quadrilateral_vertices(vector_t p_1, vector_t p_2,
+                                        vector_t p_3, vector_t p_4) {
+  vertices_t *shape = vertices_init(4);
+  vertices_add(shape, p_1);
+  vertices_add(shape, p_2);
+  vertices_add(shape, p_3);
+  vertices_add(shape, p_4);
   return shape;
 }
 
 list_t *draw_triangle(vector_t p_1, vector_t p_2, vector_t p_3) {
-  list_t *shape = list_init(3, (free_func_t)free);
-  vector_t *p1 = malloc(sizeof(vector_t));
-  vector_t *p2 = malloc(sizeof(vector_t));
-  vector_t *p3 = malloc(sizeof(vector_t));
-  *p1 = p_1;
-  *p2 = p_2;
-  *p3 = p_3;
-  list_add(shape, p1);
-  list_add(shape, p2);
-  list_add(shape, p3);
+  return unpack(draw_triangle_vertices(p_1, p_2, p_3));
+}
+
+vertices_t *draw_triangle_vertices(vector_t p_1, vector_t p_2, vector_t p_3) {
+  vertices_t *shape = vertices_init(3);
+  vertices_add(shape, p_1);
+  vertices_add(shape, p_2);
+  vertices_add(shape, p_3);
   return shape;
-}
\ No newline at end of file
+}
@@ -0,0 +1,192 @@
+#include "shot_search.h"
+#include <assert.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+const size_t DEFAULT_SAMPLES = 256;
+const double DEFAULT_ANGLE_SPREAD = 0.05;
+const double DEFAULT_SPEED_SPREAD = 0.2;
+
+/**
+ * The candidates a worker has left to play, candidates[begin, end).
+ * The owner takes from the front and thieves take from the back.
+ */
+typedef struct {
+  pthread_mutex_t lock;
+  size_t begin, end;
+} work_queue_t;
+
+typedef struct {
+  candidate_t *candidates;
+  work_queue_t *queues;
+  size_t workers;
+  double dt;
+} pool_t;
+
+typedef struct {
+  pool_t *pool;
+  size_t id;
+} worker_t;
+
+search_params_t search_params_init(double angle, double speed) {
+  return (search_params_t){.cue_ball = cue_ball_pos(),
+                           .angle = angle,
+                           .angle_spread = DEFAULT_ANGLE_SPREAD,
+                           .speed = speed,
+                           .speed_spread = DEFAULT_SPEED_SPREAD * speed,
+                           .ball_on = RED_INFO,
+                           .samples = DEFAULT_SAMPLES,
+                           .threads = 0,
+                           .seed = 0,
+                           .dt = SIM_DT};
+}
+
+double shot_score(shot_result_t *result) {
+  if (!result->settled) {
+    return -INFINITY;
+  }
+  return result->points - result->foul;
+}
+
+// splitmix64, so sampling needs no shared state such as rand()'s
+uint64_t next_random(uint64_t *state) {
+  uint64_t z = (*state += 0x9e3779b97f4a7c15);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+  return z ^ (z >> 31);
+}
+
+// A uniformly random double in [min, max)
+double random_between(uint64_t *state, double min, double max) {
+  return min + (max - min) * (next_random(state) >> 11) * 0x1.0p-53;
+}
+
+void sample_candidates(search_params_t *params, candidate_t *candidates) {
+  uint64_t state = params->seed;
+  for (size_t i = 0; i < params->samples; i++) {
+    candidate_t *candidate = &candidates[i];
+    candidate->index = i;
+    candidate->angle =
+        random_between(&state, params->angle - params->angle_spread,
+                       params->angle + params->angle_spread);
+    candidate->speed =
+        random_between(&state, params->speed - params->speed_spread,
+                       params->speed + params->speed_spread);
+    candidate->speed = fmin(fmax(candidate->speed, 0), CUE_MAX_SPEED);
+    candidate->shot = (shot_t){
+        params->cue_ball,
+        vec_init(BALL_MASS * candidate->speed, candidate->angle),
+        params->ball_on};
+  }
+}
+
+bool take_work(work_queue_t *queue, size_t *index) {
+  pthread_mutex_lock(&queue->lock);
+  bool found = queue->begin < queue->end;
+  if (found) {
+    *index = queue->begin++;
+  }
+  pthread_mutex_unlock(&queue->lock);
+  return found;
+}
+
+// Moves the back half of another worker's candidates into this worker's
+// (empty) queue. Returns false if every other queue is empty.
+bool steal_work(pool_t *pool, size_t id) {
+  for (size_t i = 1; i < pool->workers; i++) {
+    work_queue_t *victim = &pool->queues[(id + i) % pool->workers];
+    pthread_mutex_lock(&victim->lock);
+    size_t end = victim->end;
+    size_t begin = end - (end - victim->begin + 1) / 2;
+    victim->end = begin;
+    pthread_mutex_unlock(&victim->lock);
+    if (begin < end) {
+      work_queue_t *queue = &pool->queues[id];
+      pthread_mutex_lock(&queue->lock);
+      queue->begin = begin;
+      queue->end = end;
+      pthread_mutex_unlock(&queue->lock);
+      return true;
+    }
+  }
+  return false;
+}
+
+void *run_worker(void *aux) {
+  worker_t *worker = aux;
+  pool_t *pool = worker->pool;
+  size_t index;
+  do {
+    while (take_work(&pool->queues[worker->id], &index)) {
+      candidate_t *candidate = &pool->candidates[index];
+      if (pool->dt > 0) {
+        simulate_shot(candidate->shot, pool->dt, &candidate->result);
+      } else {
+        simulate_shot_events(candidate->shot, &candidate->result);
+      }
+      candidate->score = shot_score(&candidate->result);
+    }
+  } while (steal_work(pool, worker->id));
+  return NULL;
+}
+
+int compare_candidates(const void *a, const void *b) {
+  const candidate_t *candidate1 = a, *candidate2 = b;
+  if (candidate1->score != candidate2->score) {
+    return candidate1->score > candidate2->score ? -1 : 1;
+  }
+  return candidate1->index < candidate2->index ? -1 : 1;
+}
+
+size_t default_threads(void) {
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  return cores > 0 ? cores : 1;
+}
+
+candidate_t *shot_search(search_params_t params) {
+  assert(params.samples > 0);
+  candidate_t *candidates = malloc(params.samples * sizeof(candidate_t));
+  assert(candidates != NULL);
+  sample_candidates(&params, candidates);
+
+  size_t workers = params.threads ? params.threads : default_threads();
+  workers = workers < params.samples ? workers : params.samples;
+  pool_t pool = {candidates, malloc(workers * sizeof(work_queue_t)), workers,
+                 params.dt};
+  worker_t *worker_info = malloc(workers * sizeof(worker_t));
+  pthread_t *threads = malloc(workers * sizeof(pthread_t));
+  bool *started = malloc(workers * sizeof(bool));
+  assert(pool.queues != NULL && worker_info != NULL && threads != NULL &&
+         started != NULL);
+  for (size_t i = 0; i < workers; i++) {
+    pthread_mutex_init(&pool.queues[i].lock, NULL);
+    pool.queues[i].begin = params.samples * i / workers;
+    pool.queues[i].end = params.samples * (i + 1) / workers;
+    worker_info[i] = (worker_t){&pool, i};
+  }
+
+  // The calling thread is worker 0. If a thread can't be started (e.g. on a
+  // build without threads), its candidates are stolen by the other workers.
+  for (size_t i = 1; i < workers; i++) {
+    started[i] =
+        pthread_create(&threads[i], NULL, run_worker, &worker_info[i]) == 0;
+  }
+  run_worker(&worker_info[0]);
+  for (size_t i = 1; i < workers; i++) {
+    if (started[i]) {
+      pthread_join(threads[i], NULL);
+    }
+  }
+
+  for (size_t i = 0; i < workers; i++) {
+    pthread_mutex_destroy(&pool.queues[i].lock);
+  }
+  free(pool.queues);
+  free(worker_info);
+  free(threads);
+  free(started);
+  qsort(candidates, params.samples, sizeof(candidate_t), compare_candidates);
+  return candidates;
+}
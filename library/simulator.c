@@ -0,0 +1,109 @@
+#include "simulator.h"
+#include "event_solver.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+typedef struct {
+  body_t *bodies[NUM_BALLS];
+  shot_result_t *result;
+} sim_aux_t;
+
+shot_t shot_init(double angle, double speed) {
+  return (shot_t){cue_ball_pos(), vec_init(BALL_MASS * speed, angle),
+                  RED_INFO};
+}
+
+// Runs after the game's pocket handler, so the ball is already marked as
+// removed or to respawn. Records where it went down and takes it off the
+// table, since there are no later shots for it to respawn for.
+void sim_pocket_handler(body_t *pocket, body_t *ball, vector_t axis,
+                        void *aux) {
+  sim_aux_t *sim_aux = aux;
+  for (size_t i = 0; i < NUM_BALLS; i++) {
+    ball_result_t *ball_result = &sim_aux->result->balls[i];
+    if (sim_aux->bodies[i] == ball && !ball_result->potted) {
+      ball_result->position = body_get_centroid(ball);
+      ball_result->potted = true;
+      sim_aux->result->pots++;
+      body_remove(ball);
+      return;
+    }
+  }
+}
+
+// Sets up a headless table for a shot, ready to be ticked, and adds a handler
+// which records the balls in result as they are potted
+sim_aux_t *sim_setup(state_t *state, shot_t shot, shot_result_t *result) {
+  game_state_init_headless(state);
+  state->ball_on = shot.ball_on;
+  state->reds_left = shot.ball_on < 2;
+
+  sim_aux_t *aux = malloc(sizeof(sim_aux_t));
+  assert(aux != NULL);
+  aux->result = result;
+  result->pots = 0;
+  size_t balls = 0;
+  for (size_t i = 0; i < scene_bodies(state->scene); i++) {
+    body_t *body = scene_get_body(state->scene, i);
+    int info = *(int *)body_get_info(body);
+    if (info <= BLACK_INFO) {
+      assert(balls < NUM_BALLS);
+      aux->bodies[balls] = body;
+      result->balls[balls].info = info;
+      result->balls[balls].potted = false;
+      balls++;
+    }
+  }
+  assert(balls == NUM_BALLS);
+  scene_add_collision_handler(state->scene, 1 << POCKET_INFO, BALL_TYPES,
+                              sim_pocket_handler, NULL, aux, free);
+
+  body_set_centroid(state->cue_ball, shot.cue_ball);
+  body_add_impulse(state->cue_ball, shot.impulse);
+  return aux;
+}
+
+// Records where the balls stopped, scores the shot and frees the table
+void sim_finish(state_t *state, sim_aux_t *aux, shot_result_t *result) {
+  result->settled = scene_is_still(state->scene);
+  for (size_t i = 0; i < NUM_BALLS; i++) {
+    if (!result->balls[i].potted) {
+      result->balls[i].position = body_get_centroid(aux->bodies[i]);
+    }
+  }
+  // Missing every ball is a foul, as in compute_positions()
+  if (state->first_hit) {
+    state->foul = fmax(state->ball_on, 4);
+  }
+  result->points = state->foul ? 0 : state->points;
+  result->foul = state->foul;
+  scene_free(state->scene);
+}
+
+void simulate_shot(shot_t shot, double dt, shot_result_t *result) {
+  state_t state;
+  sim_aux_t *aux = sim_setup(&state, shot, result);
+  // The impulse only moves the cue ball once the scene ticks
+  result->ticks = 0;
+  do {
+    scene_tick(state.scene, dt);
+    result->ticks++;
+  } while (!scene_is_still(state.scene) && result->ticks < SIM_MAX_TICKS);
+  sim_finish(&state, aux, result);
+}
+
+void simulate_shot_events(shot_t shot, shot_result_t *result) {
+  state_t state;
+  sim_aux_t *aux = sim_setup(&state, shot, result);
+  // Give the cue ball its impulse before predicting where it goes
+  scene_tick(state.scene, 0);
+  event_solver_t *solver = event_solver_init(state.scene, MU * G);
+  result->ticks = 0;
+  while (!scene_is_still(state.scene) && result->ticks < SIM_MAX_TICKS) {
+    event_solver_step(solver, INFINITY);
+    result->ticks++;
+  }
+  event_solver_free(solver);
+  sim_finish(&state, aux, result);
+}
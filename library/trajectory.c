@@ -0,0 +1,336 @@
+#include "trajectory.h"
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+const size_t INITIAL_OBSTACLES = 32;
+const size_t INITIAL_POINTS = 128;
+// How much wider to make the range of angles an obstacle covers, so that
+// rounding never hides it
+const double SPREAD_MARGIN = 1e-9;
+// The index of no obstacle
+const size_t NO_OBSTACLE = SIZE_MAX;
+
+// Either a ball, which has no vertices, or a polygon, whose vertices are a run
+// of the predictor's points. The center and reach give a circle around the
+// obstacle, grown by the radius of the ball whose path is predicted, so the
+// path can only touch the obstacle if its center passes through the circle.
+// For a ball, this circle is exactly where the path touches it.
+typedef struct {
+  vector_t center;
+  double reach;
+  size_t first, size;
+  bool bounce;
+} obstacle_t;
+
+// How an obstacle looks from the origin: how far the path goes before it
+// could touch the obstacle, and the directions it could touch it in, within
+// spread of angle
+typedef struct {
+  size_t index;
+  double near;
+  double angle, spread;
+} sight_t;
+
+// Where a leg of the path first touches an obstacle, and which edge of it
+typedef struct {
+  double distance;
+  size_t index, edge;
+} hit_t;
+
+typedef struct trajectory {
+  double radius, elasticity;
+  // The cushions and pockets, then the balls. The obstacles are indexed in
+  // this order, as if they were one array.
+  obstacle_t *fixed;
+  size_t fixed_size, fixed_capacity;
+  obstacle_t *balls;
+  size_t ball_size, ball_capacity, balls_added;
+  vector_t *points;
+  size_t point_size, point_capacity;
+  vector_t origin;
+  // The sights of every obstacle from the origin, nearest first, which are
+  // stale if the obstacles or origin have changed since they were sorted
+  sight_t *sights;
+  size_t sight_capacity;
+  bool stale;
+} trajectory_t;
+
+trajectory_t *trajectory_init(double radius, double elasticity) {
+  trajectory_t *trajectory = malloc(sizeof(trajectory_t));
+  assert(trajectory != NULL);
+  trajectory->radius = radius;
+  trajectory->elasticity = elasticity;
+  trajectory->fixed = malloc(INITIAL_OBSTACLES * sizeof(obstacle_t));
+  trajectory->balls = malloc(INITIAL_OBSTACLES * sizeof(obstacle_t));
+  trajectory->sights = malloc(2 * INITIAL_OBSTACLES * sizeof(sight_t));
+  trajectory->points = malloc(INITIAL_POINTS * sizeof(vector_t));
+  assert(trajectory->fixed != NULL && trajectory->balls != NULL);
+  assert(trajectory->sights != NULL && trajectory->points != NULL);
+  trajectory->fixed_size = 0;
+  trajectory->fixed_capacity = INITIAL_OBSTACLES;
+  trajectory->ball_size = 0;
+  trajectory->ball_capacity = INITIAL_OBSTACLES;
+  trajectory->balls_added = 0;
+  trajectory->sight_capacity = 2 * INITIAL_OBSTACLES;
+  trajectory->point_size = 0;
+  trajectory->point_capacity = INITIAL_POINTS;
+  trajectory->origin = VEC_ZERO;
+  trajectory->stale = true;
+  return trajectory;
+}
+
+void trajectory_free(trajectory_t *trajectory) {
+  free(trajectory->fixed);
+  free(trajectory->balls);
+  free(trajectory->sights);
+  free(trajectory->points);
+  free(trajectory);
+}
+
+// Gets an obstacle by its index among the cushions, pockets and balls
+obstacle_t *get_obstacle(trajectory_t *trajectory, size_t index) {
+  if (index < trajectory->fixed_size) {
+    return &trajectory->fixed[index];
+  }
+  return &trajectory->balls[index - trajectory->fixed_size];
+}
+
+// Copies a polygon which never moves into the predictor
+void add_polygon(trajectory_t *trajectory, shape_view_t shape, bool bounce) {
+  assert(shape.kind == SHAPE_POLYGON);
+  if (trajectory->fixed_size == trajectory->fixed_capacity) {
+    trajectory->fixed_capacity *= 2;
+    trajectory->fixed = realloc(trajectory->fixed, trajectory->fixed_capacity *
+                                                       sizeof(obstacle_t));
+    assert(trajectory->fixed != NULL);
+  }
+  while (trajectory->point_size + shape.size > trajectory->point_capacity) {
+    trajectory->point_capacity *= 2;
+    trajectory->points = realloc(trajectory->points,
+                                 trajectory->point_capacity * sizeof(vector_t));
+    assert(trajectory->points != NULL);
+  }
+
+  aabb_t bounds = find_bounds(shape);
+  vector_t center = vec_multiply(0.5, vec_add(bounds.min, bounds.max));
+  double reach = 0;
+  for (size_t i = 0; i < shape.size; i++) {
+    vector_t vertex = {shape.x[i], shape.y[i]};
+    trajectory->points[trajectory->point_size + i] = vertex;
+    reach = fmax(reach, vec_magnitude(vec_subtract(vertex, center)));
+  }
+  trajectory->fixed[trajectory->fixed_size++] =
+      (obstacle_t){.center = center,
+                   .reach = reach + trajectory->radius,
+                   .first = trajectory->point_size,
+                   .size = shape.size,
+                   .bounce = bounce};
+  trajectory->point_size += shape.size;
+  trajectory->stale = true;
+}
+
+void trajectory_add_cushion(trajectory_t *trajectory, shape_view_t shape) {
+  add_polygon(trajectory, shape, true);
+}
+
+void trajectory_add_pocket(trajectory_t *trajectory, shape_view_t shape) {
+  add_polygon(trajectory, shape, false);
+}
+
+void trajectory_set_balls(trajectory_t *trajectory, vector_t origin) {
+  if (!vec_is_equal(origin, trajectory->origin)) {
+    trajectory->origin = origin;
+    trajectory->stale = true;
+  }
+  trajectory->balls_added = 0;
+}
+
+void trajectory_add_ball(trajectory_t *trajectory, vector_t center,
+                         double radius) {
+  obstacle_t ball = {.center = center,
+                     .reach = radius + trajectory->radius,
+                     .first = 0,
+                     .size = 0,
+                     .bounce = false};
+  size_t index = trajectory->balls_added++;
+  // The same ball in the same place as last time changes nothing
+  if (index < trajectory->ball_size &&
+      vec_is_equal(trajectory->balls[index].center, center) &&
+      trajectory->balls[index].reach == ball.reach) {
+    return;
+  }
+  if (index == trajectory->ball_capacity) {
+    trajectory->ball_capacity *= 2;
+    trajectory->balls = realloc(trajectory->balls, trajectory->ball_capacity *
+                                                       sizeof(obstacle_t));
+    assert(trajectory->balls != NULL);
+  }
+  trajectory->balls[index] = ball;
+  if (index >= trajectory->ball_size) {
+    trajectory->ball_size = index + 1;
+  }
+  trajectory->stale = true;
+}
+
+int compare_sights(const void *sight1, const void *sight2) {
+  double near1 = ((const sight_t *)sight1)->near;
+  double near2 = ((const sight_t *)sight2)->near;
+  return (near1 > near2) - (near1 < near2);
+}
+
+// Works out how every obstacle looks from the origin, if anything has
+// changed since last time, and sorts them nearest first
+void update_sights(trajectory_t *trajectory) {
+  // Balls which were not given again since trajectory_set_balls() are gone
+  if (trajectory->balls_added != trajectory->ball_size) {
+    trajectory->ball_size = trajectory->balls_added;
+    trajectory->stale = true;
+  }
+  if (!trajectory->stale) {
+    return;
+  }
+  size_t count = trajectory->fixed_size + trajectory->ball_size;
+  if (count > trajectory->sight_capacity) {
+    trajectory->sight_capacity = 2 * count;
+    trajectory->sights = realloc(
+        trajectory->sights, trajectory->sight_capacity * sizeof(sight_t));
+    assert(trajectory->sights != NULL);
+  }
+  for (size_t i = 0; i < count; i++) {
+    obstacle_t *obstacle = get_obstacle(trajectory, i);
+    vector_t offset = vec_subtract(obstacle->center, trajectory->origin);
+    double distance = vec_magnitude(offset);
+    sight_t sight = {.index = i, .near = 0, .angle = 0, .spread = M_PI};
+    // From outside the circle around the obstacle, the path can only touch
+    // it if it heads within the circle's angular radius of its center
+    if (distance > obstacle->reach) {
+      sight.near = distance - obstacle->reach;
+      sight.angle = vec_direction(offset);
+      sight.spread = asin(obstacle->reach / distance) + SPREAD_MARGIN;
+    }
+    trajectory->sights[i] = sight;
+  }
+  qsort(trajectory->sights, count, sizeof(sight_t), compare_sights);
+  trajectory->stale = false;
+}
+
+// Finds how far the path goes from start in a unit direction before it
+// touches an obstacle, or INFINITY if it never does, and which edge it touches
+double obstacle_distance(trajectory_t *trajectory, obstacle_t *obstacle,
+                         vector_t start, vector_t direction, size_t *edge) {
+  if (obstacle->size == 0) {
+    return ray_circle_impact(start, direction, obstacle->center,
+                             obstacle->reach);
+  }
+  double distance = INFINITY;
+  vector_t *vertices = &trajectory->points[obstacle->first];
+  for (size_t i = 0; i < obstacle->size; i++) {
+    double d =
+        ray_capsule_impact(start, direction, vertices[i],
+                           vertices[(i + 1) % obstacle->size],
+                           trajectory->radius);
+    if (d < distance) {
+      distance = d;
+      *edge = i;
+    }
+  }
+  return distance;
+}
+
+// Tests an obstacle for a hit closer than the best one so far
+void test_obstacle(trajectory_t *trajectory, size_t index, vector_t start,
+                   vector_t direction, hit_t *best) {
+  size_t edge = 0;
+  double distance = obstacle_distance(
+      trajectory, get_obstacle(trajectory, index), start, direction, &edge);
+  if (distance < best->distance) {
+    *best = (hit_t){.distance = distance, .index = index, .edge = edge};
+  }
+}
+
+// Finds the first obstacle touched leaving the origin, only testing the
+// obstacles the path heads towards, nearest first
+hit_t first_hit_from_origin(trajectory_t *trajectory, vector_t direction) {
+  hit_t best = {.distance = INFINITY, .index = NO_OBSTACLE, .edge = 0};
+  double angle = vec_direction(direction);
+  size_t count = trajectory->fixed_size + trajectory->ball_size;
+  for (size_t i = 0; i < count; i++) {
+    sight_t *sight = &trajectory->sights[i];
+    if (sight->near >= best.distance) {
+      break;
+    }
+    if (fabs(remainder(angle - sight->angle, 2 * M_PI)) > sight->spread) {
+      continue;
+    }
+    test_obstacle(trajectory, sight->index, trajectory->origin, direction,
+                  &best);
+  }
+  return best;
+}
+
+// Finds the first obstacle touched leaving a bounce, skipping the cushion it
+// bounced off, which is convex, and any obstacle whose circle is off the path
+hit_t first_hit(trajectory_t *trajectory, vector_t start, vector_t direction,
+                size_t skip) {
+  hit_t best = {.distance = INFINITY, .index = NO_OBSTACLE, .edge = 0};
+  size_t count = trajectory->fixed_size + trajectory->ball_size;
+  for (size_t i = 0; i < count; i++) {
+    obstacle_t *obstacle = get_obstacle(trajectory, i);
+    vector_t offset = vec_subtract(obstacle->center, start);
+    double along = vec_dot(offset, direction);
+    if (i == skip || along < -obstacle->reach ||
+        fabs(vec_cross(direction, offset)) > obstacle->reach) {
+      continue;
+    }
+    test_obstacle(trajectory, i, start, direction, &best);
+  }
+  return best;
+}
+
+// Finds the unit normal of an obstacle's edge at the point where the path
+// touches it, pointing away from the obstacle
+vector_t edge_normal(trajectory_t *trajectory, obstacle_t *obstacle,
+                     size_t edge, vector_t point) {
+  vector_t *vertices = &trajectory->points[obstacle->first];
+  vector_t a = vertices[edge];
+  vector_t b = vertices[(edge + 1) % obstacle->size];
+  vector_t segment = vec_subtract(b, a);
+  double along = vec_dot(vec_subtract(point, a), segment) /
+                 vec_dot(segment, segment);
+  vector_t closest = vec_add(a, vec_multiply(fmin(fmax(along, 0), 1), segment));
+  return vec_unit(vec_subtract(point, closest));
+}
+
+size_t trajectory_predict(trajectory_t *trajectory, vector_t direction,
+                          size_t max_bounces, vector_t *path) {
+  update_sights(trajectory);
+  vector_t start = trajectory->origin;
+  direction = vec_unit(direction);
+  size_t points = 0;
+  path[points++] = start;
+  size_t last = NO_OBSTACLE;
+  for (size_t bounces = 0;; bounces++) {
+    hit_t hit = bounces == 0
+                    ? first_hit_from_origin(trajectory, direction)
+                    : first_hit(trajectory, start, direction, last);
+    if (hit.index == NO_OBSTACLE) {
+      break;
+    }
+    start = vec_add(start, vec_multiply(hit.distance, direction));
+    path[points++] = start;
+    obstacle_t *obstacle = get_obstacle(trajectory, hit.index);
+    if (!obstacle->bounce || bounces == max_bounces) {
+      break;
+    }
+    // The ball keeps its speed along the cushion, and loses some across it
+    vector_t normal = edge_normal(trajectory, obstacle, hit.edge, start);
+    last = hit.index;
+    direction = vec_unit(vec_subtract(
+        direction, vec_multiply((1 + trajectory->elasticity) *
+                                    vec_dot(direction, normal),
+                                normal)));
+  }
+  return points;
+}
@@ -1,7 +1,11 @@
 #include "vector.h"
+#include <float.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#ifdef __x86_64__
+#include <immintrin.h>
+#endif
 
 const vector_t VEC_ZERO = {0, 0};
 
@@ -81,4 +85,230 @@ void vec_print(vector_t v) { printf("(%f, %f)\n", v.x, v.y); }
 void vector_multiply_2(double magnitude, vector_t vector) {
   vector.x *= magnitude;
   vector.y *= magnitude;
-}
\ No newline at end of file
+}
+
+// The batch operations have a plain loop, used for the points left over by
+// the SIMD versions and on other processors, an SSE2 version, which every
+// x86-64 processor can run, and an AVX2 version, chosen if the processor has
+// it. The SIMD versions do the same operations in the same order as the
+// loops, so the results don't depend on which runs.
+
+// Fewer points than this aren't worth choosing a version and combining the
+// SIMD lanes for, so they take the plain loop
+const size_t SIMD_MIN_POINTS = 16;
+
+void translate_scalar(double *x, double *y, size_t n, vector_t translation) {
+  for (size_t i = 0; i < n; i++) {
+    x[i] += translation.x;
+    y[i] += translation.y;
+  }
+}
+
+void rotate_scalar(double *x, double *y, size_t n, double c, double s,
+                   vector_t point) {
+  for (size_t i = 0; i < n; i++) {
+    double dx = x[i] - point.x;
+    double dy = y[i] - point.y;
+    x[i] = dx * c - dy * s + point.x;
+    y[i] = dx * s + dy * c + point.y;
+  }
+}
+
+// Widens a range, with its minimum as x and maximum as y, to cover the
+// projections of points onto an axis
+vector_t project_scalar(const double *x, const double *y, size_t n,
+                        vector_t axis, vector_t range) {
+  for (size_t i = 0; i < n; i++) {
+    double d = axis.x * x[i] + axis.y * y[i];
+    if (d < range.x) {
+      range.x = d;
+    }
+    if (d > range.y) {
+      range.y = d;
+    }
+  }
+  return range;
+}
+
+void magnitude_scalar(const double *x, const double *y, size_t n,
+                      double *magnitudes) {
+  for (size_t i = 0; i < n; i++) {
+    magnitudes[i] = sqrt(x[i] * x[i] + y[i] * y[i]);
+  }
+}
+
+#ifdef __x86_64__
+// Whether the processor running the program has AVX2
+bool has_avx2(void) { return __builtin_cpu_supports("avx2"); }
+
+void translate_sse2(double *x, double *y, size_t n, vector_t translation) {
+  __m128d tx = _mm_set1_pd(translation.x), ty = _mm_set1_pd(translation.y);
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    _mm_storeu_pd(x + i, _mm_add_pd(_mm_loadu_pd(x + i), tx));
+    _mm_storeu_pd(y + i, _mm_add_pd(_mm_loadu_pd(y + i), ty));
+  }
+  translate_scalar(x + i, y + i, n - i, translation);
+}
+
+__attribute__((target("avx2"))) void
+translate_avx2(double *x, double *y, size_t n, vector_t translation) {
+  __m256d tx = _mm256_set1_pd(translation.x);
+  __m256d ty = _mm256_set1_pd(translation.y);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    _mm256_storeu_pd(x + i, _mm256_add_pd(_mm256_loadu_pd(x + i), tx));
+    _mm256_storeu_pd(y + i, _mm256_add_pd(_mm256_loadu_pd(y + i), ty));
+  }
+  translate_scalar(x + i, y + i, n - i, translation);
+}
+
+void rotate_sse2(double *x, double *y, size_t n, double c, double s,
+                 vector_t point) {
+  __m128d vc = _mm_set1_pd(c), vs = _mm_set1_pd(s);
+  __m128d px = _mm_set1_pd(point.x), py = _mm_set1_pd(point.y);
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    __m128d dx = _mm_sub_pd(_mm_loadu_pd(x + i), px);
+    __m128d dy = _mm_sub_pd(_mm_loadu_pd(y + i), py);
+    __m128d rx = _mm_sub_pd(_mm_mul_pd(dx, vc), _mm_mul_pd(dy, vs));
+    __m128d ry = _mm_add_pd(_mm_mul_pd(dx, vs), _mm_mul_pd(dy, vc));
+    _mm_storeu_pd(x + i, _mm_add_pd(rx, px));
+    _mm_storeu_pd(y + i, _mm_add_pd(ry, py));
+  }
+  rotate_scalar(x + i, y + i, n - i, c, s, point);
+}
+
+__attribute__((target("avx2"))) void rotate_avx2(double *x, double *y,
+                                                 size_t n, double c, double s,
+                                                 vector_t point) {
+  __m256d vc = _mm256_set1_pd(c), vs = _mm256_set1_pd(s);
+  __m256d px = _mm256_set1_pd(point.x), py = _mm256_set1_pd(point.y);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(x + i), px);
+    __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(y + i), py);
+    __m256d rx = _mm256_sub_pd(_mm256_mul_pd(dx, vc), _mm256_mul_pd(dy, vs));
+    __m256d ry = _mm256_add_pd(_mm256_mul_pd(dx, vs), _mm256_mul_pd(dy, vc));
+    _mm256_storeu_pd(x + i, _mm256_add_pd(rx, px));
+    _mm256_storeu_pd(y + i, _mm256_add_pd(ry, py));
+  }
+  rotate_scalar(x + i, y + i, n - i, c, s, point);
+}
+
+vector_t project_sse2(const double *x, const double *y, size_t n,
+                      vector_t axis) {
+  __m128d ax = _mm_set1_pd(axis.x), ay = _mm_set1_pd(axis.y);
+  __m128d lo = _mm_set1_pd(DBL_MAX), hi = _mm_set1_pd(-DBL_MAX);
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    __m128d d = _mm_add_pd(_mm_mul_pd(ax, _mm_loadu_pd(x + i)),
+                           _mm_mul_pd(ay, _mm_loadu_pd(y + i)));
+    lo = _mm_min_pd(d, lo);
+    hi = _mm_max_pd(d, hi);
+  }
+  double lows[2], highs[2];
+  _mm_storeu_pd(lows, lo);
+  _mm_storeu_pd(highs, hi);
+  vector_t range = {fmin(lows[0], lows[1]), fmax(highs[0], highs[1])};
+  return project_scalar(x + i, y + i, n - i, axis, range);
+}
+
+__attribute__((target("avx2"))) vector_t
+project_avx2(const double *x, const double *y, size_t n, vector_t axis) {
+  __m256d ax = _mm256_set1_pd(axis.x), ay = _mm256_set1_pd(axis.y);
+  __m256d lo = _mm256_set1_pd(DBL_MAX), hi = _mm256_set1_pd(-DBL_MAX);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256d d = _mm256_add_pd(_mm256_mul_pd(ax, _mm256_loadu_pd(x + i)),
+                              _mm256_mul_pd(ay, _mm256_loadu_pd(y + i)));
+    lo = _mm256_min_pd(d, lo);
+    hi = _mm256_max_pd(d, hi);
+  }
+  double lows[4], highs[4];
+  _mm256_storeu_pd(lows, lo);
+  _mm256_storeu_pd(highs, hi);
+  vector_t range = {fmin(fmin(lows[0], lows[1]), fmin(lows[2], lows[3])),
+                    fmax(fmax(highs[0], highs[1]), fmax(highs[2], highs[3]))};
+  return project_scalar(x + i, y + i, n - i, axis, range);
+}
+
+void magnitude_sse2(const double *x, const double *y, size_t n,
+                    double *magnitudes) {
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    __m128d vx = _mm_loadu_pd(x + i), vy = _mm_loadu_pd(y + i);
+    __m128d squared = _mm_add_pd(_mm_mul_pd(vx, vx), _mm_mul_pd(vy, vy));
+    _mm_storeu_pd(magnitudes + i, _mm_sqrt_pd(squared));
+  }
+  magnitude_scalar(x + i, y + i, n - i, magnitudes + i);
+}
+
+__attribute__((target("avx2"))) void
+magnitude_avx2(const double *x, const double *y, size_t n,
+               double *magnitudes) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256d vx = _mm256_loadu_pd(x + i), vy = _mm256_loadu_pd(y + i);
+    __m256d squared =
+        _mm256_add_pd(_mm256_mul_pd(vx, vx), _mm256_mul_pd(vy, vy));
+    _mm256_storeu_pd(magnitudes + i, _mm256_sqrt_pd(squared));
+  }
+  magnitude_scalar(x + i, y + i, n - i, magnitudes + i);
+}
+#endif
+
+void vec_translate_all(double *x, double *y, size_t n, vector_t translation) {
+#ifdef __x86_64__
+  if (n >= SIMD_MIN_POINTS) {
+    if (has_avx2()) {
+      translate_avx2(x, y, n, translation);
+    } else {
+      translate_sse2(x, y, n, translation);
+    }
+    return;
+  }
+#endif
+  translate_scalar(x, y, n, translation);
+}
+
+void vec_rotate_all(double *x, double *y, size_t n, double cos_angle,
+                    double sin_angle, vector_t point) {
+#ifdef __x86_64__
+  if (n >= SIMD_MIN_POINTS) {
+    if (has_avx2()) {
+      rotate_avx2(x, y, n, cos_angle, sin_angle, point);
+    } else {
+      rotate_sse2(x, y, n, cos_angle, sin_angle, point);
+    }
+    return;
+  }
+#endif
+  rotate_scalar(x, y, n, cos_angle, sin_angle, point);
+}
+
+vector_t vec_project_all(const double *x, const double *y, size_t n,
+                         vector_t axis) {
+#ifdef __x86_64__
+  if (n >= SIMD_MIN_POINTS) {
+    return has_avx2() ? project_avx2(x, y, n, axis)
+                      : project_sse2(x, y, n, axis);
+  }
+#endif
+  return project_scalar(x, y, n, axis, (vector_t){DBL_MAX, -DBL_MAX});
+}
+
+void vec_magnitude_all(const double *x, const double *y, size_t n,
+                       double *magnitudes) {
+#ifdef __x86_64__
+  if (n >= SIMD_MIN_POINTS) {
+    if (has_avx2()) {
+      magnitude_avx2(x, y, n, magnitudes);
+    } else {
+      magnitude_sse2(x, y, n, magnitudes);
+    }
+    return;
+  }
+#endif
+  magnitude_scalar(x, y, n, magnitudes);
+}
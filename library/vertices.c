@@ -0,0 +1,179 @@
+#include "vertices.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct vertices {
+  size_t capacity;
+  size_t size;
+  double *x;
+  double *y;
+  allocator_t allocator;
+} vertices_t;
+
+vertices_t *vertices_init_with_allocator(size_t initial_size,
+                                         allocator_t allocator) {
+  initial_size = initial_size ? initial_size : 1;
+  vertices_t *vertices = allocator.alloc(allocator.context, sizeof(vertices_t));
+  assert(vertices != NULL);
+  size_t bytes = initial_size * sizeof(double);
+  vertices->x = allocator.alloc(allocator.context, bytes);
+  vertices->y = allocator.alloc(allocator.context, bytes);
+  assert(vertices->x != NULL && vertices->y != NULL);
+  vertices->capacity = initial_size;
+  vertices->size = 0;
+  vertices->allocator = allocator;
+  return vertices;
+}
+
+vertices_t *vertices_init(size_t initial_size) {
+  return vertices_init_with_allocator(initial_size, malloc_allocator());
+}
+
+vertices_t *vertices_from_list(list_t *shape) {
+  size_t n = list_size(shape);
+  vertices_t *vertices = vertices_init(n);
+  for (size_t i = 0; i < n; i++) {
+    vertices_add(vertices, *(vector_t *)list_get(shape, i));
+  }
+  return vertices;
+}
+
+list_t *vertices_to_list(vertices_t *vertices) {
+  list_t *shape = list_init(vertices->size, (free_func_t)free);
+  for (size_t i = 0; i < vertices->size; i++) {
+    vector_t *vertex = malloc(sizeof(vector_t));
+    assert(vertex != NULL);
+    *vertex = (vector_t){vertices->x[i], vertices->y[i]};
+    list_add(shape, vertex);
+  }
+  return shape;
+}
+
+vertices_t *vertices_copy(vertices_t *vertices) {
+  vertices_t *copy = vertices_init(vertices->size);
+  for (size_t i = 0; i < vertices->size; i++) {
+    copy->x[i] = vertices->x[i];
+    copy->y[i] = vertices->y[i];
+  }
+  copy->size = vertices->size;
+  return copy;
+}
+
+void vertices_free(vertices_t *vertices) {
+  allocator_t allocator = vertices->allocator;
+  allocator.release(allocator.context, vertices->x);
+  allocator.release(allocator.context, vertices->y);
+  allocator.release(allocator.context, vertices);
+}
+
+size_t vertices_size(vertices_t *vertices) { return vertices->size; }
+
+vector_t vertices_get(vertices_t *vertices, size_t index) {
+  assert(index < vertices->size);
+  return (vector_t){vertices->x[index], vertices->y[index]};
+}
+
+// Moves the first size coordinates of an array into a new one of capacity
+double *grow_array(allocator_t allocator, double *array, size_t size,
+                   size_t capacity) {
+  double *grown = allocator.alloc(allocator.context, capacity * sizeof(double));
+  assert(grown != NULL);
+  memcpy(grown, array, size * sizeof(double));
+  allocator.release(allocator.context, array);
+  return grown;
+}
+
+void vertices_add(vertices_t *vertices, vector_t vertex) {
+  if (vertices->size >= vertices->capacity) {
+    vertices->capacity *= 2;
+    vertices->x = grow_array(vertices->allocator, vertices->x, vertices->size,
+                             vertices->capacity);
+    vertices->y = grow_array(vertices->allocator, vertices->y, vertices->size,
+                             vertices->capacity);
+  }
+  vertices->x[vertices->size] = vertex.x;
+  vertices->y[vertices->size] = vertex.y;
+  vertices->size++;
+}
+
+const double *vertices_x(vertices_t *vertices) { return vertices->x; }
+
+const double *vertices_y(vertices_t *vertices) { return vertices->y; }
+
+void vertices_normals(vertices_t *vertices, vertices_t *normals) {
+  size_t n = vertices->size;
+  normals->size = 0;
+  for (size_t i = 0; i < n; i++) {
+    size_t j = i + 1 < n ? i + 1 : 0;
+    vector_t normal = {vertices->y[i] - vertices->y[j],
+                       vertices->x[j] - vertices->x[i]};
+    vertices_add(normals, vec_unit(normal));
+  }
+}
+
+double vertices_area(vertices_t *vertices) {
+  size_t n = vertices->size;
+  double *x = vertices->x, *y = vertices->y;
+  double sum = 0;
+  for (size_t i = 0; i < n; i++) {
+    size_t j = i + 1 < n ? i + 1 : 0;
+    sum += (y[j] + y[i]) * (x[i] - x[j]);
+  }
+  return sum / 2;
+}
+
+vector_t vertices_centroid(vertices_t *vertices) {
+  size_t n = vertices->size;
+  double *x = vertices->x, *y = vertices->y;
+  vector_t centroid = VEC_ZERO;
+  for (size_t i = 0; i < n; i++) {
+    size_t j = i + 1 < n ? i + 1 : 0;
+    double cross = x[i] * y[j] - x[j] * y[i];
+    centroid.x += (x[i] + x[j]) * cross;
+    centroid.y += (y[i] + y[j]) * cross;
+  }
+  double area = vertices_area(vertices);
+  centroid.x /= (6 * area);
+  centroid.y /= (6 * area);
+  return centroid;
+}
+
+vector_t vertices_center(vertices_t *vertices) {
+  vector_t center = VEC_ZERO;
+  for (size_t i = 0; i < vertices->size; i++) {
+    center.x += vertices->x[i];
+    center.y += vertices->y[i];
+  }
+  center.x /= vertices->size;
+  center.y /= vertices->size;
+  return center;
+}
+
+void vertices_translate(vertices_t *vertices, vector_t translation) {
+  vec_translate_all(vertices->x, vertices->y, vertices->size, translation);
+}
+
+void vertices_rotate(vertices_t *vertices, double angle, vector_t point) {
+  vec_rotate_all(vertices->x, vertices->y, vertices->size, cos(angle),
+                 sin(angle), point);
+}
+
+void vertices_stretch_x(vertices_t *vertices, double factor) {
+  for (size_t i = 0; i < vertices->size; i++) {
+    vertices->x[i] *= factor;
+  }
+}
+
+void vertices_reflect_x(vertices_t *vertices, double x0) {
+  for (size_t i = 0; i < vertices->size; i++) {
+    vertices->x[i] = 2 * x0 - vertices->x[i];
+  }
+}
+
+void vertices_reflect_y(vertices_t *vertices, double y0) {
+  for (size_t i = 0; i < vertices->size; i++) {
+    vertices->y[i] = 2 * y0 - vertices->y[i];
+  }
+}
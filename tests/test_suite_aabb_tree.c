@@ -0,0 +1,200 @@
+#include "aabb_tree.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+const size_t LEAVES = 500;
+
+aabb_t random_box() {
+  vector_t min = {rand() % 1000, rand() % 1000};
+  vector_t size = {rand() % 20 + 1, rand() % 20 + 1};
+  return (aabb_t){min, vec_add(min, size)};
+}
+
+bool count_leaf(size_t leaf, void *aux) {
+  *(size_t *)aux += 1;
+  return true;
+}
+
+bool stop_at_leaf(size_t leaf, void *aux) {
+  *(size_t *)aux += 1;
+  return false;
+}
+
+typedef struct {
+  aabb_tree_t *tree;
+  aabb_t *boxes;
+  size_t visited[8];
+  size_t visits;
+} ray_record_t;
+
+// Records the index of the box in each leaf a ray visits, and hits the box
+// where the ray, which goes along +x, enters it
+double record_hit(size_t leaf, double max_distance, void *aux) {
+  ray_record_t *record = aux;
+  aabb_t *box = aabb_tree_get_data(record->tree, leaf);
+  assert(record->visits < 8);
+  record->visited[record->visits++] = box - record->boxes;
+  return box->min.x;
+}
+
+bool was_visited(ray_record_t *record, size_t leaf) {
+  for (size_t i = 0; i < record->visits; i++) {
+    if (record->visited[i] == leaf) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Counts the leaves whose boxes overlap a box by checking every box
+size_t count_overlaps(aabb_t *boxes, bool *live, size_t n, aabb_t box) {
+  size_t count = 0;
+  for (size_t i = 0; i < n; i++) {
+    count += live[i] && aabb_overlap(boxes[i], box);
+  }
+  return count;
+}
+
+// Tests that queries find the same boxes as checking every box, while leaves
+// are added, moved and removed
+void test_query_matches_brute_force() {
+  srand(1);
+  aabb_tree_t *tree = aabb_tree_init(0);
+  aabb_t *boxes = malloc(2 * LEAVES * sizeof(aabb_t));
+  bool *live = calloc(2 * LEAVES, sizeof(bool));
+  size_t *leaves = malloc(LEAVES * sizeof(size_t));
+  for (size_t i = 0; i < LEAVES; i++) {
+    aabb_t box = random_box();
+    leaves[i] = aabb_tree_insert(tree, box, NULL);
+    assert(leaves[i] < 2 * LEAVES);
+    boxes[leaves[i]] = box;
+    live[leaves[i]] = true;
+  }
+  assert(aabb_tree_size(tree) == LEAVES);
+  for (size_t round = 0; round < 3; round++) {
+    for (size_t i = 0; i < 100; i++) {
+      aabb_t box = random_box();
+      box.max = vec_add(box.max, (vector_t){50, 50});
+      size_t count = 0;
+      aabb_tree_query(tree, box, count_leaf, &count);
+      assert(count == count_overlaps(boxes, live, 2 * LEAVES, box));
+    }
+    // Move half of the leaves and remove a tenth
+    for (size_t i = 0; i < LEAVES; i += 2) {
+      if (!live[leaves[i]]) {
+        continue;
+      }
+      aabb_t box = random_box();
+      aabb_tree_move(tree, leaves[i], box, VEC_ZERO);
+      boxes[leaves[i]] = box;
+      assert(vec_equal(aabb_tree_get_box(tree, leaves[i]).min, box.min));
+    }
+    for (size_t i = round; i < LEAVES; i += 10) {
+      if (live[leaves[i]]) {
+        aabb_tree_remove(tree, leaves[i]);
+        live[leaves[i]] = false;
+      }
+    }
+  }
+  // Stopping early visits one leaf
+  size_t count = 0;
+  aabb_tree_query(tree, (aabb_t){{0, 0}, {1100, 1100}}, stop_at_leaf, &count);
+  assert(count == 1);
+  free(leaves);
+  free(live);
+  free(boxes);
+  aabb_tree_free(tree);
+}
+
+// Tests that the tree stays shallow when leaves arrive in sorted order,
+// which would make an unbalanced tree into a list
+void test_balanced() {
+  aabb_tree_t *tree = aabb_tree_init(0);
+  assert(aabb_tree_height(tree) == -1);
+  for (size_t i = 0; i < 1024; i++) {
+    aabb_tree_insert(tree, (aabb_t){{i, 0}, {i + 1, 1}}, NULL);
+  }
+  assert(aabb_tree_size(tree) == 1024);
+  // A perfectly balanced tree of 1024 leaves has height 10
+  assert(aabb_tree_height(tree) <= 20);
+  aabb_tree_free(tree);
+}
+
+// Tests that a ray or circle only visits the boxes it passes through within
+// its length, and none beyond the nearest hit
+void test_raycast() {
+  aabb_tree_t *tree = aabb_tree_init(0);
+  aabb_t boxes[4] = {{{10, -1}, {11, 1}},
+                     {{5, 2}, {6, 3}},
+                     {{20, -5}, {21, 5}},
+                     {{-10, -1}, {-9, 1}}};
+  for (size_t i = 0; i < 4; i++) {
+    size_t leaf = aabb_tree_insert(tree, boxes[i], &boxes[i]);
+    assert(aabb_tree_get_data(tree, leaf) == &boxes[i]);
+  }
+
+  ray_record_t record = {.tree = tree, .boxes = boxes, .visits = 0};
+  aabb_tree_raycast(tree, VEC_ZERO, (vector_t){1, 0}, 0, 100, record_hit,
+                    &record);
+  assert(was_visited(&record, 0));
+  assert(!was_visited(&record, 1) && !was_visited(&record, 3));
+
+  record.visits = 0;
+  aabb_tree_raycast(tree, VEC_ZERO, (vector_t){1, 0}, 0, 15, record_hit,
+                    &record);
+  assert(record.visits == 1 && record.visited[0] == 0);
+
+  // A circle of radius 2.5 reaches the box above the ray, but not the one
+  // ahead of it, within 7
+  record.visits = 0;
+  aabb_tree_raycast(tree, VEC_ZERO, (vector_t){1, 0}, 2.5, 7, record_hit,
+                    &record);
+  assert(record.visits == 1 && record.visited[0] == 1);
+  aabb_tree_free(tree);
+}
+
+// Tests that a leaf's box is fattened, and only changes when the leaf moves
+// out of it
+void test_fat_boxes() {
+  aabb_tree_t *tree = aabb_tree_init(0.5);
+  size_t leaf = aabb_tree_insert(tree, (aabb_t){{0, 0}, {2, 1}}, NULL);
+  aabb_t box = aabb_tree_get_box(tree, leaf);
+  assert(vec_equal(box.min, (vector_t){-1, -1}));
+  assert(vec_equal(box.max, (vector_t){3, 2}));
+
+  // Still inside, so nothing changes
+  assert(!aabb_tree_move(tree, leaf, (aabb_t){{0.5, -0.5}, {2.5, 0.5}},
+                         (vector_t){10, 10}));
+  assert(vec_equal(aabb_tree_get_box(tree, leaf).max, (vector_t){3, 2}));
+  // Out of it, so the new box is fattened and stretched along the
+  // displacement
+  assert(aabb_tree_move(tree, leaf, (aabb_t){{2, 0}, {4, 1}},
+                        (vector_t){-2, 4}));
+  box = aabb_tree_get_box(tree, leaf);
+  assert(vec_equal(box.min, (vector_t){-1, -1}));
+  assert(vec_equal(box.max, (vector_t){5, 6}));
+
+  size_t count = 0;
+  aabb_tree_query(tree, (aabb_t){{-0.5, 5}, {-0.5, 5}}, count_leaf, &count);
+  assert(count == 1);
+  aabb_tree_free(tree);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_query_matches_brute_force)
+  DO_TEST(test_balanced)
+  DO_TEST(test_raycast)
+  DO_TEST(test_fat_boxes)
+
+  puts("aabb_tree_test PASS");
+}
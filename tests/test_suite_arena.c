@@ -0,0 +1,101 @@
+#include "arena.h"
+#include "list.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+const size_t TEST_CHUNK = 16384;
+
+// Tests that blocks of every size are aligned, hold what is written to them
+// without overlapping, and come from a few chunks
+void test_alloc() {
+  arena_t *arena = arena_init(TEST_CHUNK);
+  unsigned char *blocks[200];
+  size_t sizes[200];
+  for (size_t i = 0; i < 200; i++) {
+    sizes[i] = 1 + (i * 37) % 300;
+    blocks[i] = arena_alloc(arena, sizes[i]);
+    assert((uintptr_t)blocks[i] % 16 == 0);
+    memset(blocks[i], (int)i, sizes[i]);
+  }
+  for (size_t i = 0; i < 200; i++) {
+    for (size_t j = 0; j < sizes[i]; j++) {
+      assert(blocks[i][j] == (unsigned char)i);
+    }
+  }
+  arena_stats_t stats = arena_get_stats(arena);
+  assert(stats.allocations == 200);
+  assert(stats.reuses == 0 && stats.releases == 0);
+  assert(stats.chunks > 0 && stats.chunks <= 4);
+  arena_free(arena);
+}
+
+// Tests that a block given back is handed out again for a block of the same
+// size, but not for a bigger one
+void test_release() {
+  arena_t *arena = arena_init(TEST_CHUNK);
+  void *block = arena_alloc(arena, 24);
+  void *other = arena_alloc(arena, 24);
+  arena_release(block);
+  arena_release(NULL);
+  assert(arena_alloc(arena, 100) != block);
+  assert(arena_alloc(arena, 20) == block);
+  assert(arena_alloc(arena, 24) != other);
+  arena_stats_t stats = arena_get_stats(arena);
+  assert(stats.allocations == 5 && stats.reuses == 1 && stats.releases == 1);
+
+  // A block too big for any pool gets a chunk of its own
+  size_t chunks = stats.chunks;
+  unsigned char *big = arena_alloc(arena, 3 * TEST_CHUNK);
+  memset(big, 1, 3 * TEST_CHUNK);
+  assert(arena_get_stats(arena).chunks == chunks + 1);
+  arena_release(big);
+
+  int *moved = arena_realloc(arena, NULL, 0, 2 * sizeof(int));
+  moved[0] = 3;
+  moved[1] = 4;
+  moved = arena_realloc(arena, moved, 2 * sizeof(int), 100 * sizeof(int));
+  assert(moved[0] == 3 && moved[1] == 4);
+  arena_free(arena);
+}
+
+// Tests that a list can grow and be freed in an arena, taking a few chunks
+// rather than a malloc() for each time it grows
+void test_list_in_arena() {
+  arena_t *arena = arena_init(TEST_CHUNK);
+  list_t *list = list_init_with_allocator(1, arena_release,
+                                          arena_allocator(arena));
+  for (size_t i = 0; i < 1000; i++) {
+    size_t *value = arena_alloc(arena, sizeof(size_t));
+    *value = i;
+    list_add(list, value);
+  }
+  for (size_t i = 0; i < 1000; i++) {
+    assert(*(size_t *)list_get(list, i) == i);
+  }
+  list_free(list);
+  arena_stats_t stats = arena_get_stats(arena);
+  assert(stats.releases == stats.allocations);
+  // The values and smaller arrays fill three chunks, and the two biggest
+  // arrays get their own
+  assert(stats.chunks <= 5);
+  arena_free(arena);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_alloc)
+  DO_TEST(test_release)
+  DO_TEST(test_list_in_arena)
+
+  puts("arena_test PASS");
+}
@@ -122,6 +122,26 @@ void test_body_tick() {
   body_free(body);
 }
 
+void test_body_interpolated_centroid() {
+  body_t *body = body_init_circle((vector_t){1, 1}, 1, 1, (rgb_color_t){0});
+  assert(vec_isclose(body_get_interpolated_centroid(body, 0.5),
+                     (vector_t){1, 1}));
+  body_set_velocity(body, (vector_t){2, 0});
+  body_save_centroid(body);
+  body_tick(body, 1);
+  assert(vec_isclose(body_get_interpolated_centroid(body, 0),
+                     (vector_t){1, 1}));
+  assert(vec_isclose(body_get_interpolated_centroid(body, 0.25),
+                     (vector_t){1.5, 1}));
+  assert(vec_isclose(body_get_interpolated_centroid(body, 1),
+                     (vector_t){3, 1}));
+  // Placing a body doesn't interpolate from where it was
+  body_set_centroid(body, (vector_t){10, 10});
+  assert(vec_isclose(body_get_interpolated_centroid(body, 0),
+                     (vector_t){10, 10}));
+  body_free(body);
+}
+
 void test_infinite_mass() {
   list_t *shape = list_init(10, free);
   vector_t *v = malloc(sizeof(*v));
@@ -179,6 +199,101 @@ void test_forces() {
   body_free(body);
 }
 
+// Tests that a shape view borrows the body's vertices and follows the body
+void test_body_shape_view() {
+  vector_t v[] = {{1, 1}, {2, 1}, {2, 2}, {1, 2}};
+  const size_t VERTICES = sizeof(v) / sizeof(*v);
+  list_t *shape = list_init(0, free);
+  for (size_t i = 0; i < VERTICES; i++) {
+    vector_t *list_v = malloc(sizeof(*list_v));
+    *list_v = v[i];
+    list_add(shape, list_v);
+  }
+  body_t *body = body_init(shape, 1, (rgb_color_t){0, 0, 0});
+  shape_view_t view = body_get_shape_view(body);
+  assert(view.size == VERTICES);
+  for (size_t i = 0; i < VERTICES; i++) {
+    assert(vec_isclose((vector_t){view.x[i], view.y[i]}, v[i]));
+  }
+  body_set_centroid(body, (vector_t){5, 5});
+  body_rotate(body, M_PI / 4);
+  view = body_get_shape_view(body);
+  shape = body_get_shape(body);
+  assert(view.size == list_size(shape));
+  for (size_t i = 0; i < VERTICES; i++) {
+    assert(vec_equal((vector_t){view.x[i], view.y[i]},
+                     *(vector_t *)list_get(shape, i)));
+  }
+  list_free(shape);
+  aabb_t bounds = body_get_bounds(body);
+  assert(vec_isclose(bounds.min, (vector_t){5 - sqrt(2) / 2, 5 - sqrt(2) / 2}));
+  assert(vec_isclose(bounds.max, (vector_t){5 + sqrt(2) / 2, 5 + sqrt(2) / 2}));
+  body_free(body);
+}
+
+// Tests that the cached bounds and edge normals follow the body
+void test_body_cached_geometry() {
+  vector_t v[] = {{-1, -1}, {+1, -1}, {+1, +1}, {-1, +1}};
+  list_t *shape = list_init(4, free);
+  for (size_t i = 0; i < 4; i++) {
+    vector_t *list_v = malloc(sizeof(*list_v));
+    *list_v = v[i];
+    list_add(shape, list_v);
+  }
+  body_t *body = body_init(shape, 1, (rgb_color_t){0, 0, 0});
+  body_translate(body, (vector_t){3, 4});
+  aabb_t bounds = body_get_bounds(body);
+  assert(vec_isclose(bounds.min, (vector_t){2, 3}));
+  assert(vec_isclose(bounds.max, (vector_t){4, 5}));
+  shape_view_t view = body_get_shape_view(body);
+  assert(view.nx != NULL && view.ny != NULL);
+  assert(vec_isclose((vector_t){view.nx[0], view.ny[0]}, (vector_t){0, 1}));
+
+  body_rotate(body, M_PI / 4);
+  bounds = body_get_bounds(body);
+  assert(vec_isclose(bounds.min, (vector_t){3 - sqrt(2), 4 - sqrt(2)}));
+  assert(vec_isclose(bounds.max, (vector_t){3 + sqrt(2), 4 + sqrt(2)}));
+  view = body_get_shape_view(body);
+  assert(vec_isclose((vector_t){view.nx[0], view.ny[0]},
+                     (vector_t){-sqrt(2) / 2, sqrt(2) / 2}));
+
+  body_stretch_x(body, 2);
+  bounds = body_get_bounds(body);
+  assert(vec_isclose(bounds.min, (vector_t){3 - 2 * sqrt(2), 4 - sqrt(2)}));
+  assert(vec_isclose(bounds.max, (vector_t){3 + 2 * sqrt(2), 4 + sqrt(2)}));
+  view = body_get_shape_view(body);
+  double x0 = view.x[1] - view.x[0], y0 = view.y[1] - view.y[0];
+  assert(isclose(x0 * view.nx[0] + y0 * view.ny[0], 0));
+  body_free(body);
+}
+
+void test_body_circle() {
+  body_t *body =
+      body_init_circle((vector_t){1, 2}, 3, 4, (rgb_color_t){0, 0, 0});
+  assert(vec_equal(body_get_centroid(body), (vector_t){1, 2}));
+  assert(body_get_mass(body) == 4);
+  shape_view_t view = body_get_shape_view(body);
+  assert(view.kind == SHAPE_CIRCLE);
+  assert(vec_equal(view.center, (vector_t){1, 2}) && view.radius == 3);
+  body_set_velocity(body, (vector_t){1, 0});
+  body_tick(body, 2);
+  body_rotate_about_point(body, M_PI / 2, (vector_t){0, 2});
+  assert(vec_isclose(body_get_centroid(body), (vector_t){0, 5}));
+  aabb_t bounds = body_get_bounds(body);
+  assert(vec_isclose(bounds.min, (vector_t){-3, 2}));
+  assert(vec_isclose(bounds.max, (vector_t){3, 8}));
+  // The list shape is a polygon approximating the circle
+  list_t *shape = body_get_shape(body);
+  assert(list_size(shape) > 3);
+  for (size_t i = 0; i < list_size(shape); i++) {
+    vector_t r =
+        vec_subtract(*(vector_t *)list_get(shape, i), (vector_t){0, 5});
+    assert(isclose(vec_dot(r, r), 9));
+  }
+  list_free(shape);
+  body_free(body);
+}
+
 void test_body_remove() {
   list_t *shape = list_init(3, free);
   vector_t *v = malloc(sizeof(*v));
@@ -260,8 +375,12 @@ int main(int argc, char *argv[]) {
   DO_TEST(test_body_init)
   DO_TEST(test_body_setters)
   DO_TEST(test_body_tick)
+  DO_TEST(test_body_interpolated_centroid)
   DO_TEST(test_infinite_mass)
   DO_TEST(test_forces)
+  DO_TEST(test_body_shape_view)
+  DO_TEST(test_body_cached_geometry)
+  DO_TEST(test_body_circle)
   DO_TEST(test_body_remove)
   DO_TEST(test_body_info)
   DO_TEST(test_body_info_freer)
@@ -1,8 +1,163 @@
+#include "collision.h"
 #include "test_util.h"
 #include <assert.h>
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+list_t *make_square(vector_t center) {
+  vector_t v[] = {{-1, -1}, {+1, -1}, {+1, +1}, {-1, +1}};
+  list_t *shape = list_init(4, free);
+  for (size_t i = 0; i < 4; i++) {
+    vector_t *list_v = malloc(sizeof(*list_v));
+    *list_v = vec_add(v[i], center);
+    list_add(shape, list_v);
+  }
+  return shape;
+}
+
+void test_find_collision() {
+  list_t *square1 = make_square(VEC_ZERO);
+  list_t *square2 = make_square((vector_t){1.5, 0.5});
+  // The squares overlap least along the x axis
+  collision_info_t collision = find_collision(square1, square2);
+  assert(collision.collided);
+  assert(isclose(fabs(collision.axis.x), 1) && isclose(collision.axis.y, 0));
+  collision = find_collision(square2, square1);
+  assert(collision.collided);
+  assert(isclose(fabs(collision.axis.x), 1) && isclose(collision.axis.y, 0));
+  list_t *square3 = make_square((vector_t){0, 2.5});
+  assert(!find_collision(square1, square3).collided);
+  assert(!find_collision(square3, square1).collided);
+  list_free(square1);
+  list_free(square2);
+  list_free(square3);
+}
+
+// Tests that find_collision_view() agrees with find_collision()
+void test_find_collision_view() {
+  double x1[] = {-1, +1, +1, -1}, y1[] = {-1, -1, +1, +1};
+  double x2[] = {0.5, 2, 2}, y2[] = {0, -1, 1};
+  shape_view_t square = {.x = x1, .y = y1, .size = 4};
+  shape_view_t triangle = {.x = x2, .y = y2, .size = 3};
+  collision_info_t collision = find_collision_view(square, triangle);
+  assert(collision.collided);
+  assert(isclose(fabs(collision.axis.x), 1) && isclose(collision.axis.y, 0));
+
+  list_t *square_list = make_square(VEC_ZERO);
+  for (double x = -4; x <= 4; x += 0.25) {
+    list_t *other_list = make_square((vector_t){x, x / 2});
+    vertices_t *other = vertices_from_list(other_list);
+    collision_info_t expected = find_collision(square_list, other_list);
+    collision_info_t actual = find_collision_view(square, vertices_view(other));
+    assert(expected.collided == actual.collided);
+    assert(vec_equal(expected.axis, actual.axis));
+    vertices_free(other);
+    list_free(other_list);
+  }
+  list_free(square_list);
+}
+
+void test_find_bounds() {
+  double x[] = {0.5, 2, 2}, y[] = {0, -1, 1};
+  aabb_t bounds = find_bounds((shape_view_t){.x = x, .y = y, .size = 3});
+  assert(vec_equal(bounds.min, (vector_t){0.5, -1}));
+  assert(vec_equal(bounds.max, (vector_t){2, 1}));
+  bounds = find_bounds(circle_view((vector_t){1, 2}, 3));
+  assert(vec_equal(bounds.min, (vector_t){-2, -1}));
+  assert(vec_equal(bounds.max, (vector_t){4, 5}));
+}
+
+void test_circle_circle_collision() {
+  shape_view_t circle1 = circle_view((vector_t){0, 0}, 1);
+  shape_view_t circle2 = circle_view((vector_t){1.2, 1.6}, 1.5);
+  collision_info_t collision = find_collision_view(circle1, circle2);
+  assert(collision.collided);
+  assert(vec_isclose(collision.axis, (vector_t){0.6, 0.8}));
+  assert(isclose(collision.depth, 0.5));
+  collision = find_collision_view(circle2, circle1);
+  assert(collision.collided);
+  assert(vec_isclose(collision.axis, (vector_t){-0.6, -0.8}));
+  assert(isclose(collision.depth, 0.5));
+  // Circles which only touch are not colliding
+  shape_view_t circle3 = circle_view((vector_t){0, 2}, 1);
+  assert(!find_collision_view(circle1, circle3).collided);
+  shape_view_t circle4 = circle_view((vector_t){3, 0}, 1);
+  assert(!find_collision_view(circle1, circle4).collided);
+}
+
+void test_circle_polygon_collision() {
+  double x[] = {-1, +1, +1, -1}, y[] = {-1, -1, +1, +1};
+  shape_view_t square = {.x = x, .y = y, .size = 4};
+  // Against an edge, the axis is the edge normal
+  shape_view_t circle = circle_view((vector_t){0, 1.5}, 1);
+  collision_info_t collision = find_collision_view(square, circle);
+  assert(collision.collided);
+  assert(vec_isclose(collision.axis, (vector_t){0, 1}));
+  assert(isclose(collision.depth, 0.5));
+  collision = find_collision_view(circle, square);
+  assert(collision.collided);
+  assert(vec_isclose(collision.axis, (vector_t){0, -1}));
+  assert(isclose(collision.depth, 0.5));
+  // Against a corner, the axis points from the corner to the center
+  circle = circle_view((vector_t){1.6, 1.8}, 1.5);
+  collision = find_collision_view(square, circle);
+  assert(collision.collided);
+  assert(vec_isclose(collision.axis, (vector_t){0.6, 0.8}));
+  assert(isclose(collision.depth, 0.5));
+  // Near a corner, the edge normals overlap, but the circle misses
+  circle = circle_view((vector_t){1.8, 1.8}, 1);
+  assert(!find_collision_view(square, circle).collided);
+  assert(!find_collision_view(circle, square).collided);
+  circle = circle_view((vector_t){-3, 0}, 1);
+  assert(!find_collision_view(square, circle).collided);
+}
+
+void test_time_of_impact() {
+  // Two circles closing at 4 units per second from 6 apart touch at t = 1
+  shape_view_t circle1 = circle_view((vector_t){0, 0}, 1);
+  shape_view_t circle2 = circle_view((vector_t){6, 0}, 1);
+  double time = find_time_of_impact(circle1, (vector_t){1, 0}, circle2,
+                                    (vector_t){-3, 0}, 0, 10);
+  assert(isclose(time, 1));
+  // With slop, they are stopped once they overlap by that much
+  time = find_time_of_impact(circle1, (vector_t){1, 0}, circle2,
+                             (vector_t){-3, 0}, 0.4, 10);
+  assert(isclose(time, 1.1));
+  // Too soon, moving apart, or passing by is no impact
+  assert(isinf(find_time_of_impact(circle1, (vector_t){1, 0}, circle2,
+                                   (vector_t){-3, 0}, 0, 0.5)));
+  assert(isinf(find_time_of_impact(circle1, (vector_t){-1, 0}, circle2,
+                                   VEC_ZERO, 0, 10)));
+  assert(isinf(find_time_of_impact(circle1, (vector_t){1, 3}, circle2,
+                                   VEC_ZERO, 0, 10)));
+  // Overlapping circles have already collided
+  shape_view_t circle3 = circle_view((vector_t){1, 0}, 1);
+  assert(find_time_of_impact(circle1, VEC_ZERO, circle3, VEC_ZERO, 0, 10) ==
+         0);
+
+  // A fast circle hits the face of a thin wall which it would otherwise jump
+  // over in a single tick
+  double x[] = {10, 10.1, 10.1, 10}, y[] = {-5, -5, 5, 5};
+  shape_view_t wall = {.x = x, .y = y, .size = 4};
+  time = find_time_of_impact(circle1, (vector_t){100, 0}, wall, VEC_ZERO, 0,
+                             1);
+  assert(isclose(time, 0.09));
+  // and the wall's corner, from the side
+  time = find_time_of_impact(wall, VEC_ZERO, circle_view((vector_t){0, 6}, 1),
+                             (vector_t){10, 0}, 0, 10);
+  assert(isclose(time, 1));
+  // A moving wall hits a still circle the same way
+  time = find_time_of_impact(wall, (vector_t){-100, 0}, circle1, VEC_ZERO, 0,
+                             1);
+  assert(isclose(time, 0.09));
+  assert(isinf(find_time_of_impact(circle_view((vector_t){0, 7}, 1),
+                                   (vector_t){100, 0}, wall, VEC_ZERO, 0, 1)));
+  // Two polygons are never swept
+  assert(isinf(find_time_of_impact(wall, (vector_t){-100, 0}, wall, VEC_ZERO,
+                                   0, 1)));
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -12,5 +167,12 @@ int main(int argc, char *argv[]) {
     read_testname(argv[1], testname, sizeof(testname));
   }
 
+  DO_TEST(test_find_collision)
+  DO_TEST(test_find_collision_view)
+  DO_TEST(test_find_bounds)
+  DO_TEST(test_circle_circle_collision)
+  DO_TEST(test_circle_polygon_collision)
+  DO_TEST(test_time_of_impact)
+
   puts("collision_test PASS");
 }
\ No newline at end of file
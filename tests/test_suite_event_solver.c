@@ -0,0 +1,126 @@
+#include "event_solver.h"
+#include "shape.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+const double DECELERATION = 2;
+
+// Swaps the velocities of two equal balls, as in a head-on elastic collision
+void swap_velocities(body_t *body1, body_t *body2, vector_t axis, void *aux) {
+  vector_t v1 = body_get_velocity(body1);
+  vector_t v2 = body_get_velocity(body2);
+  body_add_impulse(body1, vec_subtract(v2, v1));
+  body_add_impulse(body2, vec_subtract(v1, v2));
+}
+
+// Bounces a ball straight back off a wall
+void bounce(body_t *wall, body_t *ball, vector_t axis, void *aux) {
+  body_set_velocity(ball, vec_negate(body_get_velocity(ball)));
+  *(int *)aux += 1;
+}
+
+body_t *make_ball(scene_t *scene, vector_t center, vector_t velocity) {
+  body_t *ball = body_init_circle(center, 1, 1, (rgb_color_t){0, 0, 0});
+  body_set_type(ball, 0);
+  body_set_velocity(ball, velocity);
+  scene_add_body(scene, ball);
+  return ball;
+}
+
+// Tests that a ball slows down and stops in one event, where it would
+// under constant deceleration
+void test_ball_stops() {
+  scene_t *scene = scene_init();
+  body_t *ball = make_ball(scene, VEC_ZERO, (vector_t){6, 8});
+  event_solver_t *solver = event_solver_init(scene, DECELERATION);
+  // Part of the way, it is still moving
+  assert(isclose(event_solver_step(solver, 1), 1));
+  assert(vec_isclose(body_get_centroid(ball), (vector_t){5.4, 7.2}));
+  assert(vec_isclose(body_get_velocity(ball), (vector_t){4.8, 6.4}));
+  assert(event_solver_events(solver) == 0);
+  // It stops after 5 seconds, having gone 10^2 / (2 * 2) = 25
+  assert(isclose(event_solver_step(solver, INFINITY), 4));
+  assert(isclose(event_solver_get_time(solver), 5));
+  assert(vec_isclose(body_get_centroid(ball), (vector_t){15, 20}));
+  assert(vec_equal(body_get_velocity(ball), VEC_ZERO));
+  assert(event_solver_events(solver) == 1);
+  // Then nothing happens
+  assert(event_solver_step(solver, INFINITY) == 0);
+  event_solver_free(solver);
+  scene_free(scene);
+}
+
+// Tests that a moving ball hands its velocity to a still one when they meet
+void test_ball_ball() {
+  scene_t *scene = scene_init();
+  body_t *ball1 = make_ball(scene, VEC_ZERO, (vector_t){10, 0});
+  body_t *ball2 = make_ball(scene, (vector_t){11, 0}, VEC_ZERO);
+  scene_add_collision_handler(scene, 1 << 0, 1 << 0, swap_velocities, NULL,
+                              NULL, NULL);
+  event_solver_t *solver = event_solver_init(scene, DECELERATION);
+  // The balls touch once the first has gone 9, at 10t - t^2 = 9
+  double dt = event_solver_step(solver, INFINITY);
+  assert(fabs(dt - 1) < 1e-2);
+  assert(event_solver_events(solver) == 1);
+  assert(vec_equal(body_get_velocity(ball1), VEC_ZERO));
+  assert(fabs(body_get_velocity(ball2).x - 8) < 1e-2);
+  // The second ball rolls 8^2 / 4 = 16 further and stops
+  while (event_solver_step(solver, INFINITY) > 0) {
+  }
+  assert(event_solver_events(solver) == 2);
+  assert(fabs(body_get_centroid(ball1).x - 9) < 1e-2);
+  assert(fabs(body_get_centroid(ball2).x - 27) < 1e-1);
+  event_solver_free(solver);
+  scene_free(scene);
+}
+
+// Tests that a ball bounces between two walls until it stops, without
+// being ticked in between
+void test_ball_walls() {
+  scene_t *scene = scene_init();
+  body_t *ball = make_ball(scene, VEC_ZERO, (vector_t){20, 0});
+  vector_t left = {-5, 0}, right = {5, 0};
+  body_t *wall1 = body_init(draw_rectangle(&left, 1, 10), INFINITY,
+                            (rgb_color_t){0, 0, 0});
+  body_t *wall2 = body_init(draw_rectangle(&right, 1, 10), INFINITY,
+                            (rgb_color_t){0, 0, 0});
+  body_set_type(wall1, 1);
+  body_set_type(wall2, 1);
+  scene_add_body(scene, wall1);
+  scene_add_body(scene, wall2);
+  int *bounces = malloc(sizeof(*bounces));
+  *bounces = 0;
+  scene_add_collision_handler(scene, 1 << 1, 1 << 0, bounce, NULL, bounces,
+                              free);
+  event_solver_t *solver = event_solver_init(scene, DECELERATION);
+  while (event_solver_step(solver, INFINITY) > 0) {
+  }
+  // The ball rolls 20^2 / 4 = 100 in all, crossing the 7 units between the
+  // walls 14 times and a bit
+  assert(*bounces == 14);
+  assert(event_solver_events(solver) == 15);
+  assert(isclose(event_solver_get_time(solver), 10));
+  assert(vec_equal(body_get_velocity(ball), VEC_ZERO));
+  vector_t centroid = body_get_centroid(ball);
+  assert(centroid.x > -3.5 && centroid.x < 3.5);
+  event_solver_free(solver);
+  scene_free(scene);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_ball_stops)
+  DO_TEST(test_ball_ball)
+  DO_TEST(test_ball_walls)
+
+  puts("event_solver_test PASS");
+}
@@ -77,6 +77,126 @@ void test_energy_conservation() {
   scene_free(scene);
 }
 
+// Makes a scene of still bodies scattered over a square, at the same places
+// each time
+scene_t *make_gravity_scene(size_t count) {
+  srand(1);
+  scene_t *scene = scene_init();
+  for (size_t i = 0; i < count; i++) {
+    body_t *body = body_init(make_shape(), 1 + rand() % 10,
+                             (rgb_color_t){0, 0, 0});
+    body_set_centroid(body, (vector_t){rand() % 1000, rand() % 1000});
+    scene_add_body(scene, body);
+  }
+  return scene;
+}
+
+// Tests that a gravity field pulls like gravity between every pair of
+// bodies, exactly with theta 0 and nearly with a Barnes-Hut quadtree
+void test_gravity_field() {
+  const size_t N = 50;
+  const double G = 1e3;
+  scene_t *pairs = make_gravity_scene(N);
+  for (size_t i = 0; i < N; i++) {
+    for (size_t j = i + 1; j < N; j++) {
+      create_newtonian_gravity(pairs, G, scene_get_body(pairs, i),
+                               scene_get_body(pairs, j));
+    }
+  }
+  scene_t *direct = make_gravity_scene(N);
+  create_gravity_field(direct, G, 0);
+  scene_t *tree = make_gravity_scene(N);
+  create_gravity_field(tree, G, 0.3);
+  scene_tick(pairs, 1);
+  scene_tick(direct, 1);
+  scene_tick(tree, 1);
+
+  double error = 0, total = 0;
+  for (size_t i = 0; i < N; i++) {
+    vector_t v = body_get_velocity(scene_get_body(pairs, i));
+    vector_t exact = body_get_velocity(scene_get_body(direct, i));
+    assert(vec_within(1e-9 * vec_magnitude(v), exact, v));
+    vector_t difference =
+        vec_subtract(body_get_velocity(scene_get_body(tree, i)), v);
+    error += vec_dot(difference, difference);
+    total += vec_dot(v, v);
+  }
+  assert(error < 1e-4 * total);
+
+  // Removed bodies drop out of the field
+  body_remove(scene_get_body(tree, 0));
+  scene_tick(tree, 1);
+  scene_tick(tree, 1);
+  assert(scene_bodies(tree) == N - 1);
+  scene_free(pairs);
+  scene_free(direct);
+  scene_free(tree);
+}
+
+typedef enum { GRAVITY, SPRING, DRAG, FRICTION } force_kind_t;
+
+// The force the way the force creators found it before they scaled vectors
+// directly, by turning a vector into its angle and back
+vector_t angle_force(force_kind_t kind, double constant, vector_t difference,
+                     vector_t velocity, double mass1, double mass2) {
+  double distance = vec_magnitude(difference);
+  double speed = vec_magnitude(velocity);
+  switch (kind) {
+  case GRAVITY:
+    return vec_init(constant * mass1 * mass2 / (distance * distance),
+                    vec_direction(difference));
+  case SPRING:
+    return vec_init(constant * distance, vec_direction(difference));
+  case DRAG:
+    return vec_init(-constant * speed * speed, vec_direction(velocity));
+  default:
+    return vec_init(-constant * mass1, vec_direction(velocity));
+  }
+}
+
+// Tests that each force creator gives the same force as before it scaled
+// vectors directly, whichever way the bodies are apart or moving
+void test_force_directions() {
+  const vector_t DIFFERENCES[] = {{30, 40}, {-30, 40}, {-30, -40}, {30, -40},
+                                  {0, 50},  {0, -50},  {-50, 0},   {7, -0.1}};
+  const double M1 = 2, M2 = 3;
+  const double CONSTANT = 0.7;
+  const double DT = 1e-3;
+  for (force_kind_t kind = GRAVITY; kind <= FRICTION; kind++) {
+    for (size_t i = 0; i < sizeof(DIFFERENCES) / sizeof(DIFFERENCES[0]);
+         i++) {
+      vector_t difference = DIFFERENCES[i];
+      scene_t *scene = scene_init();
+      body_t *body1 = body_init(make_shape(), M1, (rgb_color_t){0, 0, 0});
+      body_t *body2 = body_init(make_shape(), M2, (rgb_color_t){0, 0, 0});
+      body_set_centroid(body2, difference);
+      // Only drag and friction depend on the velocity, and any other force
+      // is found more precisely from a body starting at rest
+      vector_t velocity = kind >= DRAG ? difference : VEC_ZERO;
+      body_set_velocity(body1, velocity);
+      scene_add_body(scene, body1);
+      scene_add_body(scene, body2);
+      if (kind == GRAVITY) {
+        create_newtonian_gravity(scene, CONSTANT, body1, body2);
+      } else if (kind == SPRING) {
+        create_spring(scene, CONSTANT, body1, body2);
+      } else if (kind == DRAG) {
+        create_drag(scene, CONSTANT, body1);
+      } else {
+        create_gravity_friction(scene, CONSTANT, body1);
+      }
+      scene_tick(scene, DT);
+
+      vector_t force = vec_multiply(
+          M1 / DT, vec_subtract(body_get_velocity(body1), velocity));
+      vector_t expected =
+          angle_force(kind, CONSTANT, difference, velocity, M1, M2);
+      assert(vec_within(1e-9 * vec_magnitude(expected), force, expected));
+      scene_free(scene);
+    }
+  }
+}
+
 body_t *make_triangle_body() {
   list_t *shape = list_init(3, free);
   vector_t *v = malloc(sizeof(*v));
@@ -161,6 +281,8 @@ int main(int argc, char *argv[]) {
 
   DO_TEST(test_spring_sinusoid)
   DO_TEST(test_energy_conservation)
+  DO_TEST(test_gravity_field)
+  DO_TEST(test_force_directions)
   DO_TEST(test_collisions)
   DO_TEST(test_forces_removed)
 
@@ -252,6 +252,47 @@ void test_null_values() {
   list_free(l);
 }
 
+bool is_even(void *value, void *aux) {
+  size_t *calls = aux;
+  (*calls)++;
+  return (size_t)((vector_t *)value)->x % 2 == 0;
+}
+
+// Tests that swap-removing moves the last element into the gap, and that
+// filtering keeps the rest in order
+void test_swap_remove_and_filter() {
+  list_t *l = list_init(1, free);
+  for (size_t i = 0; i < 10; i++) {
+    vector_t *v = malloc(sizeof(*v));
+    *v = (vector_t){i, i};
+    list_add(l, v);
+  }
+  vector_t *v = list_swap_remove(l, 2);
+  assert(vec_equal(*v, (vector_t){2, 2}));
+  free(v);
+  assert(list_size(l) == 9);
+  assert(vec_equal(*(vector_t *)list_get(l, 2), (vector_t){9, 9}));
+  v = list_swap_remove(l, list_size(l) - 1);
+  assert(vec_equal(*v, (vector_t){8, 8}));
+  free(v);
+
+  // 0 1 9 3 4 5 6 7 -> 0 4 6
+  list_t *odd = list_init(1, free);
+  for (size_t i = 0; i < list_size(l); i++) {
+    if ((size_t)((vector_t *)list_get(l, i))->x % 2) {
+      list_add(odd, list_get(l, i));
+    }
+  }
+  size_t calls = 0;
+  assert(list_filter(l, is_even, &calls) == 5);
+  assert(calls == 8 && list_size(l) == 3);
+  assert(vec_equal(*(vector_t *)list_get(l, 0), (vector_t){0, 0}));
+  assert(vec_equal(*(vector_t *)list_get(l, 1), (vector_t){4, 4}));
+  assert(vec_equal(*(vector_t *)list_get(l, 2), (vector_t){6, 6}));
+  list_free(odd);
+  list_free(l);
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -270,6 +311,7 @@ int main(int argc, char *argv[]) {
   DO_TEST(test_full_add)
   DO_TEST(test_empty_remove)
   DO_TEST(test_null_values)
+  DO_TEST(test_swap_remove_and_filter)
 
   puts("list_test PASS");
 }
@@ -1,4 +1,5 @@
 #include "scene.h"
+#include "shape.h"
 #include "test_util.h"
 #include <assert.h>
 #include <math.h>
@@ -228,6 +229,449 @@ void test_reaping() {
   scene_free(scene);
 }
 
+// Records how many times the kernel was called, and with how many terms
+size_t kernel_calls, kernel_terms;
+void count_terms(const force_term_t *terms, size_t count, double dt) {
+  kernel_calls++;
+  kernel_terms = count;
+  for (size_t i = 0; i < count; i++) {
+    body_add_force(terms[i].body1, (vector_t){terms[i].constant, 0});
+  }
+}
+
+// Tests that the terms of a typed force are applied by one call per tick,
+// and are dropped with their bodies
+void test_force_terms() {
+  scene_t *scene = scene_init();
+  body_t *bodies[3];
+  for (size_t i = 0; i < 3; i++) {
+    bodies[i] = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    scene_add_body(scene, bodies[i]);
+    scene_add_force_term(scene, count_terms, i + 1, bodies[i], NULL);
+  }
+  scene_add_force_term(scene, count_terms, 1, bodies[0], bodies[1]);
+  kernel_calls = 0;
+  scene_tick(scene, 1);
+  assert(kernel_calls == 1 && kernel_terms == 4);
+  assert(vec_isclose(body_get_velocity(bodies[0]), (vector_t){2, 0}));
+  assert(vec_isclose(body_get_velocity(bodies[2]), (vector_t){3, 0}));
+
+  body_remove(bodies[1]);
+  scene_tick(scene, 1);
+  scene_tick(scene, 1);
+  assert(kernel_calls == 3 && kernel_terms == 2);
+  scene_free(scene);
+}
+
+void count_forces(void *aux) { *(int *)aux += 1; }
+
+// Adds a force creator on two bodies which counts its calls in counts[index]
+void add_counting_force(scene_t *scene, body_t *body1, body_t *body2,
+                        int *counts, size_t index) {
+  list_t *bodies = list_init(2, NULL);
+  list_add(bodies, body1);
+  list_add(bodies, body2);
+  scene_add_bodies_force_creator(scene, count_forces, &counts[index], bodies,
+                                 NULL);
+}
+
+// Tests that bodies removed in the same tick go together, leaving the rest in
+// order, and take their forces and handles with them
+void test_handles_and_removal() {
+  scene_t *scene = scene_init();
+  body_t *bodies[5];
+  body_handle_t handles[5];
+  for (size_t i = 0; i < 5; i++) {
+    bodies[i] = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    scene_add_body(scene, bodies[i]);
+    handles[i] = scene_get_handle(scene, bodies[i]);
+  }
+  int counts[5] = {0};
+  for (size_t i = 0; i < 4; i++) {
+    add_counting_force(scene, bodies[i], bodies[i + 1], counts, i);
+  }
+  for (size_t i = 0; i < 5; i++) {
+    scene_add_force_term(scene, count_terms, 1, bodies[i], NULL);
+  }
+  // Added before its body, so it isn't in the body's reverse index
+  body_t *late = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  add_counting_force(scene, bodies[0], late, counts, 4);
+  scene_add_body(scene, late);
+
+  body_remove(bodies[1]);
+  body_remove(late);
+  scene_tick(scene, 1);
+  assert(scene_bodies(scene) == 4);
+  size_t kept[] = {0, 2, 3, 4};
+  for (size_t i = 0; i < 4; i++) {
+    assert(scene_get_body(scene, i) == bodies[kept[i]]);
+    assert(scene_get_index(scene, bodies[kept[i]]) == (int)i);
+    assert(scene_get_handle_body(scene, handles[kept[i]]) == bodies[kept[i]]);
+  }
+  assert(scene_get_handle_body(scene, handles[1]) == NULL);
+
+  // A body added in the removed body's slot isn't found by its old handle
+  body_t *added = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  scene_add_body(scene, added);
+  assert(scene_get_handle_body(scene, handles[1]) == NULL);
+  assert(scene_get_handle_body(scene, scene_get_handle(scene, added)) ==
+         added);
+  assert(scene_get_index(scene, added) == 4);
+
+  kernel_calls = 0;
+  scene_tick(scene, 1);
+  // Only the forces between bodies 2, 3 and 4 are left
+  int expected[] = {1, 1, 2, 2, 1};
+  for (size_t i = 0; i < 5; i++) {
+    assert(counts[i] == expected[i]);
+  }
+  assert(kernel_calls == 1 && kernel_terms == 4);
+  scene_free(scene);
+}
+
+typedef struct {
+  int calls;
+  body_t *last1, *last2;
+} handler_aux_t;
+
+void count_collisions(body_t *body1, body_t *body2, vector_t axis,
+                      void *aux) {
+  handler_aux_t *handler_aux = aux;
+  handler_aux->calls++;
+  handler_aux->last1 = body1;
+  handler_aux->last2 = body2;
+}
+
+// Tests that collision handlers are matched by body type and are only called
+// once while two bodies stay in contact
+void test_collision_handler() {
+  scene_t *scene = scene_init();
+  body_t *mover = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_type(mover, 1);
+  scene_add_body(scene, mover);
+  body_t *target = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_type(target, 2);
+  body_set_centroid(target, (vector_t){5, 0});
+  scene_add_body(scene, target);
+  // Overlaps the mover the whole time, but has no matching handler
+  body_t *untyped = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  scene_add_body(scene, untyped);
+  // Another type 2 body which is never reached
+  body_t *far = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_type(far, 2);
+  body_set_centroid(far, (vector_t){100, 100});
+  scene_add_body(scene, far);
+
+  handler_aux_t *aux = malloc(sizeof(*aux));
+  aux->calls = 0;
+  scene_add_collision_handler(scene, 1 << 2, 1 << 1, count_collisions, NULL,
+                              aux, free);
+  // Collisions are checked before the bodies move, so the mover reaches the
+  // target (touching it at x = 3) on the fifth tick
+  body_set_velocity(mover, (vector_t){1, 0});
+  for (int i = 0; i < 4; i++) {
+    scene_tick(scene, 1);
+  }
+  assert(aux->calls == 0);
+  // The mover passes through the target, leaving it at x = 7
+  for (int i = 0; i < 8; i++) {
+    scene_tick(scene, 1);
+    assert(aux->calls == 1);
+  }
+  assert(aux->last1 == target && aux->last2 == mover);
+  // Coming back, it collides again
+  body_set_velocity(mover, (vector_t){-1, 0});
+  for (int i = 0; i < 7; i++) {
+    scene_tick(scene, 1);
+  }
+  assert(aux->calls == 2);
+  scene_free(scene);
+}
+
+// Tests that bodies of infinite mass, which the broad phase keeps apart from
+// the moving bodies, still collide once they are moved or given a velocity
+void test_fixed_bodies_move() {
+  scene_t *scene = scene_init();
+  body_t *ball = body_init_circle(VEC_ZERO, 1, 1, (rgb_color_t){0, 0, 0});
+  body_set_type(ball, 0);
+  scene_add_body(scene, ball);
+  vector_t wall_center = {50, 0};
+  body_t *wall = body_init(draw_rectangle(&wall_center, 2, 20), INFINITY,
+                           (rgb_color_t){0, 0, 0});
+  body_set_type(wall, 1);
+  scene_add_body(scene, wall);
+  vector_t paddle_center = {-50, 0};
+  body_t *paddle = body_init(draw_rectangle(&paddle_center, 2, 20), INFINITY,
+                             (rgb_color_t){0, 0, 0});
+  body_set_type(paddle, 1);
+  scene_add_body(scene, paddle);
+  handler_aux_t *aux = malloc(sizeof(*aux));
+  aux->calls = 0;
+  scene_add_collision_handler(scene, 1 << 1, 1 << 0, count_collisions, NULL,
+                              aux, free);
+
+  scene_tick(scene, 1);
+  assert(aux->calls == 0);
+  body_set_centroid(wall, (vector_t){1.5, 0});
+  scene_tick(scene, 1);
+  assert(aux->calls == 1 && aux->last1 == wall);
+  // The paddle sweeps over the ball within one tick
+  body_set_velocity(paddle, (vector_t){100, 0});
+  scene_tick(scene, 0.5);
+  assert(aux->calls == 2 && aux->last1 == paddle);
+  scene_free(scene);
+}
+
+// Tests that bodies at rest fall asleep, skipping their force creators, and
+// are woken by a velocity or by a body touching them
+void test_sleeping() {
+  scene_t *scene = scene_init();
+  body_t *mover = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_type(mover, 1);
+  scene_add_body(scene, mover);
+  body_t *sleeper = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_type(sleeper, 2);
+  body_set_centroid(sleeper, (vector_t){5, 0});
+  scene_add_body(scene, sleeper);
+  handler_aux_t *aux = malloc(sizeof(*aux));
+  aux->calls = 0;
+  scene_add_collision_handler(scene, 1 << 2, 1 << 1, count_collisions, NULL,
+                              aux, free);
+  int *forces = malloc(sizeof(int));
+  *forces = 0;
+  list_t *bodies = list_init(1, NULL);
+  list_add(bodies, sleeper);
+  scene_add_bodies_force_creator(scene, count_forces, forces, bodies, free);
+
+  for (int i = 0; i < 3; i++) {
+    scene_tick(scene, 1);
+  }
+  assert(scene_is_still(scene));
+  assert(body_is_asleep(mover) && body_is_asleep(sleeper));
+  assert(*forces == 1);
+
+  body_set_velocity(mover, (vector_t){1, 0});
+  assert(!body_is_asleep(mover));
+  // Waking a body is seen before the next tick
+  assert(!scene_is_still(scene));
+  scene_tick(scene, 1);
+  assert(!scene_is_still(scene));
+  assert(body_is_asleep(sleeper) && *forces == 1);
+  // The mover reaches the sleeper on its fifth tick, and wakes it while they
+  // touch
+  for (int i = 0; i < 4; i++) {
+    scene_tick(scene, 1);
+  }
+  assert(aux->calls == 1 && !body_is_asleep(sleeper));
+  scene_tick(scene, 1);
+  assert(*forces == 2);
+  scene_free(scene);
+}
+
+void stop_ball(body_t *wall, body_t *ball, vector_t axis, void *aux) {
+  body_set_velocity(ball, VEC_ZERO);
+  *(int *)aux += 1;
+}
+
+// Tests that a ball too fast to ever overlap a thin wall at the end of a tick
+// is still stopped by it
+void test_no_tunnelling() {
+  scene_t *scene = scene_init();
+  body_t *ball = body_init_circle(VEC_ZERO, 1, 1, (rgb_color_t){0, 0, 0});
+  body_set_type(ball, 0);
+  body_set_velocity(ball, (vector_t){1000, 0});
+  scene_add_body(scene, ball);
+  vector_t wall_center = {50, 0};
+  body_t *wall = body_init(draw_rectangle(&wall_center, 0.1, 20), INFINITY,
+                           (rgb_color_t){0, 0, 0});
+  body_set_type(wall, 1);
+  scene_add_body(scene, wall);
+  int *hits = malloc(sizeof(*hits));
+  *hits = 0;
+  scene_add_collision_handler(scene, 1 << 1, 1 << 0, stop_ball, NULL, hits,
+                              free);
+
+  // The ball would jump from x = 0 to x = 100 in one tick
+  scene_tick(scene, 0.1);
+  assert(*hits == 1);
+  assert(isclose(scene_get_time(scene), 0.1));
+  vector_t centroid = body_get_centroid(ball);
+  assert(centroid.x > 48.9 && centroid.x < 49);
+  assert(vec_equal(body_get_velocity(ball), VEC_ZERO));
+  scene_free(scene);
+}
+
+void bounce_ball(body_t *wall, body_t *ball, vector_t axis, void *aux) {
+  body_set_velocity(ball, vec_negate(body_get_velocity(ball)));
+}
+
+// Tests that a tick split at an impact is still drawn from where the bodies
+// were at its start
+void test_interpolation_across_impacts() {
+  scene_t *scene = scene_init();
+  body_t *ball = body_init_circle(VEC_ZERO, 1, 1, (rgb_color_t){0, 0, 0});
+  body_set_type(ball, 0);
+  body_set_velocity(ball, (vector_t){100, 0});
+  scene_add_body(scene, ball);
+  vector_t wall_center = {6, 0};
+  body_t *wall = body_init(draw_rectangle(&wall_center, 0.1, 20), INFINITY,
+                           (rgb_color_t){0, 0, 0});
+  body_set_type(wall, 1);
+  scene_add_body(scene, wall);
+  scene_add_collision_handler(scene, 1 << 1, 1 << 0, bounce_ball, NULL, NULL,
+                              NULL);
+
+  // The ball reaches the wall about halfway through the tick and comes back
+  // past where it started
+  scene_tick(scene, 0.1);
+  assert(body_get_velocity(ball).x < 0 && body_get_centroid(ball).x < 0);
+  assert(vec_isclose(body_get_interpolated_centroid(ball, 0), VEC_ZERO));
+  scene_free(scene);
+}
+
+// Tests that scene_advance() ticks at a fixed rate whatever the frame times,
+// carrying leftover time over to the next frame
+void test_scene_advance() {
+  scene_t *scene = scene_init();
+  body_t *body = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_velocity(body, (vector_t){4, 0});
+  scene_add_body(scene, body);
+  assert(scene_get_alpha(scene) == 1);
+
+  // A frame shorter than a tick only accumulates time
+  assert(scene_advance(scene, 0.04, 0.1) == 0);
+  assert(vec_isclose(body_get_centroid(body), VEC_ZERO));
+  assert(isclose(scene_get_alpha(scene), 0.4));
+  // The leftover 0.04 makes this frame long enough for two ticks
+  assert(scene_advance(scene, 0.2, 0.1) == 2);
+  assert(isclose(scene_get_dt(scene), 0.1));
+  assert(vec_isclose(body_get_centroid(body), (vector_t){0.8, 0}));
+  assert(isclose(scene_get_alpha(scene), 0.4));
+  assert(vec_isclose(body_get_interpolated_centroid(body, 0.4),
+                     (vector_t){0.56, 0}));
+
+  // A long stall is clamped instead of being caught up on all at once
+  size_t ticks = scene_advance(scene, 10, 0.01);
+  assert(ticks > 0 && ticks < 30);
+  assert(scene_get_time(scene) < 1);
+  scene_free(scene);
+}
+
+// Tests that the spatial queries find the bodies of the right types, and
+// see bodies which move, change type or are removed between queries
+void test_scene_queries() {
+  scene_t *scene = scene_init();
+  body_t *ball1 = body_init_circle((vector_t){0, 0}, 1, 1, (rgb_color_t){0});
+  body_t *ball2 = body_init_circle((vector_t){10, 0}, 1, 1, (rgb_color_t){0});
+  vector_t wall_center = {20, 0};
+  body_t *wall = body_init(draw_rectangle(&wall_center, 2, 20), INFINITY,
+                           (rgb_color_t){0});
+  body_t *untyped =
+      body_init_circle((vector_t){5, 0}, 1, 1, (rgb_color_t){0});
+  body_set_type(ball1, 0);
+  body_set_type(ball2, 0);
+  body_set_type(wall, 1);
+  scene_add_body(scene, ball1);
+  scene_add_body(scene, ball2);
+  scene_add_body(scene, wall);
+  scene_add_body(scene, untyped);
+  list_t *found = list_init(4, NULL);
+
+  scene_query_point(scene, (vector_t){10.5, 0.5}, ~0u, found);
+  assert(list_size(found) == 1 && list_get(found, 0) == ball2);
+  list_free(found);
+  found = list_init(4, NULL);
+  scene_query_point(scene, (vector_t){5, 0}, ~0u, found);
+  assert(list_size(found) == 0);
+  scene_query_aabb(scene, (aabb_t){{-1, -1}, {19, 1}}, ~0u, found);
+  assert(list_size(found) == 3);
+  list_free(found);
+  found = list_init(4, NULL);
+  scene_query_aabb(scene, (aabb_t){{-1, -1}, {19, 1}}, 1 << 0, found);
+  assert(list_size(found) == 2);
+  list_free(found);
+  found = list_init(4, NULL);
+  scene_query_shape(scene, circle_view((vector_t){5, 0}, 4.1), ~0u, found);
+  assert(list_size(found) == 2);
+  list_free(found);
+  found = list_init(4, NULL);
+
+  // The ray passes the untyped body and stops at ball2's surface
+  raycast_hit_t hit =
+      scene_raycast(scene, (vector_t){2, 0}, (vector_t){1, 0}, 100, ~0u);
+  assert(hit.body == ball2);
+  assert(isclose(hit.distance, 7));
+  assert(vec_isclose(hit.position, (vector_t){9, 0}));
+  assert(vec_isclose(hit.normal, (vector_t){-1, 0}));
+  // Only the wall is of type 1, and its near face is at x = 19
+  hit = scene_raycast(scene, (vector_t){2, 0}, (vector_t){1, 0}, 100, 1 << 1);
+  assert(hit.body == wall);
+  assert(isclose(hit.distance, 17));
+  assert(vec_isclose(hit.normal, (vector_t){-1, 0}));
+  hit = scene_raycast(scene, (vector_t){2, 0}, (vector_t){1, 0}, 5, ~0u);
+  assert(hit.body == NULL);
+  // A circle of radius 2 passing above ball2 grazes it, and touches the wall
+  hit = scene_circle_cast(scene, (vector_t){2, 4}, 2, (vector_t){1, 0}, 100,
+                          ~0u);
+  assert(hit.body == wall);
+  assert(isclose(hit.distance, 15));
+  hit = scene_circle_cast(scene, (vector_t){3, 2}, 2, (vector_t){1, 0}, 100,
+                          ~0u);
+  assert(hit.body == ball2);
+  assert(isclose(hit.distance, 7 - sqrt(5)));
+
+  // Queries see bodies which have moved, changed type or been removed
+  body_set_centroid(ball2, (vector_t){0, 10});
+  body_set_type(ball1, -1);
+  body_set_type(untyped, 0);
+  hit = scene_raycast(scene, (vector_t){7, 0}, (vector_t){1, 0}, 100, ~0u);
+  assert(hit.body == wall);
+  hit = scene_raycast(scene, (vector_t){-5, 0}, (vector_t){1, 0}, 100, ~0u);
+  assert(hit.body == untyped);
+  body_remove(wall);
+  scene_tick(scene, 0);
+  scene_query_aabb(scene, (aabb_t){{-100, -100}, {100, 100}}, ~0u, found);
+  assert(list_size(found) == 2);
+  list_free(found);
+  scene_free(scene);
+}
+
+// Tests that overlays are kept in layer order, in the order they were added
+// within a layer, and that ticking the scene neither moves nor removes them
+void test_overlays() {
+  scene_t *scene = scene_init();
+  body_t *body = body_init_circle(VEC_ZERO, 1, 1, (rgb_color_t){0, 0, 0});
+  scene_add_body(scene, body);
+  assert(body_get_layer(body) == 0);
+  body_set_layer(body, 3);
+  assert(body_get_layer(body) == 3);
+  assert(scene_overlays(scene) == 0);
+  int layers[] = {2, 0, 2, 1, 0, 2, 1, 0, 2, 1};
+  size_t count = sizeof(layers) / sizeof(layers[0]);
+  for (size_t i = 0; i < count; i++) {
+    scene_add_overlay(scene, (overlay_t){.kind = OVERLAY_CIRCLE,
+                                         .center = {i, 0},
+                                         .size = {1, 0},
+                                         .layer = layers[i]});
+  }
+  assert(scene_overlays(scene) == count);
+  for (size_t i = 1; i < count; i++) {
+    const overlay_t *previous = scene_get_overlay(scene, i - 1);
+    const overlay_t *overlay = scene_get_overlay(scene, i);
+    assert(previous->layer < overlay->layer ||
+           (previous->layer == overlay->layer &&
+            previous->center.x < overlay->center.x));
+  }
+  scene_tick(scene, 1);
+  assert(scene_bodies(scene) == 1);
+  assert(scene_overlays(scene) == count);
+  assert(vec_isclose(scene_get_overlay(scene, 0)->center, (vector_t){1, 0}));
+  scene_clear_overlays(scene);
+  assert(scene_overlays(scene) == 0);
+  assert(scene_bodies(scene) == 1);
+  scene_free(scene);
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -242,6 +686,16 @@ int main(int argc, char *argv[]) {
   DO_TEST(test_force_creator)
   DO_TEST(test_force_creator_aux)
   DO_TEST(test_reaping)
+  DO_TEST(test_force_terms)
+  DO_TEST(test_handles_and_removal)
+  DO_TEST(test_collision_handler)
+  DO_TEST(test_fixed_bodies_move)
+  DO_TEST(test_sleeping)
+  DO_TEST(test_no_tunnelling)
+  DO_TEST(test_interpolation_across_impacts)
+  DO_TEST(test_scene_advance)
+  DO_TEST(test_scene_queries)
+  DO_TEST(test_overlays)
 
   puts("scene_test PASS");
 }
@@ -0,0 +1,97 @@
+#include "shot_search.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+const size_t SAMPLES = 12;
+
+search_params_t make_params(size_t threads) {
+  search_params_t params = search_params_init(0.5, CUE_MAX_SPEED);
+  params.samples = SAMPLES;
+  params.threads = threads;
+  params.seed = 3;
+  return params;
+}
+
+void test_shot_score() {
+  shot_result_t result;
+  result.settled = true;
+  result.points = 1;
+  result.foul = 0;
+  assert(shot_score(&result) == 1);
+  result.points = 0;
+  result.foul = 5;
+  assert(shot_score(&result) == -5);
+  result.settled = false;
+  assert(shot_score(&result) < -1000);
+}
+
+// Tests that the candidates are sampled around the aimed shot and are ranked
+void test_candidates() {
+  search_params_t params = make_params(1);
+  candidate_t *candidates = shot_search(params);
+  bool seen[SAMPLES];
+  for (size_t i = 0; i < SAMPLES; i++) {
+    seen[i] = false;
+  }
+  for (size_t i = 0; i < SAMPLES; i++) {
+    candidate_t *candidate = &candidates[i];
+    assert(candidate->index < SAMPLES && !seen[candidate->index]);
+    seen[candidate->index] = true;
+    assert(fabs(candidate->angle - params.angle) <= params.angle_spread);
+    // The speeds above the maximum are clamped
+    assert(candidate->speed >= params.speed - params.speed_spread);
+    assert(candidate->speed <= CUE_MAX_SPEED);
+    assert(vec_equal(candidate->shot.cue_ball, cue_ball_pos()));
+    assert(candidate->shot.ball_on == RED_INFO);
+    assert(isclose(vec_magnitude(candidate->shot.impulse),
+                   BALL_MASS * candidate->speed));
+    assert(candidate->score == shot_score(&candidate->result));
+    if (i > 0) {
+      candidate_t *previous = &candidates[i - 1];
+      assert(previous->score > candidate->score ||
+             (previous->score == candidate->score &&
+              previous->index < candidate->index));
+    }
+  }
+  // Each candidate matches playing it on its own
+  shot_result_t result;
+  simulate_shot(candidates[0].shot, params.dt, &result);
+  assert(result.ticks == candidates[0].result.ticks);
+  assert(result.foul == candidates[0].result.foul);
+  free(candidates);
+}
+
+// Tests that the ranking doesn't depend on how the work is split up
+void test_threads_agree() {
+  candidate_t *serial = shot_search(make_params(1));
+  candidate_t *parallel = shot_search(make_params(4));
+  for (size_t i = 0; i < SAMPLES; i++) {
+    assert(serial[i].index == parallel[i].index);
+    assert(serial[i].score == parallel[i].score);
+    assert(serial[i].result.ticks == parallel[i].result.ticks);
+    for (size_t j = 0; j < NUM_BALLS; j++) {
+      assert(vec_equal(serial[i].result.balls[j].position,
+                       parallel[i].result.balls[j].position));
+    }
+  }
+  free(serial);
+  free(parallel);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_shot_score)
+  DO_TEST(test_candidates)
+  DO_TEST(test_threads_agree)
+
+  puts("shot_search_test PASS");
+}
@@ -0,0 +1,117 @@
+#include "simulator.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+// Tests that a shot which never touches the cue ball leaves the table as it
+// was, and is a foul for missing every ball
+void test_no_shot() {
+  shot_result_t result;
+  simulate_shot(shot_init(0, 0), SIM_DT, &result);
+  assert(result.settled);
+  assert(result.ticks == 1);
+  assert(result.pots == 0);
+  assert(result.points == 0);
+  assert(result.foul == 4);
+  size_t reds = 0;
+  for (size_t i = 0; i < NUM_BALLS; i++) {
+    assert(!result.balls[i].potted);
+    reds += result.balls[i].info == RED_INFO;
+  }
+  assert(reds == 15);
+  assert(result.balls[NUM_BALLS - 1].info == CUE_BALL_INFO);
+  assert(vec_isclose(result.balls[NUM_BALLS - 1].position, cue_ball_pos()));
+  assert(result.balls[NUM_BALLS - 2].info == BLACK_INFO);
+  assert(vec_isclose(result.balls[NUM_BALLS - 2].position, black_pos()));
+}
+
+// Tests that the brown ball, directly in front of the cue ball, is hit first,
+// and that the table comes to rest
+void test_color_first_is_foul() {
+  shot_result_t result;
+  simulate_shot(shot_init(0, 800), SIM_DT, &result);
+  assert(result.settled);
+  assert(result.ticks > 1);
+  assert(result.foul == 4);
+  assert(result.points == 0);
+  for (size_t i = 0; i < NUM_BALLS; i++) {
+    if (result.balls[i].info == BROWN_INFO) {
+      assert(result.balls[i].potted ||
+             !vec_isclose(result.balls[i].position, brown_pos()));
+    }
+  }
+}
+
+// Tests that the cue ball can be potted into an empty corner
+void test_pot_cue_ball() {
+  vector_t corner = base_pos(0, -TABLE_WIDTH / 2);
+  shot_t shot = {vec_add(corner, (vector_t){200, 200}),
+                 vec_multiply(BALL_MASS * 500, (vector_t){-1, -1}), RED_INFO};
+  shot_result_t result;
+  simulate_shot(shot, SIM_DT, &result);
+  assert(result.settled);
+  assert(result.pots == 1);
+  assert(result.balls[NUM_BALLS - 1].potted);
+  assert(result.foul == 4);
+  vector_t potted_at = result.balls[NUM_BALLS - 1].position;
+  assert(potted_at.x < shot.cue_ball.x && potted_at.y < shot.cue_ball.y);
+}
+
+// Tests that simulating is deterministic
+void test_repeatable() {
+  shot_t shot = shot_init(0.03, CUE_MAX_SPEED);
+  shot_result_t result1, result2;
+  simulate_shot(shot, SIM_DT, &result1);
+  simulate_shot(shot, SIM_DT, &result2);
+  assert(result1.settled && result2.settled);
+  assert(result1.ticks == result2.ticks);
+  assert(result1.pots == result2.pots);
+  assert(result1.foul == result2.foul);
+  for (size_t i = 0; i < NUM_BALLS; i++) {
+    assert(result1.balls[i].potted == result2.balls[i].potted);
+    assert(vec_equal(result1.balls[i].position, result2.balls[i].position));
+  }
+}
+
+// Tests that jumping between events plays a shot like ticking does
+void test_events_match_ticks() {
+  vector_t corner = base_pos(0, -TABLE_WIDTH / 2);
+  shot_t shot = {vec_add(corner, (vector_t){200, 200}),
+                 vec_multiply(BALL_MASS * 500, (vector_t){-1, -1}), RED_INFO};
+  shot_result_t result;
+  simulate_shot_events(shot, &result);
+  assert(result.settled);
+  assert(result.pots == 1);
+  assert(result.balls[NUM_BALLS - 1].potted);
+  assert(result.foul == 4);
+
+  // A cue ball which stops short ends up where ticking leaves it
+  shot = shot_init(M_PI, 300);
+  shot_result_t ticked;
+  simulate_shot_events(shot, &result);
+  simulate_shot(shot, SIM_DT, &ticked);
+  assert(result.settled && ticked.settled);
+  assert(result.ticks < 10 && ticked.ticks > 10);
+  assert(vec_magnitude(vec_subtract(result.balls[NUM_BALLS - 1].position,
+                                    ticked.balls[NUM_BALLS - 1].position)) <
+         2);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_no_shot)
+  DO_TEST(test_color_first_is_foul)
+  DO_TEST(test_pot_cue_ball)
+  DO_TEST(test_repeatable)
+  DO_TEST(test_events_match_ticks)
+
+  puts("simulator_test PASS");
+}
@@ -0,0 +1,143 @@
+#include "body.h"
+#include "shape.h"
+#include "test_util.h"
+#include "trajectory.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+// Adds a tall cushion centered at x to a predictor
+void add_cushion(trajectory_t *trajectory, double x) {
+  vector_t center = {x, 0};
+  body_t *body =
+      body_init(draw_rectangle(&center, 2, 100), INFINITY, (rgb_color_t){0});
+  trajectory_add_cushion(trajectory, body_get_shape_view(body));
+  body_free(body);
+}
+
+// Tests that the path stops where the ball touches another ball
+void test_hits_ball() {
+  trajectory_t *trajectory = trajectory_init(1, 1);
+  trajectory_set_balls(trajectory, VEC_ZERO);
+  trajectory_add_ball(trajectory, (vector_t){10, 0}, 1);
+  trajectory_add_ball(trajectory, (vector_t){-10, 0}, 1);
+  vector_t path[3];
+  assert(trajectory_predict(trajectory, (vector_t){1, 0}, 1, path) == 2);
+  assert(vec_equal(path[0], VEC_ZERO));
+  assert(vec_isclose(path[1], (vector_t){8, 0}));
+  assert(trajectory_predict(trajectory, (vector_t){-3, 0}, 1, path) == 2);
+  assert(vec_isclose(path[1], (vector_t){-8, 0}));
+  // Nothing is in the way
+  assert(trajectory_predict(trajectory, (vector_t){0, 1}, 1, path) == 1);
+  trajectory_free(trajectory);
+}
+
+// Tests that the path bounces between cushions, losing some of its speed
+// across them
+void test_bounces_off_cushions() {
+  trajectory_t *trajectory = trajectory_init(1, 1);
+  add_cushion(trajectory, 10);
+  add_cushion(trajectory, -10);
+  trajectory_set_balls(trajectory, VEC_ZERO);
+  vector_t path[4];
+  assert(trajectory_predict(trajectory, (vector_t){1, 1}, 1, path) == 3);
+  assert(vec_isclose(path[1], (vector_t){8, 8}));
+  assert(vec_isclose(path[2], (vector_t){-8, 24}));
+  assert(trajectory_predict(trajectory, (vector_t){1, 1}, 2, path) == 4);
+  assert(vec_isclose(path[3], (vector_t){8, 40}));
+  trajectory_free(trajectory);
+
+  trajectory = trajectory_init(1, 0.5);
+  add_cushion(trajectory, 10);
+  add_cushion(trajectory, -10);
+  trajectory_set_balls(trajectory, VEC_ZERO);
+  assert(trajectory_predict(trajectory, (vector_t){1, 1}, 1, path) == 3);
+  assert(vec_isclose(path[2], (vector_t){-8, 8 + 32}));
+  trajectory_free(trajectory);
+}
+
+// Tests that moving or removing a ball is seen by the next prediction, and
+// that giving the same balls again changes nothing
+void test_balls_moved() {
+  trajectory_t *trajectory = trajectory_init(1, 1);
+  vector_t path[2];
+  trajectory_set_balls(trajectory, VEC_ZERO);
+  trajectory_add_ball(trajectory, (vector_t){10, 0}, 1);
+  trajectory_add_ball(trajectory, (vector_t){0, 10}, 1);
+  assert(trajectory_predict(trajectory, (vector_t){0, 1}, 0, path) == 2);
+  assert(vec_isclose(path[1], (vector_t){0, 8}));
+
+  trajectory_set_balls(trajectory, VEC_ZERO);
+  trajectory_add_ball(trajectory, (vector_t){10, 0}, 1);
+  trajectory_add_ball(trajectory, (vector_t){0, 10}, 1);
+  assert(trajectory_predict(trajectory, (vector_t){0, 1}, 0, path) == 2);
+  assert(vec_isclose(path[1], (vector_t){0, 8}));
+
+  trajectory_set_balls(trajectory, VEC_ZERO);
+  trajectory_add_ball(trajectory, (vector_t){10, 0}, 1);
+  trajectory_add_ball(trajectory, (vector_t){0, 5}, 1);
+  assert(trajectory_predict(trajectory, (vector_t){0, 1}, 0, path) == 2);
+  assert(vec_isclose(path[1], (vector_t){0, 3}));
+
+  trajectory_set_balls(trajectory, VEC_ZERO);
+  trajectory_add_ball(trajectory, (vector_t){10, 0}, 1);
+  assert(trajectory_predict(trajectory, (vector_t){0, 1}, 0, path) == 1);
+  // Moving the origin moves the path
+  trajectory_set_balls(trajectory, (vector_t){0, 1});
+  trajectory_add_ball(trajectory, (vector_t){10, 0}, 1);
+  assert(trajectory_predict(trajectory, (vector_t){1, -0.1}, 0, path) == 2);
+  assert(vec_equal(path[0], (vector_t){0, 1}));
+  assert(fabs(vec_magnitude(vec_subtract(path[1], (vector_t){10, 0})) - 2) <
+         1e-9);
+  trajectory_free(trajectory);
+}
+
+// Tests that only testing the balls in the path's direction finds the same
+// first ball as testing every ball
+void test_matches_every_ball() {
+  trajectory_t *trajectory = trajectory_init(1, 1);
+  const size_t balls = 30;
+  vector_t centers[balls];
+  srand(3);
+  trajectory_set_balls(trajectory, VEC_ZERO);
+  for (size_t i = 0; i < balls; i++) {
+    do {
+      centers[i] = (vector_t){rand() % 200 - 100, rand() % 200 - 100};
+    } while (vec_magnitude(centers[i]) < 5);
+    trajectory_add_ball(trajectory, centers[i], 1.5);
+  }
+  for (size_t i = 0; i < 720; i++) {
+    vector_t direction = vec_init(1, i * M_PI / 360);
+    double distance = INFINITY;
+    for (size_t j = 0; j < balls; j++) {
+      distance = fmin(distance,
+                      ray_circle_impact(VEC_ZERO, direction, centers[j], 2.5));
+    }
+    vector_t path[2];
+    size_t points = trajectory_predict(trajectory, direction, 0, path);
+    if (distance == INFINITY) {
+      assert(points == 1);
+    } else {
+      assert(points == 2);
+      assert(vec_isclose(path[1], vec_multiply(distance, direction)));
+    }
+  }
+  trajectory_free(trajectory);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_hits_ball)
+  DO_TEST(test_bounces_off_cushions)
+  DO_TEST(test_balls_moved)
+  DO_TEST(test_matches_every_ball)
+
+  puts("trajectory_test PASS");
+}
@@ -75,6 +75,46 @@ void test_vec_rotate() {
   assert(vec_isclose(vec_rotate(VEC_ZERO, 1.0), VEC_ZERO));
 }
 
+// Tests that the batch operations give exactly the results of doing each
+// point on its own, for fewer points than a SIMD register holds, and for
+// enough to use SIMD with some left over
+void test_vec_batch() {
+  const size_t counts[] = {1, 3, 7, 16, 37};
+  vector_t axis = {0.6, -0.8}, point = {2, -3}, translation = {1.5, 0.25};
+  double c = cos(0.3), s = sin(0.3);
+  for (size_t k = 0; k < sizeof(counts) / sizeof(counts[0]); k++) {
+    size_t n = counts[k];
+    double x[37], y[37], magnitudes[37];
+    vector_t points[37];
+    for (size_t i = 0; i < n; i++) {
+      points[i] = (vector_t){i * 1.25 - 20, 7 - i * 0.75 + (i % 3)};
+      x[i] = points[i].x;
+      y[i] = points[i].y;
+    }
+
+    vector_t range = vec_project_all(x, y, n, axis);
+    double min = vec_dot(axis, points[0]), max = min;
+    for (size_t i = 0; i < n; i++) {
+      min = fmin(min, vec_dot(axis, points[i]));
+      max = fmax(max, vec_dot(axis, points[i]));
+    }
+    assert(range.x == min && range.y == max);
+
+    vec_magnitude_all(x, y, n, magnitudes);
+    for (size_t i = 0; i < n; i++) {
+      assert(magnitudes[i] == sqrt(vec_dot(points[i], points[i])));
+    }
+
+    vec_rotate_all(x, y, n, c, s, point);
+    vec_translate_all(x, y, n, translation);
+    for (size_t i = 0; i < n; i++) {
+      double dx = points[i].x - point.x, dy = points[i].y - point.y;
+      assert(x[i] == dx * c - dy * s + point.x + translation.x);
+      assert(y[i] == dx * s + dy * c + point.y + translation.y);
+    }
+  }
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -92,6 +132,7 @@ int main(int argc, char *argv[]) {
   DO_TEST(test_vec_dot)
   DO_TEST(test_vec_cross)
   DO_TEST(test_vec_rotate)
+  DO_TEST(test_vec_batch)
 
   puts("vector_test PASS");
 }
@@ -0,0 +1,147 @@
+#include "polygon.h"
+#include "test_util.h"
+#include "vertices.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+// Make square at (+/-1, +/-1)
+vertices_t *make_square() {
+  vertices_t *sq = vertices_init(4);
+  vertices_add(sq, (vector_t){+1, +1});
+  vertices_add(sq, (vector_t){-1, +1});
+  vertices_add(sq, (vector_t){-1, -1});
+  vertices_add(sq, (vector_t){+1, -1});
+  return sq;
+}
+
+// Make 3-4-5 triangle
+vertices_t *make_triangle() {
+  vertices_t *tri = vertices_init(1);
+  vertices_add(tri, VEC_ZERO);
+  vertices_add(tri, (vector_t){4, 0});
+  vertices_add(tri, (vector_t){4, 3});
+  return tri;
+}
+
+void test_vertices_add_get() {
+  vertices_t *tri = make_triangle();
+  assert(vertices_size(tri) == 3);
+  assert(vec_equal(vertices_get(tri, 0), VEC_ZERO));
+  assert(vec_equal(vertices_get(tri, 1), (vector_t){4, 0}));
+  assert(vec_equal(vertices_get(tri, 2), (vector_t){4, 3}));
+  const double *x = vertices_x(tri), *y = vertices_y(tri);
+  assert(x[1] == 4 && y[1] == 0);
+  assert(x[2] == 4 && y[2] == 3);
+  vertices_free(tri);
+}
+
+void test_square_area_centroid() {
+  vertices_t *sq = make_square();
+  assert(isclose(vertices_area(sq), 4));
+  assert(vec_isclose(vertices_centroid(sq), VEC_ZERO));
+  assert(vec_isclose(vertices_center(sq), VEC_ZERO));
+  vertices_free(sq);
+}
+
+void test_triangle_area_centroid() {
+  vertices_t *tri = make_triangle();
+  assert(isclose(vertices_area(tri), 6));
+  assert(vec_isclose(vertices_centroid(tri), (vector_t){8.0 / 3.0, 1}));
+  vertices_free(tri);
+}
+
+void test_square_translate_rotate() {
+  vertices_t *sq = make_square();
+  vertices_translate(sq, (vector_t){2, 3});
+  assert(vec_equal(vertices_get(sq, 0), (vector_t){3, 4}));
+  assert(vec_equal(vertices_get(sq, 2), (vector_t){1, 2}));
+  vertices_rotate(sq, 0.25 * M_PI, (vector_t){2, 3});
+  assert(vec_isclose(vertices_get(sq, 0), (vector_t){2, 3 + sqrt(2)}));
+  assert(vec_isclose(vertices_get(sq, 1), (vector_t){2 - sqrt(2), 3}));
+  assert(vec_isclose(vertices_get(sq, 2), (vector_t){2, 3 - sqrt(2)}));
+  assert(vec_isclose(vertices_get(sq, 3), (vector_t){2 + sqrt(2), 3}));
+  assert(isclose(vertices_area(sq), 4));
+  assert(vec_isclose(vertices_centroid(sq), (vector_t){2, 3}));
+  vertices_free(sq);
+}
+
+void test_stretch_reflect() {
+  vertices_t *tri = make_triangle();
+  vertices_stretch_x(tri, 2);
+  assert(vec_equal(vertices_get(tri, 2), (vector_t){8, 3}));
+  vertices_reflect_x(tri, 1);
+  assert(vec_equal(vertices_get(tri, 2), (vector_t){-6, 3}));
+  vertices_reflect_y(tri, 1);
+  assert(vec_equal(vertices_get(tri, 2), (vector_t){-6, -1}));
+  vertices_free(tri);
+}
+
+void test_normals() {
+  vertices_t *tri = make_triangle();
+  vertices_t *normals = vertices_init(0);
+  vertices_normals(tri, normals);
+  assert(vertices_size(normals) == 3);
+  assert(vec_isclose(vertices_get(normals, 0), (vector_t){0, 1}));
+  assert(vec_isclose(vertices_get(normals, 1), (vector_t){-1, 0}));
+  assert(vec_isclose(vertices_get(normals, 2), (vector_t){0.6, -0.8}));
+  // Recomputing replaces the old normals
+  vertices_rotate(tri, M_PI / 2, VEC_ZERO);
+  vertices_normals(tri, normals);
+  assert(vertices_size(normals) == 3);
+  assert(vec_isclose(vertices_get(normals, 0), (vector_t){-1, 0}));
+  vertices_free(normals);
+  vertices_free(tri);
+}
+
+// Tests converting to and from lists, and that the packed operations match
+// the list-based polygon functions
+void test_list_conversion() {
+  vertices_t *sq = make_square();
+  list_t *list = vertices_to_list(sq);
+  assert(list_size(list) == vertices_size(sq));
+  polygon_rotate(list, 1.0, (vector_t){3, -2});
+  polygon_translate(list, (vector_t){-1, 5});
+  vertices_rotate(sq, 1.0, (vector_t){3, -2});
+  vertices_translate(sq, (vector_t){-1, 5});
+  for (size_t i = 0; i < vertices_size(sq); i++) {
+    assert(vec_isclose(*(vector_t *)list_get(list, i), vertices_get(sq, i)));
+  }
+  assert(isclose(polygon_area(list), vertices_area(sq)));
+  assert(vec_isclose(polygon_centroid(list), vertices_centroid(sq)));
+
+  vertices_t *copy = vertices_from_list(list);
+  assert(vertices_size(copy) == list_size(list));
+  for (size_t i = 0; i < vertices_size(copy); i++) {
+    assert(vec_equal(*(vector_t *)list_get(list, i), vertices_get(copy, i)));
+  }
+  list_free(list);
+  vertices_free(copy);
+
+  copy = vertices_copy(sq);
+  vertices_translate(sq, (vector_t){1, 1});
+  assert(vec_isclose(vec_add(vertices_get(copy, 0), (vector_t){1, 1}),
+                     vertices_get(sq, 0)));
+  vertices_free(copy);
+  vertices_free(sq);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests? True if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_vertices_add_get)
+  DO_TEST(test_square_area_centroid)
+  DO_TEST(test_triangle_area_centroid)
+  DO_TEST(test_square_translate_rotate)
+  DO_TEST(test_stretch_reflect)
+  DO_TEST(test_normals)
+  DO_TEST(test_list_conversion)
+
+  puts("vertices_test PASS");
+}